@@ -3,19 +3,23 @@
 
 #include "precomp.h"
 #include "AttrRow.hpp"
+#include "HyperlinkTable.hpp"
 
 // Routine Description:
 // - constructor
 // Arguments:
 // - cchRowWidth - the length of the default text attribute
 // - attr - the default text attribute
+// - table - the attribute table of the owning text buffer
 // Return Value:
 // - constructed object
-ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr) noexcept
+ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table) noexcept :
+    _table{ &table }
 {
     try
     {
-        _list.emplace_back(TextAttributeRun(cchRowWidth, attr));
+        _list.emplace_back(TextAttributeIdRun(cchRowWidth, _table->Intern(attr)));
+        _UpdateHyperlinks();
     }
     catch (...)
     {
@@ -24,14 +28,73 @@ ATTR_ROW::ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr) noexcept
     _cchRowWidth = cchRowWidth;
 }
 
+ATTR_ROW::~ATTR_ROW()
+{
+    _ReleaseHyperlinks();
+}
+
+// Routine Description:
+// - Copies another row. The copy holds its own references to the hyperlinks it uses.
+ATTR_ROW::ATTR_ROW(const ATTR_ROW& other) :
+    _list{ other._list },
+    _cchRowWidth{ other._cchRowWidth },
+    _table{ other._table },
+    _hyperlinkIds{ other._hyperlinkIds }
+{
+    _AddRefHyperlinks();
+}
+
+ATTR_ROW& ATTR_ROW::operator=(const ATTR_ROW& other)
+{
+    if (this != &other)
+    {
+        // Take the new references before dropping ours,
+        // in case both rows share a hyperlink that only they use.
+        other._AddRefHyperlinks();
+        _ReleaseHyperlinks();
+        _list = other._list;
+        _cchRowWidth = other._cchRowWidth;
+        _table = other._table;
+        _hyperlinkIds = other._hyperlinkIds;
+    }
+    return *this;
+}
+
+// Routine Description:
+// - Moves another row into a new one. The references the other row held are transferred.
+ATTR_ROW::ATTR_ROW(ATTR_ROW&& other) noexcept :
+    _list{ std::move(other._list) },
+    _cchRowWidth{ other._cchRowWidth },
+    _table{ other._table },
+    _hyperlinkIds{ std::move(other._hyperlinkIds) }
+{
+    other._hyperlinkIds.clear();
+}
+
+ATTR_ROW& ATTR_ROW::operator=(ATTR_ROW&& other) noexcept
+{
+    if (this != &other)
+    {
+        _ReleaseHyperlinks();
+        _list = std::move(other._list);
+        _cchRowWidth = other._cchRowWidth;
+        _table = other._table;
+        _hyperlinkIds = std::move(other._hyperlinkIds);
+        other._hyperlinkIds.clear();
+    }
+    return *this;
+}
+
 // Routine Description:
 // - Sets all properties of the ATTR_ROW to default values
 // Arguments:
 // - attr - The default text attributes to use on text in this row.
 void ATTR_ROW::Reset(const TextAttribute attr)
 {
+    const auto attrId = _table->Intern(attr);
     _list.clear();
-    _list.emplace_back(TextAttributeRun(_cchRowWidth, attr));
+    _list.emplace_back(TextAttributeIdRun(_cchRowWidth, attrId));
+    _UpdateHyperlinks();
 }
 
 // Routine Description:
@@ -84,6 +147,9 @@ void ATTR_ROW::Resize(const size_t newWidth)
         // NOTE: Under some circumstances here, we have leftover run segments in memory or blank run segments
         // in memory. We're not going to waste time redimensioning the array in the heap. We're just noting that the useful
         // portions of it have changed.
+
+        // The runs we cut off may have been the only ones using a hyperlink.
+        _UpdateHyperlinks();
     }
 }
 
@@ -114,7 +180,7 @@ TextAttribute ATTR_ROW::GetAttrByColumn(const size_t column,
 {
     THROW_HR_IF(E_INVALIDARG, column >= _cchRowWidth);
     const auto runPos = FindAttrIndex(column, pApplies);
-    return _list.at(runPos).GetAttributes();
+    return _table->At(_list.at(runPos).GetAttributeId());
 }
 
 // Routine Description:
@@ -139,10 +205,20 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
 {
     FAIL_FAST_IF(!(index < _cchRowWidth)); // The requested index cannot be longer than the total length described by this set of Attrs.
 
-    size_t cTotalLength = 0;
-
     FAIL_FAST_IF(!(_list.size() > 0)); // There should be a non-zero and positive number of items in the array.
 
+    // Most rows are a single color. Skip the scan for them.
+    if (_list.size() == 1)
+    {
+        if (nullptr != pApplies)
+        {
+            *pApplies = _cchRowWidth - index;
+        }
+        return 0;
+    }
+
+    size_t cTotalLength = 0;
+
     // Scan through the internal array from position 0 adding up the lengths that each attribute applies to
     auto runPos = _list.cbegin();
     do
@@ -182,20 +258,145 @@ size_t ATTR_ROW::FindAttrIndex(const size_t index, size_t* const pApplies) const
 }
 
 // Routine Description:
-// - Finds the hyperlink IDs present in this row and returns them
+// - Returns the runs of this row with their attributes resolved.
 // Return value:
-// - The hyperlink IDs present in this row
-std::vector<uint16_t> ATTR_ROW::GetHyperlinks()
+// - The run-length encoded attributes of this row
+std::vector<TextAttributeRun> ATTR_ROW::GetRuns() const
+{
+    std::vector<TextAttributeRun> runs;
+    runs.reserve(_list.size());
+    for (const auto& run : _list)
+    {
+        runs.emplace_back(run.GetLength(), _table->At(run.GetAttributeId()));
+    }
+    return runs;
+}
+
+// Routine Description:
+// - Returns the runs of this row as they are stored, with attribute table IDs.
+// Return value:
+// - The run-length encoded attribute IDs of this row. Invalidated by any change to the row.
+gsl::span<const TextAttributeIdRun> ATTR_ROW::GetIdRuns() const noexcept
+{
+    return { _list.data(), _list.size() };
+}
+
+// Routine Description:
+// - Replaces all runs of this row with runs whose IDs come from another attribute table.
+// Arguments:
+// - runs - the new runs. Their lengths must add up to the width of the row.
+// - newIds - the mapping from the IDs in runs to the IDs in this row's table
+// Note:
+// - will throw E_INVALIDARG if the runs don't cover the row exactly or refer to unknown IDs.
+void ATTR_ROW::SetIdRuns(const gsl::span<const TextAttributeIdRun> runs, const std::vector<TextAttributeTable::id_type>& newIds)
+{
+    size_t total = 0;
+    for (const auto& run : runs)
+    {
+        THROW_HR_IF(E_INVALIDARG, run.GetLength() == 0 || run.GetAttributeId() >= newIds.size());
+        total += run.GetLength();
+    }
+    THROW_HR_IF(E_INVALIDARG, total != _cchRowWidth);
+
+    _list.assign(runs.begin(), runs.end());
+    RemapAttributeIds(newIds);
+    _UpdateHyperlinks();
+}
+
+// Routine Description:
+// - Flags the attribute table IDs referenced by this row.
+// Arguments:
+// - inUse - one flag per ID in the attribute table. IDs used by this row are set to true.
+void ATTR_ROW::CollectAttributeIds(std::vector<bool>& inUse) const
+{
+    for (const auto& run : _list)
+    {
+        inUse.at(run.GetAttributeId()) = true;
+    }
+}
+
+// Routine Description:
+// - Updates the IDs stored in this row after the attribute table was compacted.
+// Arguments:
+// - newIds - the mapping from old to new IDs returned by TextAttributeTable::Compact
+void ATTR_ROW::RemapAttributeIds(const std::vector<TextAttributeTable::id_type>& newIds) noexcept
 {
-    std::vector<uint16_t> ids;
+    for (auto& run : _list)
+    {
+        run.SetAttributeId(til::at(newIds, run.GetAttributeId()));
+    }
+}
+
+// Routine Description:
+// - Brings the hyperlink references held by this row in line with its runs.
+//   References to hyperlinks that are no longer used are released, which
+//   removes them from the hyperlink table once no other row uses them.
+void ATTR_ROW::_UpdateHyperlinks()
+{
+    const auto hyperlinks = _table->GetHyperlinkTable();
+    // Most buffers never see a hyperlink, so don't bother scanning the runs for them.
+    if (!hyperlinks || (_hyperlinkIds.empty() && !_table->HasHyperlinks()))
+    {
+        return;
+    }
+
+    boost::container::small_vector<uint16_t, 1> ids;
     for (const auto& run : _list)
     {
-        if (run.GetAttributes().IsHyperlink())
+        const auto& attr = _table->At(run.GetAttributeId());
+        if (attr.IsHyperlink())
+        {
+            ids.emplace_back(attr.GetHyperlinkId());
+        }
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    if (ids == _hyperlinkIds)
+    {
+        return;
+    }
+
+    // Take the new references before releasing the old ones, so that
+    // a hyperlink that merely moved within the row is never removed.
+    for (const auto id : ids)
+    {
+        if (!std::binary_search(_hyperlinkIds.begin(), _hyperlinkIds.end(), id))
+        {
+            hyperlinks->AddRef(id);
+        }
+    }
+    for (const auto id : _hyperlinkIds)
+    {
+        if (!std::binary_search(ids.begin(), ids.end(), id))
+        {
+            hyperlinks->Release(id);
+        }
+    }
+    _hyperlinkIds.swap(ids);
+}
+
+void ATTR_ROW::_AddRefHyperlinks() const
+{
+    if (const auto hyperlinks = _table->GetHyperlinkTable())
+    {
+        for (const auto id : _hyperlinkIds)
         {
-            ids.emplace_back(run.GetAttributes().GetHyperlinkId());
+            hyperlinks->AddRef(id);
         }
     }
-    return ids;
+}
+
+void ATTR_ROW::_ReleaseHyperlinks() noexcept
+{
+    if (const auto hyperlinks = _table->GetHyperlinkTable())
+    {
+        for (const auto id : _hyperlinkIds)
+        {
+            hyperlinks->Release(id);
+        }
+    }
+    _hyperlinkIds.clear();
 }
 
 // Routine Description:
@@ -222,15 +423,26 @@ bool ATTR_ROW::SetAttrToEnd(const UINT iStart, const TextAttribute attr)
 // Return Value:
 // - <none>
 void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept
+try
 {
+    // If the attribute was never interned, no row can be using it.
+    const auto oldId = _table->Find(toBeReplacedAttr);
+    if (!oldId.has_value())
+    {
+        return;
+    }
+
+    const auto newId = _table->Intern(replaceWith);
     for (auto& run : _list)
     {
-        if (run.GetAttributes() == toBeReplacedAttr)
+        if (run.GetAttributeId() == *oldId)
         {
-            run.SetAttributes(replaceWith);
+            run.SetAttributeId(newId);
         }
     }
+    _UpdateHyperlinks();
 }
+CATCH_LOG()
 
 // Routine Description:
 // - Takes a array of attribute runs, and inserts them into this row from startIndex to endIndex.
@@ -250,6 +462,22 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                                                const size_t iStart,
                                                const size_t iEnd,
                                                const size_t cBufferWidth)
+{
+    RETURN_IF_FAILED(_InsertAttrRuns(newAttrs, iStart, iEnd, cBufferWidth));
+    try
+    {
+        _UpdateHyperlinks();
+    }
+    CATCH_RETURN();
+    return S_OK;
+}
+
+// Routine Description:
+// - The implementation of InsertAttrRuns. Doesn't update the hyperlink references of the row.
+[[nodiscard]] HRESULT ATTR_ROW::_InsertAttrRuns(const gsl::span<const TextAttributeRun> newAttrs,
+                                                const size_t iStart,
+                                                const size_t iEnd,
+                                                const size_t cBufferWidth)
 {
     // Definitions:
     // Existing Run = The run length encoded color array we're already storing in memory before this was called.
@@ -268,16 +496,29 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // Do the -1 math here now so we don't have to have -1s scattered all over this function.
     const size_t iLastBufferCol = cBufferWidth - 1;
 
+    // Translate the runs we were given into their interned form. From here on,
+    // comparing two attributes is just a matter of comparing their IDs.
+    boost::container::small_vector<TextAttributeIdRun, 2> newIdRuns;
+    try
+    {
+        newIdRuns.reserve(newAttrs.size());
+        for (const auto& run : newAttrs)
+        {
+            newIdRuns.emplace_back(run.GetLength(), _table->Intern(run.GetAttributes()));
+        }
+    }
+    CATCH_RETURN();
+
     // If the insertion size is 1, do some pre-processing to
     // see if we can get this done quickly.
-    if (newAttrs.size() == 1)
+    if (newIdRuns.size() == 1)
     {
         // Get the new color attribute we're trying to apply
-        const TextAttribute NewAttr = til::at(newAttrs, 0).GetAttributes();
+        const auto NewAttr = til::at(newIdRuns, 0).GetAttributeId();
 
         // If the existing run was only 1 element...
         // ...and the new color is the same as the old, we don't have to do anything and can exit quick.
-        if (_list.size() == 1 && _list.at(0).GetAttributes() == NewAttr)
+        if (_list.size() == 1 && _list.at(0).GetAttributeId() == NewAttr)
         {
             return S_OK;
         }
@@ -305,7 +546,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                     //
                     // 'B' is the new color and '^' represents where iStart is. We don't have to
                     // do anything.
-                    if (curr->GetAttributes() == NewAttr)
+                    if (curr->GetAttributeId() == NewAttr)
                     {
                         return S_OK;
                     }
@@ -320,7 +561,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                     // Here 'D' is the new color.
                     if (curr->GetLength() == 1)
                     {
-                        curr->SetAttributes(NewAttr);
+                        curr->SetAttributeId(NewAttr);
                         return S_OK;
                     }
 
@@ -336,7 +577,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                         // AAAAAABBBBBBCCC
                         //
                         // Here 'A' is the new color.
-                        if (NewAttr == prev->GetAttributes())
+                        if (NewAttr == prev->GetAttributeId())
                         {
                             prev->IncrementLength();
                             curr->DecrementLength();
@@ -363,7 +604,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                         //
                         // Here 'B' is the new color.
                         const auto next = std::next(curr, 1);
-                        if (NewAttr == next->GetAttributes())
+                        if (NewAttr == next->GetAttributeId())
                         {
                             curr->DecrementLength();
                             next->IncrementLength();
@@ -395,7 +636,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     if (iStart == 0 && iEnd == iLastBufferCol)
     {
         // Just dump what we're given over what we have and call it a day.
-        _list.assign(newAttrs.begin(), newAttrs.end());
+        _list.assign(newIdRuns.begin(), newIdRuns.end());
 
         return S_OK;
     }
@@ -407,7 +648,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     // becomes R3->B2->Y2->B1->G2.
     // The original run was 3 long. The insertion run was 1 long. We need 1 more for the
     // fact that an existing piece of the run was split in half (to hold the latter half).
-    const size_t cNewRun = _list.size() + newAttrs.size() + 1;
+    const size_t cNewRun = _list.size() + newIdRuns.size() + 1;
     decltype(_list) newRun;
     newRun.reserve(cNewRun);
 
@@ -418,8 +659,8 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
     const auto existingRun = _list.begin();
     auto pExistingRunPos = existingRun;
     const auto pExistingRunEnd = _list.end();
-    auto pInsertRunPos = newAttrs.begin();
-    size_t cInsertRunRemaining = newAttrs.size();
+    auto pInsertRunPos = newIdRuns.begin();
+    size_t cInsertRunRemaining = newIdRuns.size();
     size_t iExistingRunCoverage = 0;
 
     // Copy the existing run into the new buffer up to the "start index" where the new run will be injected.
@@ -468,7 +709,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         // Now we're still on that "last cell copied" into the new run.
         // If the color of that existing copied cell matches the color of the first segment
         // of the run we're about to insert, we can just increment the length to extend the coverage.
-        if (newRun.back().GetAttributes() == pInsertRunPos->GetAttributes())
+        if (newRun.back().GetAttributeId() == pInsertRunPos->GetAttributeId())
         {
             length += pInsertRunPos->GetLength();
 
@@ -523,7 +764,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
             // This case is slightly off from the example above. This case is for if the B2 above was actually Y2.
             // That Y2 from the existing run is the same color as the Y2 we just filled a few columns left in the final run
             // so we can just adjust the final run's column count instead of adding another segment here.
-            if (newRun.back().GetAttributes() == pExistingRunPos->GetAttributes())
+            if (newRun.back().GetAttributeId() == pExistingRunPos->GetAttributeId())
             {
                 size_t length = newRun.back().GetLength();
                 length += (iExistingRunCoverage - (iEnd + 1));
@@ -538,7 +779,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
                 newRun.emplace_back();
 
                 // Copy the existing run's color information to the new run
-                newRun.back().SetAttributes(pExistingRunPos->GetAttributes());
+                newRun.back().SetAttributeId(pExistingRunPos->GetAttributeId());
 
                 // Adjust the length of that copied color to cover only the reduced number of columns needed
                 // now that some have been replaced by the insert run.
@@ -560,7 +801,7 @@ void ATTR_ROW::ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAtt
         // New Run desired when done = R3 -> B7
         // Existing run pointer is on B2.
         // We want to merge the 2 from the B2 into the B5 so we get B7.
-        else if (newRun.back().GetAttributes() == pExistingRunPos->GetAttributes())
+        else if (newRun.back().GetAttributeId() == pExistingRunPos->GetAttributeId())
         {
             // Add the value from the existing run into the current new run position.
             size_t length = newRun.back().GetLength();
@@ -635,5 +876,6 @@ bool operator==(const ATTR_ROW& a, const ATTR_ROW& b) noexcept
 {
     return (a._list.size() == b._list.size() &&
             a._list.data() == b._list.data() &&
-            a._cchRowWidth == b._cchRowWidth);
+            a._cchRowWidth == b._cchRowWidth &&
+            a._table == b._table);
 }
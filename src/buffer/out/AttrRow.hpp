@@ -28,16 +28,15 @@ class ATTR_ROW final
 public:
     using const_iterator = typename AttrRowIterator;
 
-    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr)
+    ATTR_ROW(const UINT cchRowWidth, const TextAttribute attr, TextAttributeTable& table)
     noexcept;
 
-    ~ATTR_ROW() = default;
+    ~ATTR_ROW();
 
-    ATTR_ROW(const ATTR_ROW&) = default;
-    ATTR_ROW& operator=(const ATTR_ROW&) = default;
-    ATTR_ROW(ATTR_ROW&&)
-    noexcept = default;
-    ATTR_ROW& operator=(ATTR_ROW&&) noexcept = default;
+    ATTR_ROW(const ATTR_ROW& other);
+    ATTR_ROW& operator=(const ATTR_ROW& other);
+    ATTR_ROW(ATTR_ROW&& other) noexcept;
+    ATTR_ROW& operator=(ATTR_ROW&& other) noexcept;
 
     TextAttribute GetAttrByColumn(const size_t column) const;
     TextAttribute GetAttrByColumn(const size_t column,
@@ -48,7 +47,12 @@ public:
     size_t FindAttrIndex(const size_t index,
                          size_t* const pApplies) const;
 
-    std::vector<uint16_t> GetHyperlinks();
+    std::vector<TextAttributeRun> GetRuns() const;
+    gsl::span<const TextAttributeIdRun> GetIdRuns() const noexcept;
+    void SetIdRuns(const gsl::span<const TextAttributeIdRun> runs, const std::vector<TextAttributeTable::id_type>& newIds);
+
+    void CollectAttributeIds(std::vector<bool>& inUse) const;
+    void RemapAttributeIds(const std::vector<TextAttributeTable::id_type>& newIds) noexcept;
 
     bool SetAttrToEnd(const UINT iStart, const TextAttribute attr);
     void ReplaceAttrs(const TextAttribute& toBeReplacedAttr, const TextAttribute& replaceWith) noexcept;
@@ -75,8 +79,22 @@ public:
 private:
     void Reset(const TextAttribute attr);
 
-    boost::container::small_vector<TextAttributeRun, 1> _list;
+    [[nodiscard]] HRESULT _InsertAttrRuns(const gsl::span<const TextAttributeRun> newAttrs,
+                                          const size_t iStart,
+                                          const size_t iEnd,
+                                          const size_t cBufferWidth);
+
+    void _UpdateHyperlinks();
+    void _AddRefHyperlinks() const;
+    void _ReleaseHyperlinks() noexcept;
+
+    boost::container::small_vector<TextAttributeIdRun, 1> _list;
     size_t _cchRowWidth;
+    TextAttributeTable* _table; // non ownership pointer
+
+    // The distinct hyperlink IDs used by _list, sorted. The row holds one
+    // reference to each of them in the table's HyperlinkTable.
+    boost::container::small_vector<uint16_t, 1> _hyperlinkIds;
 
 #ifdef UNIT_TESTING
     friend class AttrRowTests;
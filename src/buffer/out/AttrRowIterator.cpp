@@ -64,13 +64,13 @@ AttrRowIterator& AttrRowIterator::operator-=(const ptrdiff_t& movement)
 const TextAttribute* AttrRowIterator::operator->() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return &_run->GetAttributes();
+    return &_pAttrRow->_table->At(_run->GetAttributeId());
 }
 
 const TextAttribute& AttrRowIterator::operator*() const
 {
     THROW_HR_IF(E_BOUNDS, _exceeded);
-    return _run->GetAttributes();
+    return _pAttrRow->_table->At(_run->GetAttributeId());
 }
 
 // Routine Description:
@@ -69,7 +69,7 @@ public:
     const TextAttribute& operator*() const;
 
 private:
-    boost::container::small_vector_base<TextAttributeRun>::const_iterator _run;
+    boost::container::small_vector_base<TextAttributeIdRun>::const_iterator _run;
     const ATTR_ROW* _pAttrRow;
     size_t _currentAttributeIndex; // index of TextAttribute within the current TextAttributeRun
     bool _exceeded;
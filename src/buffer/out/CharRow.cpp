@@ -14,15 +14,13 @@
 // - pParent - the parent ROW
 // Return Value:
 // - instantiated object
-// Note: will through if unable to allocate char/attribute buffers
-#pragma warning(push)
-#pragma warning(disable : 26447) // small_vector's constructor says it can throw but it should not given how we use it.  This suppresses this error for the AuditMode build.
+// Note: doesn't allocate. The cells are allocated when the row is first written to.
 CharRow::CharRow(size_t rowWidth, ROW* const pParent) noexcept :
-    _data(rowWidth, value_type()),
+    _data(),
+    _width{ rowWidth },
     _pParent{ FAIL_FAST_IF_NULL(pParent) }
 {
 }
-#pragma warning(pop)
 
 // Routine Description:
 // - gets the size of the row, in glyph cells
@@ -32,7 +30,66 @@ CharRow::CharRow(size_t rowWidth, ROW* const pParent) noexcept :
 // - the size of the row
 size_t CharRow::size() const noexcept
 {
-    return _data.size();
+    return _width;
+}
+
+// Routine Description:
+// - Tells you whether this row has allocated its cell storage yet.
+//   Rows that aren't materialized are entirely blank.
+// Arguments:
+// - <none>
+// Return Value:
+// - True if the cells are stored. False if the row is implicitly blank.
+bool CharRow::IsMaterialized() const noexcept
+{
+    return !_data.empty();
+}
+
+// Routine Description:
+// - Allocates the cell storage of the row, if it doesn't have any yet.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+// Note: will throw exception if unable to allocate
+void CharRow::_Materialize()
+{
+    if (_data.empty())
+    {
+        _data.resize(_width, value_type());
+    }
+}
+
+// Routine Description:
+// - Gets the cell at the given column for writing, materializing the row if necessary.
+// Arguments:
+// - column - the column of the cell
+// Return Value:
+// - the cell at column
+// Note: will throw exception if column is out of bounds
+CharRow::value_type& CharRow::_CellAt(const size_t column)
+{
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
+    _Materialize();
+    return til::at(_data, column);
+}
+
+// Routine Description:
+// - Gets the cell at the given column for reading. Blank rows aren't materialized.
+// Arguments:
+// - column - the column of the cell
+// Return Value:
+// - the cell at column
+// Note: will throw exception if column is out of bounds
+const CharRow::value_type& CharRow::_CellAt(const size_t column) const
+{
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
+    if (_data.empty())
+    {
+        static const value_type blank{};
+        return blank;
+    }
+    return til::at(_data, column);
 }
 
 // Routine Description:
@@ -43,10 +100,9 @@ size_t CharRow::size() const noexcept
 // - <none>
 void CharRow::Reset() noexcept
 {
-    for (auto& cell : _data)
-    {
-        cell.Reset();
-    }
+    // A blank row doesn't need any storage. We keep the capacity around though,
+    // since a row that has been written to once is likely to be written to again.
+    _data.clear();
 }
 
 // Routine Description:
@@ -59,34 +115,56 @@ void CharRow::Reset() noexcept
 {
     try
     {
-        const value_type insertVals;
-        _data.resize(newSize, insertVals);
+        if (!_data.empty())
+        {
+            const value_type insertVals;
+            _data.resize(newSize, insertVals);
+        }
     }
     CATCH_RETURN();
 
+    _width = newSize;
     return S_OK;
 }
 
-typename CharRow::iterator CharRow::begin() noexcept
+typename CharRow::iterator CharRow::begin()
 {
+    _Materialize();
     return _data.begin();
 }
 
-typename CharRow::const_iterator CharRow::cbegin() const noexcept
+typename CharRow::const_iterator CharRow::cbegin() const
 {
-    return _data.cbegin();
+    return _data.empty() ? s_BlankCells().cbegin() : _data.cbegin();
 }
 
-typename CharRow::iterator CharRow::end() noexcept
+typename CharRow::iterator CharRow::end()
 {
+    _Materialize();
     return _data.end();
 }
 
-typename CharRow::const_iterator CharRow::cend() const noexcept
+typename CharRow::const_iterator CharRow::cend() const
 {
+    if (_data.empty())
+    {
+        const auto& blanks = s_BlankCells();
+        THROW_HR_IF(E_UNEXPECTED, _width > blanks.size());
+        return blanks.cbegin() + _width;
+    }
     return _data.cend();
 }
 
+// Routine Description:
+// - Returns a run of blank cells shared by all rows, for iterating over rows that
+//   aren't materialized. It's as long as the widest row a buffer can have.
+// Note: will throw exception if unable to allocate. Only the first call allocates.
+const std::vector<CharRow::value_type>& CharRow::s_BlankCells()
+{
+    static const std::vector<value_type> blanks(SHRT_MAX);
+    return blanks;
+}
+
 // Routine Description:
 // - Inspects the current internal string to find the left edge of it
 // Arguments:
@@ -95,6 +173,11 @@ typename CharRow::const_iterator CharRow::cend() const noexcept
 // - The calculated left boundary of the internal string.
 size_t CharRow::MeasureLeft() const noexcept
 {
+    if (_data.empty())
+    {
+        return _width;
+    }
+
     const_iterator it = _data.cbegin();
     while (it != _data.cend() && it->IsSpace())
     {
@@ -111,6 +194,11 @@ size_t CharRow::MeasureLeft() const noexcept
 // - The calculated right boundary of the internal string.
 size_t CharRow::MeasureRight() const
 {
+    if (_data.empty())
+    {
+        return 0;
+    }
+
     const_reverse_iterator it = _data.crbegin();
     while (it != _data.crend() && it->IsSpace())
     {
@@ -121,7 +209,12 @@ size_t CharRow::MeasureRight() const
 
 void CharRow::ClearCell(const size_t column)
 {
-    _data.at(column).Reset();
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
+    // There's nothing to clear in a blank row.
+    if (!_data.empty())
+    {
+        til::at(_data, column).Reset();
+    }
 }
 
 // Routine Description:
@@ -151,7 +244,7 @@ bool CharRow::ContainsText() const noexcept
 // Note: will throw exception if column is out of bounds
 const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 {
-    return _data.at(column).DbcsAttr();
+    return _CellAt(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -163,7 +256,7 @@ const DbcsAttribute& CharRow::DbcsAttrAt(const size_t column) const
 // Note: will throw exception if column is out of bounds
 DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 {
-    return _data.at(column).DbcsAttr();
+    return _CellAt(column).DbcsAttr();
 }
 
 // Routine Description:
@@ -175,7 +268,7 @@ DbcsAttribute& CharRow::DbcsAttrAt(const size_t column)
 // Note: will throw exception if column is out of bounds
 void CharRow::ClearGlyph(const size_t column)
 {
-    _data.at(column).EraseChars();
+    _CellAt(column).EraseChars();
 }
 
 // Routine Description:
@@ -187,7 +280,7 @@ void CharRow::ClearGlyph(const size_t column)
 // - Note: will throw exception if column is out of bounds
 const CharRow::reference CharRow::GlyphAt(const size_t column) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
     return { const_cast<CharRow&>(*this), column };
 }
 
@@ -200,12 +293,17 @@ const CharRow::reference CharRow::GlyphAt(const size_t column) const
 // - Note: will throw exception if column is out of bounds
 CharRow::reference CharRow::GlyphAt(const size_t column)
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
     return { *this, column };
 }
 
 std::wstring CharRow::GetText() const
 {
+    if (_data.empty())
+    {
+        return std::wstring(_width, UNICODE_SPACE);
+    }
+
     std::wstring wstr;
     wstr.reserve(_data.size());
 
@@ -233,7 +331,7 @@ std::wstring CharRow::GetText() const
 // - the delimiter class for the given char
 const DelimiterClass CharRow::DelimiterClassAt(const size_t column, const std::wstring_view wordDelimiters) const
 {
-    THROW_HR_IF(E_INVALIDARG, column >= _data.size());
+    THROW_HR_IF(E_INVALIDARG, column >= _width);
 
     const auto glyph = *GlyphAt(column).begin();
     if (glyph <= UNICODE_SPACE)
@@ -261,14 +359,19 @@ const UnicodeStorage& CharRow::GetUnicodeStorage() const noexcept
 }
 
 // Routine Description:
-// - calculates the key used by the given column of the char row to store glyph data in UnicodeStorage
+// - Flags the UnicodeStorage handles referenced by the cells of this row.
 // Arguments:
-// - column - the column to generate the key for
-// Return Value:
-// - the COORD key for data access from UnicodeStorage for the column
-COORD CharRow::GetStorageKey(const size_t column) const noexcept
+// - inUse - one flag per handle in the storage. Handles used by this row are set to true.
+void CharRow::CollectGlyphs(std::vector<bool>& inUse) const
 {
-    return { gsl::narrow<SHORT>(column), _pParent->GetId() };
+    for (const auto& cell : _data)
+    {
+        const size_t key = cell.Char();
+        if (cell.DbcsAttr().IsGlyphStored() && key < inUse.size())
+        {
+            inUse[key] = true;
+        }
+    }
 }
 
 // Routine Description:
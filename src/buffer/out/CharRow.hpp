@@ -44,14 +44,20 @@ enum class DelimiterClass
 //       ^    ^                  ^                     ^
 //       |    |                  |                     |
 //     Chars Left               Right                end of Chars buffer
+//
+// Rows that have never been written to don't hold any cell storage at all and
+// are implicitly blank. The storage is allocated on the heap on the first mutable
+// access, so that large scrollback buffers are cheap until used.
+// Reading from a blank row, including through the const iterators, yields
+// default (space) cells.
 class CharRow final
 {
 public:
     using glyph_type = typename wchar_t;
     using value_type = typename CharRowCell;
-    using iterator = typename boost::container::small_vector_base<value_type>::iterator;
-    using const_iterator = typename boost::container::small_vector_base<value_type>::const_iterator;
-    using const_reverse_iterator = typename boost::container::small_vector_base<value_type>::const_reverse_iterator;
+    using iterator = typename std::vector<value_type>::iterator;
+    using const_iterator = typename std::vector<value_type>::const_iterator;
+    using const_reverse_iterator = typename std::vector<value_type>::const_reverse_iterator;
     using reference = typename CharRowCellReference;
 
     CharRow(size_t rowWidth, ROW* const pParent) noexcept;
@@ -61,6 +67,7 @@ public:
     size_t MeasureLeft() const noexcept;
     size_t MeasureRight() const;
     bool ContainsText() const noexcept;
+    bool IsMaterialized() const noexcept;
     const DbcsAttribute& DbcsAttrAt(const size_t column) const;
     DbcsAttribute& DbcsAttrAt(const size_t column);
     void ClearGlyph(const size_t column);
@@ -72,17 +79,19 @@ public:
     reference GlyphAt(const size_t column);
 
     // iterators
-    iterator begin() noexcept;
-    const_iterator cbegin() const noexcept;
-    const_iterator begin() const noexcept { return cbegin(); }
+    // NOTE: the mutable iterators materialize the row. The const ones
+    // iterate over shared blank cells if the row isn't materialized.
+    iterator begin();
+    const_iterator cbegin() const;
+    const_iterator begin() const { return cbegin(); }
 
-    iterator end() noexcept;
-    const_iterator cend() const noexcept;
-    const_iterator end() const noexcept { return cend(); }
+    iterator end();
+    const_iterator cend() const;
+    const_iterator end() const { return cend(); }
 
     UnicodeStorage& GetUnicodeStorage() noexcept;
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
-    COORD GetStorageKey(const size_t column) const noexcept;
+    void CollectGlyphs(std::vector<bool>& inUse) const;
 
     void UpdateParent(ROW* const pParent);
 
@@ -94,9 +103,20 @@ private:
     void ClearCell(const size_t column);
     std::wstring GetText() const;
 
+    value_type& _CellAt(const size_t column);
+    const value_type& _CellAt(const size_t column) const;
+    void _Materialize();
+
+    static const std::vector<value_type>& s_BlankCells();
+
 protected:
-    // storage for glyph data and dbcs attributes
-    boost::container::small_vector<value_type, 120> _data;
+    // storage for glyph data and dbcs attributes. empty until materialized.
+    // deliberately not a small_vector: its inline capacity would be part of
+    // every row, whether it's materialized or not.
+    std::vector<value_type> _data;
+
+    // the width of the row, whether or not it's materialized
+    size_t _width;
 
     // ROW that this CharRow belongs to
     ROW* _pParent;
@@ -19,9 +19,9 @@ void CharRowCellReference::operator=(const std::wstring_view chars)
     }
     else
     {
-        auto& storage = _parent.GetUnicodeStorage();
-        const auto key = _parent.GetStorageKey(_index);
-        storage.StoreGlyph(key, { chars.cbegin(), chars.cend() });
+        // Stored glyphs keep their handle in place of the character.
+        const auto key = _parent.GetUnicodeStorage().StoreGlyph(chars);
+        _cellData().Char() = key;
         _cellData().DbcsAttr().SetGlyphStored(true);
     }
 }
@@ -41,7 +41,7 @@ CharRowCellReference::operator std::wstring_view() const
 // - ref to the CharRowCell
 CharRowCell& CharRowCellReference::_cellData()
 {
-    return _parent._data.at(_index);
+    return _parent._CellAt(_index);
 }
 
 // Routine Description:
@@ -50,7 +50,7 @@ CharRowCell& CharRowCellReference::_cellData()
 // - ref to the CharRowCell
 const CharRowCell& CharRowCellReference::_cellData() const
 {
-    return _parent._data.at(_index);
+    return std::as_const(_parent)._CellAt(_index);
 }
 
 // Routine Description:
@@ -61,9 +61,7 @@ std::wstring_view CharRowCellReference::_glyphData() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        const auto& text = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
-
-        return { text.data(), text.size() };
+        return _parent.GetUnicodeStorage().GetText(_cellData().Char());
     }
     else
     {
@@ -79,7 +77,7 @@ CharRowCellReference::const_iterator CharRowCellReference::begin() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        return _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index)).data();
+        return _parent.GetUnicodeStorage().GetText(_cellData().Char()).data();
     }
     else
     {
@@ -98,7 +96,7 @@ CharRowCellReference::const_iterator CharRowCellReference::end() const
 {
     if (_cellData().DbcsAttr().IsGlyphStored())
     {
-        const auto& chars = _parent.GetUnicodeStorage().GetText(_parent.GetStorageKey(_index));
+        const auto chars = _parent.GetUnicodeStorage().GetText(_cellData().Char());
         return chars.data() + chars.size();
     }
     else
@@ -125,8 +123,8 @@ bool operator==(const CharRowCellReference& ref, const std::vector<wchar_t>& gly
     }
     else
     {
-        const auto& chars = ref._parent.GetUnicodeStorage().GetText(ref._parent.GetStorageKey(ref._index));
-        return chars == glyph;
+        const auto chars = ref._parent.GetUnicodeStorage().GetText(ref._cellData().Char());
+        return chars == std::wstring_view{ glyph.data(), glyph.size() };
     }
 }
 
@@ -0,0 +1,437 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ClipboardExporter.hpp"
+
+#include "../types/inc/utils.hpp"
+#include "../types/inc/convert.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console;
+
+// Routine Description:
+// - constructor
+// Arguments:
+// - buffer - the buffer to read from. It must outlive the exporter.
+// - selectionRects - the inclusive rectangles to export, one per row (i.e.: selection rects)
+// - includeCRLF - inject CRLF pairs to the end of each line of the plain text
+// - trimTrailingWhitespace - remove the trailing whitespace at the end of each line
+// - formatWrappedRows - if set we will apply formatting (CRLF inclusion and whitespace trimming) on wrapped rows
+ClipboardExporter::ClipboardExporter(const TextBuffer& buffer,
+                                     std::vector<SMALL_RECT> selectionRects,
+                                     const bool includeCRLF,
+                                     const bool trimTrailingWhitespace,
+                                     const bool formatWrappedRows) noexcept :
+    _buffer{ buffer },
+    _selectionRects{ std::move(selectionRects) },
+    _includeCRLF{ includeCRLF },
+    _trimTrailingWhitespace{ trimTrailingWhitespace },
+    _formatWrappedRows{ formatWrappedRows }
+{
+}
+
+size_t ClipboardExporter::GetRowCount() const noexcept
+{
+    return _selectionRects.size();
+}
+
+// Routine Description:
+// - Walks the selection once, left to right and top to bottom.
+// Arguments:
+// - onRun - called as onRun(text, attr) for every non-empty stretch of the
+//   selection that shares a single attribute. The text is only valid for the
+//   duration of the call.
+// - onRowEnd - called as onRowEnd(index, lineBreak) after each selected row.
+//   lineBreak is set if the plain text should be followed by a CR/LF.
+template<typename TOnRun, typename TOnRowEnd>
+void ClipboardExporter::_ForEachRun(TOnRun&& onRun, TOnRowEnd&& onRowEnd) const
+{
+    std::wstring runText;
+    const auto rows = _selectionRects.size();
+
+    for (size_t i = 0; i < rows; ++i)
+    {
+        const auto& rect = til::at(_selectionRects, i);
+        const auto& row = _buffer.GetRowByOffset(rect.Top);
+        const auto& charRow = row.GetCharRow();
+        const auto& attrRow = row.GetAttrRow();
+
+        // We apply formatting to rows if the row was NOT wrapped or formatting of wrapped rows is allowed
+        const bool shouldFormatRow = _formatWrappedRows || !row.WasWrapForced();
+
+        // The selection rects are inclusive and aren't guaranteed to lie within the row.
+        const auto width = gsl::narrow_cast<ptrdiff_t>(row.size());
+        const auto left = gsl::narrow_cast<size_t>(std::clamp<ptrdiff_t>(rect.Left, 0, width));
+        auto right = gsl::narrow_cast<size_t>(std::clamp<ptrdiff_t>(rect.Right + 1, 0, width));
+
+        if (_trimTrailingWhitespace && shouldFormatRow)
+        {
+            if (!charRow.IsMaterialized())
+            {
+                // A row that was never written to is nothing but spaces.
+                right = left;
+            }
+
+            // The trailing half of a wide glyph is never blank, so this
+            // can't cut a glyph in two.
+            while (right > left &&
+                   !charRow.DbcsAttrAt(right - 1).IsTrailing() &&
+                   std::wstring_view{ charRow.GlyphAt(right - 1) } == std::wstring_view{ L" " })
+            {
+                --right;
+            }
+        }
+
+        for (auto col = left; col < right;)
+        {
+            size_t applies = 0;
+            const auto attr = attrRow.GetAttrByColumn(col, &applies);
+            const auto runEnd = std::min(col + std::max<size_t>(applies, 1), right);
+
+            // copy char data into the run, skipping trailing bytes
+            runText.clear();
+            for (; col < runEnd; ++col)
+            {
+                if (!charRow.DbcsAttrAt(col).IsTrailing())
+                {
+                    runText.append(charRow.GlyphAt(col));
+                }
+            }
+
+            if (!runText.empty())
+            {
+                onRun(std::wstring_view{ runText }, attr);
+            }
+        }
+
+        onRowEnd(i, _includeCRLF && shouldFormatRow && i + 1 < rows);
+    }
+}
+
+// Routine Description:
+// - Appends the plain text of the selection to the given string.
+// Arguments:
+// - sink - the string to append to
+void ClipboardExporter::WriteText(std::wstring& sink) const
+{
+    _ForEachRun(
+        [&](const std::wstring_view text, const TextAttribute&) {
+            sink.append(text);
+        },
+        [&](const size_t, const bool lineBreak) {
+            if (lineBreak)
+            {
+                sink.push_back(UNICODE_CARRIAGERETURN);
+                sink.push_back(UNICODE_LINEFEED);
+            }
+        });
+}
+
+// Routine Description:
+// - Appends a CF_HTML compliant representation of the selection to the given string.
+// Arguments:
+// - sink - the string to append to. The CF_HTML offsets are relative to its current end.
+// - getAttributeColors - maps TextAttributes to their foreground and background COLORREFs
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters, also used in padding
+void ClipboardExporter::WriteHTML(std::string& sink,
+                                  const ColorResolver& getAttributeColors,
+                                  const int fontHeightPoints,
+                                  const std::wstring_view fontFaceName,
+                                  const COLORREF backgroundColor) const
+{
+    THROW_HR_IF(E_INVALIDARG, !getAttributeColors);
+
+    // once filled with values, there will be exactly 157 bytes in the clipboard header.
+    // We reserve the space up front and fill it in once we know the offsets.
+    constexpr size_t ClipboardHeaderSize = 157;
+    const auto headerStart = sink.size();
+    sink.append(ClipboardHeaderSize, '0');
+
+    // First we have to add some standard
+    // HTML boiler plate required for CF_HTML
+    // as part of the HTML Clipboard format
+    constexpr std::string_view HtmlHeader = "<!DOCTYPE><HTML><HEAD></HEAD><BODY>";
+    sink.append(HtmlHeader);
+
+    sink.append("<!--StartFragment -->");
+
+    // apply global style in div element
+    sink.append("<DIV STYLE=\"");
+    sink.append("display:inline-block;");
+    sink.append("white-space:pre;");
+    sink.append("background-color:");
+    sink.append(Utils::ColorToHexString(backgroundColor));
+    sink.append(";");
+    sink.append("font-family:'");
+    sink.append(ConvertToA(CP_UTF8, fontFaceName));
+    // even with different font, add monospace as fallback
+    sink.append("',monospace;");
+    sink.append("font-size:");
+    sink.append(std::to_string(fontHeightPoints));
+    sink.append("pt;");
+    // note: MS Word doesn't support padding (in this way at least)
+    sink.append("padding:4px;"); // todo: customizable padding
+    sink.append("\">");
+
+    bool hasWrittenAnyText = false;
+    std::optional<std::pair<COLORREF, COLORREF>> colors;
+    std::string utf8;
+    const auto rows = GetRowCount();
+
+    _ForEachRun(
+        [&](const std::wstring_view text, const TextAttribute& attr) {
+            const auto runColors = getAttributeColors(attr);
+            if (!colors.has_value() || colors.value() != runColors)
+            {
+                if (hasWrittenAnyText)
+                {
+                    sink.append("</SPAN>");
+                }
+
+                colors = runColors;
+                sink.append("<SPAN STYLE=\"color:");
+                sink.append(Utils::ColorToHexString(runColors.first));
+                sink.append(";background-color:");
+                sink.append(Utils::ColorToHexString(runColors.second));
+                sink.append(";\">");
+            }
+            hasWrittenAnyText = true;
+
+            THROW_IF_FAILED(til::u16u8(text, utf8));
+            for (const auto c : utf8)
+            {
+                switch (c)
+                {
+                case '<':
+                    sink.append("&lt;");
+                    break;
+                case '>':
+                    sink.append("&gt;");
+                    break;
+                case '&':
+                    sink.append("&amp;");
+                    break;
+                default:
+                    sink.push_back(c);
+                }
+            }
+        },
+        [&](const size_t row, const bool) {
+            // CR/LF aren't HTML friendly. For line break use '<BR>' instead.
+            if (row + 1 < rows)
+            {
+                sink.append("<BR>");
+            }
+        });
+
+    if (hasWrittenAnyText)
+    {
+        // last opened span wasn't closed in loop above, so close it now
+        sink.append("</SPAN>");
+    }
+
+    sink.append("</DIV>");
+    sink.append("<!--EndFragment -->");
+
+    constexpr std::string_view HtmlFooter = "</BODY></HTML>";
+    sink.append(HtmlFooter);
+
+    // these values are byte offsets from start of clipboard
+    const size_t htmlStartPos = ClipboardHeaderSize;
+    const size_t htmlEndPos = sink.size() - headerStart;
+    const size_t fragStartPos = ClipboardHeaderSize + HtmlHeader.size();
+    const size_t fragEndPos = htmlEndPos - HtmlFooter.size();
+
+    // header required by HTML 0.9 format
+    std::ostringstream clipHeaderBuilder;
+    clipHeaderBuilder << "Version:0.9\r\n";
+    clipHeaderBuilder << std::setfill('0');
+    clipHeaderBuilder << "StartHTML:" << std::setw(10) << htmlStartPos << "\r\n";
+    clipHeaderBuilder << "EndHTML:" << std::setw(10) << htmlEndPos << "\r\n";
+    clipHeaderBuilder << "StartFragment:" << std::setw(10) << fragStartPos << "\r\n";
+    clipHeaderBuilder << "EndFragment:" << std::setw(10) << fragEndPos << "\r\n";
+    clipHeaderBuilder << "StartSelection:" << std::setw(10) << fragStartPos << "\r\n";
+    clipHeaderBuilder << "EndSelection:" << std::setw(10) << fragEndPos << "\r\n";
+
+    const auto clipHeader = clipHeaderBuilder.str();
+    THROW_HR_IF(E_UNEXPECTED, clipHeader.size() != ClipboardHeaderSize);
+    sink.replace(headerStart, ClipboardHeaderSize, clipHeader);
+}
+
+// Routine Description:
+// - Appends an RTF document representing the selection to the given string.
+//   RTF 1.5 Spec: https://www.biblioscape.com/rtf15_spec.htm
+// Arguments:
+// - sink - the string to append to
+// - getAttributeColors - maps TextAttributes to their foreground and background COLORREFs
+// - fontHeightPoints - the unscaled font height
+// - fontFaceName - the name of the font used
+// - backgroundColor - default background color for characters
+void ClipboardExporter::WriteRTF(std::string& sink,
+                                 const ColorResolver& getAttributeColors,
+                                 const int fontHeightPoints,
+                                 const std::wstring_view fontFaceName,
+                                 const COLORREF backgroundColor) const
+{
+    THROW_HR_IF(E_INVALIDARG, !getAttributeColors);
+
+    // The color table precedes the content, but we only learn about the colors
+    // while walking the content. Collect both separately and splice them together.
+    std::string colorTable;
+    std::string content;
+
+    // keys are colors represented by COLORREF
+    // values are indices of the corresponding colors in the color table
+    std::unordered_map<COLORREF, int> colorMap;
+    int nextColorIndex = 1; // leave 0 for the default color and start from 1.
+
+    const auto getColorIndex = [&](const COLORREF color) {
+        const auto [it, inserted] = colorMap.emplace(color, nextColorIndex);
+        if (inserted)
+        {
+            colorTable.append("\\red").append(std::to_string(GetRValue(color)));
+            colorTable.append("\\green").append(std::to_string(GetGValue(color)));
+            colorTable.append("\\blue").append(std::to_string(GetBValue(color)));
+            colorTable.append(";");
+            ++nextColorIndex;
+        }
+        return it->second;
+    };
+
+    colorTable.append("{\\colortbl ;");
+    getColorIndex(backgroundColor);
+
+    content.append("\\viewkind4\\uc4");
+
+    // paragraph styles
+    // \fs specifies font size in half-points i.e. \fs20 results in a font size
+    // of 10 pts. That's why, font size is multiplied by 2 here.
+    content.append("\\pard\\slmult1\\f0\\fs");
+    content.append(std::to_string(2 * fontHeightPoints));
+    content.append("\\highlight1 ");
+
+    std::optional<std::pair<COLORREF, COLORREF>> colors;
+    std::string utf8;
+    const auto rows = GetRowCount();
+
+    _ForEachRun(
+        [&](const std::wstring_view text, const TextAttribute& attr) {
+            const auto runColors = getAttributeColors(attr);
+            if (!colors.has_value() || colors.value() != runColors)
+            {
+                colors = runColors;
+                const auto bkColorIndex = getColorIndex(runColors.second);
+                const auto fgColorIndex = getColorIndex(runColors.first);
+                content.append("\\highlight").append(std::to_string(bkColorIndex));
+                content.append("\\cf").append(std::to_string(fgColorIndex));
+                content.append(" ");
+            }
+
+            THROW_IF_FAILED(til::u16u8(text, utf8));
+            for (const auto c : utf8)
+            {
+                switch (c)
+                {
+                case '\\':
+                case '{':
+                case '}':
+                    content.push_back('\\');
+                    content.push_back(c);
+                    break;
+                default:
+                    content.push_back(c);
+                }
+            }
+        },
+        [&](const size_t row, const bool) {
+            // CR/LF have no color attributes. For line break use \line instead.
+            if (row + 1 < rows)
+            {
+                content.append("\\line ");
+            }
+        });
+
+    colorTable.append("}");
+
+    // start rtf
+    sink.append("{");
+
+    // Standard RTF header.
+    // This is similar to the header generated by WordPad.
+    // \ansi - specifies that the ANSI char set is used in the current doc
+    // \ansicpg1252 - represents the ANSI code page which is used to perform the Unicode to ANSI conversion when writing RTF text
+    // \deff0 - specifies that the default font for the document is the one at index 0 in the font table
+    // \nouicompat - ?
+    sink.append("\\rtf1\\ansi\\ansicpg1252\\deff0\\nouicompat");
+
+    // font table
+    sink.append("{\\fonttbl{\\f0\\fmodern\\fcharset0 ");
+    sink.append(ConvertToA(CP_UTF8, fontFaceName));
+    sink.append(";}}");
+
+    sink.append(colorTable);
+    sink.append(content);
+
+    // end rtf
+    sink.append("}");
+}
+
+// Routine Description:
+// - Retrieves the plain text of the selection.
+// Return Value:
+// - The text of the selected region, with rows separated by CR/LF if requested.
+std::wstring ClipboardExporter::GetText() const
+{
+    std::wstring text;
+    WriteText(text);
+    return text;
+}
+
+// Routine Description:
+// - Generates a CF_HTML compliant structure for the selection. See WriteHTML.
+// Return Value:
+// - string containing the generated HTML, or an empty string on failure.
+std::string ClipboardExporter::GetHTML(const ColorResolver& getAttributeColors,
+                                       const int fontHeightPoints,
+                                       const std::wstring_view fontFaceName,
+                                       const COLORREF backgroundColor) const
+{
+    try
+    {
+        std::string html;
+        WriteHTML(html, getAttributeColors, fontHeightPoints, fontFaceName, backgroundColor);
+        return html;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
+
+// Routine Description:
+// - Generates an RTF document for the selection. See WriteRTF.
+// Return Value:
+// - string containing the generated RTF, or an empty string on failure.
+std::string ClipboardExporter::GetRTF(const ColorResolver& getAttributeColors,
+                                      const int fontHeightPoints,
+                                      const std::wstring_view fontFaceName,
+                                      const COLORREF backgroundColor) const
+{
+    try
+    {
+        std::string rtf;
+        WriteRTF(rtf, getAttributeColors, fontHeightPoints, fontFaceName, backgroundColor);
+        return rtf;
+    }
+    catch (...)
+    {
+        LOG_HR(wil::ResultFromCaughtException());
+        return {};
+    }
+}
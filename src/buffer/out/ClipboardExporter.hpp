@@ -0,0 +1,67 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ClipboardExporter.hpp
+
+Abstract:
+- Serializes a selection of a TextBuffer into the clipboard formats
+  (plain text, CF_HTML and RTF).
+- TextBuffer::GetText builds a foreground and a background color for every
+  selected cell, which GenHTML and GenRTF then walk once more cell by cell.
+  The exporter instead walks the selected rows directly and hands whole
+  attribute runs to the output, so colors are resolved once per run and
+  no intermediate copy of the selection is made.
+
+--*/
+
+#pragma once
+
+#include "textBuffer.hpp"
+
+class ClipboardExporter final
+{
+public:
+    using ColorResolver = std::function<std::pair<COLORREF, COLORREF>(const TextAttribute&)>;
+
+    ClipboardExporter(const TextBuffer& buffer,
+                      std::vector<SMALL_RECT> selectionRects,
+                      const bool includeCRLF,
+                      const bool trimTrailingWhitespace,
+                      const bool formatWrappedRows = false) noexcept;
+
+    size_t GetRowCount() const noexcept;
+
+    void WriteText(std::wstring& sink) const;
+    void WriteHTML(std::string& sink,
+                   const ColorResolver& getAttributeColors,
+                   const int fontHeightPoints,
+                   const std::wstring_view fontFaceName,
+                   const COLORREF backgroundColor) const;
+    void WriteRTF(std::string& sink,
+                  const ColorResolver& getAttributeColors,
+                  const int fontHeightPoints,
+                  const std::wstring_view fontFaceName,
+                  const COLORREF backgroundColor) const;
+
+    std::wstring GetText() const;
+    std::string GetHTML(const ColorResolver& getAttributeColors,
+                        const int fontHeightPoints,
+                        const std::wstring_view fontFaceName,
+                        const COLORREF backgroundColor) const;
+    std::string GetRTF(const ColorResolver& getAttributeColors,
+                       const int fontHeightPoints,
+                       const std::wstring_view fontFaceName,
+                       const COLORREF backgroundColor) const;
+
+private:
+    template<typename TOnRun, typename TOnRowEnd>
+    void _ForEachRun(TOnRun&& onRun, TOnRowEnd&& onRowEnd) const;
+
+    const TextBuffer& _buffer;
+    std::vector<SMALL_RECT> _selectionRects;
+    bool _includeCRLF;
+    bool _trimTrailingWhitespace;
+    bool _formatWrappedRows;
+};
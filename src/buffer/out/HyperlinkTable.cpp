@@ -0,0 +1,210 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "HyperlinkTable.hpp"
+
+// Routine Description:
+// - constructor. Hyperlink ID 0 means "no hyperlink", so IDs start at 1.
+HyperlinkTable::HyperlinkTable() noexcept :
+    _uris{},
+    _customIds{},
+    _customIdsById{},
+    _refCounts{},
+    _nextId{ 1 },
+    _currentId{ 0 },
+    _currentIdReleased{ false }
+{
+}
+
+// Method description:
+// - Provides the hyperlink ID to be assigned as a text attribute, based on the optional custom id provided
+// Arguments:
+// - uri - the hyperlink URI
+// - customId - the user-defined id, may be empty
+// Return value:
+// - The internal hyperlink ID
+uint16_t HyperlinkTable::GetId(const std::wstring_view uri, const std::wstring_view customId)
+{
+    uint16_t numericId = 0;
+    if (customId.empty())
+    {
+        // no custom id specified, return our internal count
+        numericId = _nextId;
+        ++_nextId;
+    }
+    else
+    {
+        // assign _nextId if the custom id does not already exist
+        std::wstring newId{ customId };
+        // hash the URL and add it to the custom ID - GH#7698
+        newId += L"%" + std::to_wstring(std::hash<std::wstring_view>{}(uri));
+        const auto result = _customIds.emplace(newId, _nextId);
+        if (result.second)
+        {
+            // the custom id did not already exist
+            _customIdsById.insert_or_assign(_nextId, std::move(newId));
+            ++_nextId;
+        }
+        numericId = result.first->second;
+    }
+    // _nextId could overflow, make sure its not 0
+    if (_nextId == 0)
+    {
+        ++_nextId;
+    }
+    return numericId;
+}
+
+// Method Description:
+// - Adds or updates a hyperlink
+// Arguments:
+// - uri - the hyperlink URI
+// - id - the hyperlink id (could be new or old)
+void HyperlinkTable::Add(const std::wstring_view uri, const uint16_t id)
+{
+    _uris.insert_or_assign(id, std::wstring{ uri });
+}
+
+// Method Description:
+// - Associates an already decorated user-defined id (see GetId) with a hyperlink ID.
+//   Used to restore a table that was saved with GetCustomIds().
+void HyperlinkTable::AddCustomId(const std::wstring_view customId, const uint16_t id)
+{
+    std::wstring key{ customId };
+    _customIdsById.insert_or_assign(id, key);
+    _customIds.insert_or_assign(std::move(key), id);
+}
+
+// Method Description:
+// - Removes a hyperlink and the associated user defined id (if there is one)
+// Arguments:
+// - id - The ID of the hyperlink to be removed
+void HyperlinkTable::Remove(const uint16_t id) noexcept
+{
+    _uris.erase(id);
+
+    const auto it = _customIdsById.find(id);
+    if (it != _customIdsById.end())
+    {
+        _customIds.erase(it->second);
+        _customIdsById.erase(it);
+    }
+}
+
+// Method Description:
+// - Forgets all hyperlinks. The reference counts and the next ID are left alone.
+void HyperlinkTable::Clear() noexcept
+{
+    _uris.clear();
+    _customIds.clear();
+    _customIdsById.clear();
+}
+
+// Method Description:
+// - Retrieves the URI associated with a particular hyperlink ID
+// Note:
+// - will throw if the hyperlink is unknown
+std::wstring HyperlinkTable::GetUri(const uint16_t id) const
+{
+    return _uris.at(id);
+}
+
+// Method Description:
+// - Obtains the custom ID, if there was one, associated with a hyperlink ID
+// Return Value:
+// - The custom ID if there was one, empty string otherwise
+std::wstring HyperlinkTable::GetCustomId(const uint16_t id) const
+{
+    const auto it = _customIdsById.find(id);
+    return it == _customIdsById.end() ? std::wstring{} : it->second;
+}
+
+const std::unordered_map<uint16_t, std::wstring>& HyperlinkTable::GetUris() const noexcept
+{
+    return _uris;
+}
+
+const std::unordered_map<std::wstring, uint16_t>& HyperlinkTable::GetCustomIds() const noexcept
+{
+    return _customIds;
+}
+
+uint16_t HyperlinkTable::GetNextId() const noexcept
+{
+    return _nextId;
+}
+
+void HyperlinkTable::SetNextId(const uint16_t id) noexcept
+{
+    _nextId = id == 0 ? 1 : id;
+}
+
+// Method Description:
+// - Copies the hyperlinks and the next ID of another table into this one.
+//   The reference counts and the current ID aren't copied: they belong to the
+//   rows and the buffer using this table.
+void HyperlinkTable::CopyFrom(const HyperlinkTable& other)
+{
+    _uris = other._uris;
+    _customIds = other._customIds;
+    _customIdsById = other._customIdsById;
+    _nextId = other._nextId;
+}
+
+// Method Description:
+// - Adds a reference to a hyperlink ID.
+void HyperlinkTable::AddRef(const uint16_t id)
+{
+    if (id >= _refCounts.size())
+    {
+        _refCounts.resize(size_t{ id } + 1);
+    }
+    ++til::at(_refCounts, id);
+}
+
+// Method Description:
+// - Drops a reference to a hyperlink ID. The hyperlink is removed when its last reference
+//   is gone, unless it's the current one. That one is removed by SetCurrentId instead.
+void HyperlinkTable::Release(const uint16_t id) noexcept
+{
+    if (id < _refCounts.size() && til::at(_refCounts, id) != 0 && --til::at(_refCounts, id) == 0)
+    {
+        if (id == _currentId)
+        {
+            _currentIdReleased = true;
+        }
+        else
+        {
+            Remove(id);
+        }
+    }
+}
+
+// Method Description:
+// - Returns the number of rows referencing a hyperlink ID.
+size_t HyperlinkTable::GetRefCount(const uint16_t id) const noexcept
+{
+    return id < _refCounts.size() ? til::at(_refCounts, id) : 0;
+}
+
+// Method Description:
+// - Pins the hyperlink ID that the buffer's current attributes refer to, so that it
+//   isn't forgotten while text may still be written with it. The previously pinned
+//   ID is removed if it lost its last row while it was pinned.
+// - Hyperlinks that were never written to any row are kept, as they always were.
+// Arguments:
+// - id - the hyperlink ID of the current attributes, 0 if there is none
+void HyperlinkTable::SetCurrentId(const uint16_t id) noexcept
+{
+    if (id == _currentId)
+    {
+        return;
+    }
+
+    const auto previousId = std::exchange(_currentId, id);
+    if (std::exchange(_currentIdReleased, false) && GetRefCount(previousId) == 0)
+    {
+        Remove(previousId);
+    }
+}
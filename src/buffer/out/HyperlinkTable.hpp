@@ -0,0 +1,63 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HyperlinkTable.hpp
+
+Abstract:
+- The hyperlinks known to a TextBuffer: their URIs, their user-defined (OSC 8
+  "id=") IDs and a reference count per hyperlink ID.
+- Every ATTR_ROW holds one reference to each hyperlink ID used by its runs and
+  updates them whenever its runs change. Once the last row using an ID lets go
+  of it, the hyperlink is forgotten, so recycling a row never requires
+  scanning the rest of the buffer for other uses.
+- The hyperlink the buffer is currently writing with (see SetCurrentId) is
+  pinned: it may lose its last row and be written again right after, e.g.
+  when its only line is erased while it's still open. If it lost its last
+  row that way, it's forgotten once it stops being current instead.
+
+--*/
+
+#pragma once
+
+class HyperlinkTable final
+{
+public:
+    HyperlinkTable() noexcept;
+
+    uint16_t GetId(const std::wstring_view uri, const std::wstring_view customId);
+    void Add(const std::wstring_view uri, const uint16_t id);
+    void AddCustomId(const std::wstring_view customId, const uint16_t id);
+    void Remove(const uint16_t id) noexcept;
+    void Clear() noexcept;
+
+    std::wstring GetUri(const uint16_t id) const;
+    std::wstring GetCustomId(const uint16_t id) const;
+
+    const std::unordered_map<uint16_t, std::wstring>& GetUris() const noexcept;
+    const std::unordered_map<std::wstring, uint16_t>& GetCustomIds() const noexcept;
+
+    uint16_t GetNextId() const noexcept;
+    void SetNextId(const uint16_t id) noexcept;
+
+    void CopyFrom(const HyperlinkTable& other);
+
+    void AddRef(const uint16_t id);
+    void Release(const uint16_t id) noexcept;
+    size_t GetRefCount(const uint16_t id) const noexcept;
+
+    void SetCurrentId(const uint16_t id) noexcept;
+
+private:
+    std::unordered_map<uint16_t, std::wstring> _uris;
+    std::unordered_map<std::wstring, uint16_t> _customIds;
+    // The reverse of _customIds, so that removing a hyperlink doesn't need a search.
+    std::unordered_map<uint16_t, std::wstring> _customIdsById;
+    // Indexed by hyperlink ID. IDs are handed out sequentially, so this stays dense.
+    std::vector<uint32_t> _refCounts;
+    uint16_t _nextId;
+    uint16_t _currentId;
+    // Set if the current ID lost its last row while it was pinned.
+    bool _currentIdReleased;
+};
@@ -18,9 +18,10 @@
 // - constructed object
 ROW::ROW(const SHORT rowId, const unsigned short rowWidth, const TextAttribute fillAttribute, TextBuffer* const pParent) noexcept :
     _id{ rowId },
+    _revision{ 0 },
     _rowWidth{ rowWidth },
     _charRow{ rowWidth, this },
-    _attrRow{ rowWidth, fillAttribute },
+    _attrRow{ rowWidth, fillAttribute, pParent->GetAttributeTable() },
     _lineRendition{ LineRendition::SingleWidth },
     _wrapForced{ false },
     _doubleBytePadded{ false },
@@ -208,3 +209,146 @@ OutputCellIterator ROW::WriteCells(OutputCellIterator it, const size_t index, co
 
     return it;
 }
+
+// Routine Description:
+// - fills a range of columns with a single narrow character and attribute in bulk.
+// - the attributes of a fully covered row collapse into a single run.
+// - wide glyphs that are cut in half by either edge of the range are replaced by spaces.
+// Arguments:
+// - startColumn - first column to fill
+// - endColumn - column after the last one to fill
+// - wch - the character to fill with. must not be a wide glyph.
+// - attr - the attribute to fill with
+// Return Value:
+// - <none>
+// Note:
+// - will throw on error
+// - like WriteCells with wrap set to false, this unsets the wrap flag when the fill covers the last column.
+void ROW::FillCells(const size_t startColumn, const size_t endColumn, const wchar_t wch, const TextAttribute& attr)
+{
+    THROW_HR_IF(E_INVALIDARG, startColumn > endColumn || endColumn > _charRow.size());
+
+    if (startColumn == endColumn)
+    {
+        return;
+    }
+
+    const auto fullRow = startColumn == 0 && endColumn == _charRow.size();
+    if (fullRow && wch == UNICODE_SPACE)
+    {
+        // Blank rows don't need any cell storage.
+        _charRow.Reset();
+    }
+    else
+    {
+        std::fill(_charRow.begin() + startColumn, _charRow.begin() + endColumn, CharRowCell{ wch, DbcsAttribute{} });
+    }
+
+    if (fullRow)
+    {
+        _attrRow.Reset(attr);
+    }
+    else
+    {
+        const TextAttributeRun run{ endColumn - startColumn, attr };
+        THROW_IF_FAILED(_attrRow.InsertAttrRuns({ &run, 1 }, startColumn, endColumn - 1, _charRow.size()));
+    }
+
+    if (startColumn > 0 && _charRow.DbcsAttrAt(startColumn - 1).IsLeading())
+    {
+        _charRow.ClearCell(startColumn - 1);
+    }
+    if (endColumn < _charRow.size() && _charRow.DbcsAttrAt(endColumn).IsTrailing())
+    {
+        _charRow.ClearCell(endColumn);
+    }
+
+    if (endColumn == _charRow.size())
+    {
+        SetWrapForced(false);
+    }
+}
+
+// Routine Description:
+// - copies a range of columns from a row of the same buffer into this row in bulk,
+//   including text, double byte information, stored glyphs and attribute runs.
+// - the source and target ranges may overlap (e.g. when shifting within one row).
+// - wide glyphs that get cut in half by either edge of the copied range are replaced
+//   by spaces, both in the copied cells and in this row's cells next to the range.
+//   callers have to redraw one column beyond either edge of the range for that reason.
+// Arguments:
+// - source - row to copy from. may be this row.
+// - sourceColumn - first column in the source row to copy
+// - targetColumn - column in this row to copy the first cell to
+// - width - number of columns to copy
+// Return Value:
+// - <none>
+// Note:
+// - will throw on error
+void ROW::CopySegment(const ROW& source, const size_t sourceColumn, const size_t targetColumn, const size_t width)
+{
+    THROW_HR_IF(E_INVALIDARG, sourceColumn + width > source.size());
+    THROW_HR_IF(E_INVALIDARG, targetColumn + width > size());
+
+    if (width == 0 || (&source == this && sourceColumn == targetColumn))
+    {
+        return;
+    }
+
+    // Take a copy of everything we need from the source before writing anything,
+    // because the ranges overlap when we're moving cells within the same row.
+    boost::container::small_vector<CharRowCell, 120> cells(width);
+    if (source._charRow.IsMaterialized())
+    {
+        const auto sourceBegin = source._charRow.cbegin() + sourceColumn;
+        std::copy(sourceBegin, sourceBegin + width, cells.begin());
+    }
+
+    std::vector<std::pair<size_t, std::vector<wchar_t>>> glyphs;
+    for (size_t i = 0; i < width; ++i)
+    {
+        if (til::at(cells, i).DbcsAttr().IsGlyphStored())
+        {
+            const std::wstring_view glyph = source._charRow.GlyphAt(sourceColumn + i);
+            glyphs.emplace_back(i, std::vector<wchar_t>{ glyph.cbegin(), glyph.cend() });
+        }
+    }
+
+    std::vector<TextAttributeRun> runs;
+    for (size_t column = sourceColumn; column < sourceColumn + width;)
+    {
+        size_t applies = 0;
+        const auto attr = source._attrRow.GetAttrByColumn(column, &applies);
+        const auto length = std::min(applies, sourceColumn + width - column);
+        runs.emplace_back(length, attr);
+        column += length;
+    }
+
+    // Now write it all into place.
+    std::copy(cells.cbegin(), cells.cend(), _charRow.begin() + targetColumn);
+    for (const auto& [offset, glyph] : glyphs)
+    {
+        _charRow.GlyphAt(targetColumn + offset) = { glyph.data(), glyph.size() };
+    }
+    THROW_IF_FAILED(_attrRow.InsertAttrRuns(runs, targetColumn, targetColumn + width - 1, _charRow.size()));
+
+    // Fix up wide glyphs that are no longer complete. First the halves that we copied...
+    const auto targetRight = targetColumn + width - 1;
+    if (_charRow.DbcsAttrAt(targetColumn).IsTrailing())
+    {
+        _charRow.ClearCell(targetColumn);
+    }
+    if (_charRow.DbcsAttrAt(targetRight).IsLeading())
+    {
+        _charRow.ClearCell(targetRight);
+    }
+    // ...then the halves that we overwrote the other half of.
+    if (targetColumn > 0 && _charRow.DbcsAttrAt(targetColumn - 1).IsLeading())
+    {
+        _charRow.ClearCell(targetColumn - 1);
+    }
+    if (targetRight + 1 < _charRow.size() && _charRow.DbcsAttrAt(targetRight + 1).IsTrailing())
+    {
+        _charRow.ClearCell(targetRight + 1);
+    }
+}
@@ -55,6 +55,10 @@ public:
     SHORT GetId() const noexcept { return _id; }
     void SetId(const SHORT id) noexcept { _id = id; }
 
+    // Changes whenever the row is handed out for writing. See TextBufferSnapshot.
+    uint64_t GetRevision() const noexcept { return _revision; }
+    void SetRevision(const uint64_t revision) noexcept { _revision = revision; }
+
     bool Reset(const TextAttribute Attr);
     [[nodiscard]] HRESULT Resize(const unsigned short width);
 
@@ -66,6 +70,9 @@ public:
 
     OutputCellIterator WriteCells(OutputCellIterator it, const size_t index, const std::optional<bool> wrap = std::nullopt, std::optional<size_t> limitRight = std::nullopt);
 
+    void CopySegment(const ROW& source, const size_t sourceColumn, const size_t targetColumn, const size_t width);
+    void FillCells(const size_t startColumn, const size_t endColumn, const wchar_t wch, const TextAttribute& attr);
+
 #ifdef UNIT_TESTING
     friend constexpr bool operator==(const ROW& a, const ROW& b) noexcept;
     friend class RowTests;
@@ -76,6 +83,7 @@ private:
     ATTR_ROW _attrRow;
     LineRendition _lineRendition;
     SHORT _id;
+    uint64_t _revision;
     unsigned short _rowWidth;
     // Occurs when the user runs out of text in a given row and we're forced to wrap the cursor to the next line
     bool _wrapForced;
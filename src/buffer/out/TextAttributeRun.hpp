@@ -21,6 +21,7 @@ Revision History:
 #pragma once
 
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
 
 class TextAttributeRun final
 {
@@ -48,3 +49,32 @@ private:
     friend class AttrRowTests;
 #endif
 };
+
+// The form in which ATTR_ROW stores its runs internally. Instead of the
+// attribute itself it holds its ID in the owning TextBuffer's TextAttributeTable.
+class TextAttributeIdRun final
+{
+public:
+    TextAttributeIdRun() = default;
+    constexpr TextAttributeIdRun(const size_t cchLength, const TextAttributeTable::id_type attrId) noexcept :
+        _cchLength(gsl::narrow_cast<unsigned int>(cchLength)),
+        _attrId(attrId)
+    {
+    }
+
+    size_t GetLength() const noexcept { return _cchLength; }
+    void SetLength(const size_t cchLength) noexcept { _cchLength = gsl::narrow<unsigned int>(cchLength); }
+    void IncrementLength() noexcept { _cchLength++; }
+    void DecrementLength() noexcept { _cchLength--; }
+
+    TextAttributeTable::id_type GetAttributeId() const noexcept { return _attrId; }
+    void SetAttributeId(const TextAttributeTable::id_type attrId) noexcept { _attrId = attrId; }
+
+private:
+    unsigned int _cchLength{ 0 };
+    TextAttributeTable::id_type _attrId{ 0 };
+
+#ifdef UNIT_TESTING
+    friend class AttrRowTests;
+#endif
+};
@@ -0,0 +1,200 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextAttributeTable.hpp"
+
+// Routine Description:
+// - constructor. The table always starts out containing the default
+//   attribute, so that ID 0 is valid in every table.
+// Arguments:
+// - hyperlinks - the hyperlink table rows should keep their hyperlink references in. May be null.
+TextAttributeTable::TextAttributeTable(HyperlinkTable* hyperlinks) :
+    _attributes{},
+    _ids{},
+    _lastId{ 0 },
+    _hyperlinks{ hyperlinks },
+    _hasHyperlinks{ false }
+{
+    Intern(TextAttribute{});
+}
+
+// Routine Description:
+// - Returns the ID for the given attribute, adding it to the table if it
+//   hasn't been seen before.
+// Arguments:
+// - attr - the attribute to intern
+// Return Value:
+// - the ID under which attr is stored.
+// Note:
+// - The owning buffer is expected to Compact() well before the ID space is
+//   exhausted. Not every path that interns an attribute can compact though
+//   (a row can't remap IDs it's in the middle of splicing), so once the
+//   table is full we fall back to the closest attribute already interned
+//   instead of failing the write. The next compaction restores exact colors.
+TextAttributeTable::id_type TextAttributeTable::Intern(const TextAttribute& attr)
+{
+    if (!_attributes.empty() && At(_lastId) == attr)
+    {
+        return _lastId;
+    }
+
+    const auto it = _ids.find(attr);
+    if (it != _ids.end())
+    {
+        _lastId = it->second;
+        return _lastId;
+    }
+
+    if (_attributes.size() > std::numeric_limits<id_type>::max())
+    {
+        return _FindClosest(attr);
+    }
+
+    const auto id = gsl::narrow_cast<id_type>(_attributes.size());
+    _attributes.emplace_back(attr);
+    _ids.emplace(attr, id);
+    _lastId = id;
+    _hasHyperlinks |= attr.IsHyperlink();
+    return id;
+}
+
+// Routine Description:
+// - Returns the ID for the given attribute without adding it to the table.
+// Arguments:
+// - attr - the attribute to look for
+// Return Value:
+// - the ID of attr, or nullopt if it was never interned.
+std::optional<TextAttributeTable::id_type> TextAttributeTable::Find(const TextAttribute& attr) const noexcept
+{
+    const auto it = _ids.find(attr);
+    if (it == _ids.end())
+    {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+size_t TextAttributeTable::size() const noexcept
+{
+    return _attributes.size();
+}
+
+bool TextAttributeTable::ShouldCompact() const noexcept
+{
+    return _attributes.size() >= CompactionThreshold;
+}
+
+HyperlinkTable* TextAttributeTable::GetHyperlinkTable() const noexcept
+{
+    return _hyperlinks;
+}
+
+bool TextAttributeTable::HasHyperlinks() const noexcept
+{
+    return _hasHyperlinks;
+}
+
+// Routine Description:
+// - Drops all attributes that aren't in use anymore and renumbers the remaining ones.
+// - All references previously returned by At() are invalidated.
+// Arguments:
+// - inUse - a flag for each ID in the table, set if that ID is still referenced.
+// Return Value:
+// - A mapping from old IDs to new IDs. Entries for unused IDs are unspecified.
+std::vector<TextAttributeTable::id_type> TextAttributeTable::Compact(const std::vector<bool>& inUse)
+{
+    std::vector<id_type> newIds(_attributes.size(), 0);
+    std::deque<TextAttribute> attributes;
+    decltype(_ids) ids;
+
+    for (size_t oldId = 0; oldId < _attributes.size(); ++oldId)
+    {
+        // The default attribute keeps ID 0 so that freshly reset rows never need remapping.
+        if (oldId == 0 || (oldId < inUse.size() && inUse[oldId]))
+        {
+            const auto newId = gsl::narrow_cast<id_type>(attributes.size());
+            const auto& attr = til::at(_attributes, oldId);
+            attributes.emplace_back(attr);
+            ids.emplace(attr, newId);
+            til::at(newIds, oldId) = newId;
+        }
+    }
+
+    _attributes.swap(attributes);
+    _ids.swap(ids);
+    _lastId = 0;
+    return newIds;
+}
+
+// Routine Description:
+// - Returns the ID of the interned attribute that looks the most like the given one.
+// - Differences in rendition and hyperlinks weigh more than any difference in
+//   color. RGB colors are compared by their distance, all others must be equal.
+// - This scans the entire table and is only used when it's full.
+// Arguments:
+// - attr - the attribute to find a stand-in for
+// Return Value:
+// - the ID of the closest match.
+TextAttributeTable::id_type TextAttributeTable::_FindClosest(const TextAttribute& attr) const noexcept
+{
+    const auto colorDistance = [](const TextColor a, const TextColor b) noexcept -> uint32_t {
+        if (a == b)
+        {
+            return 0;
+        }
+        if (a.IsRgb() && b.IsRgb())
+        {
+            const auto ca = a.GetRGB();
+            const auto cb = b.GetRGB();
+            return gsl::narrow_cast<uint32_t>(std::abs(GetRValue(ca) - GetRValue(cb)) +
+                                              std::abs(GetGValue(ca) - GetGValue(cb)) +
+                                              std::abs(GetBValue(ca) - GetBValue(cb)));
+        }
+        return 1024;
+    };
+
+    id_type closestId = 0;
+    auto closestDistance = std::numeric_limits<uint32_t>::max();
+    for (size_t id = 0; id < _attributes.size() && closestDistance != 0; ++id)
+    {
+        const auto& candidate = til::at(_attributes, id);
+        auto distance = colorDistance(candidate.GetForeground(), attr.GetForeground()) +
+                        colorDistance(candidate.GetBackground(), attr.GetBackground());
+        if (candidate.GetExtendedAttributes() != attr.GetExtendedAttributes() ||
+            candidate.IsReverseVideo() != attr.IsReverseVideo())
+        {
+            distance += 4096;
+        }
+        if (candidate.GetHyperlinkId() != attr.GetHyperlinkId())
+        {
+            distance += 8192;
+        }
+        if (distance < closestDistance)
+        {
+            closestId = gsl::narrow_cast<id_type>(id);
+            closestDistance = distance;
+        }
+    }
+    return closestId;
+}
+
+// Routine Description:
+// - Hashes a TextAttribute. Two attributes that compare equal always produce the same hash.
+size_t TextAttributeTable::Hasher::operator()(const TextAttribute& attr) const noexcept
+{
+    const auto hashColor = [](const TextColor color) noexcept -> size_t {
+        if (color.IsDefault())
+        {
+            return 0x1000000;
+        }
+        return color.IsRgb() ? color.GetRGB() : (color.GetIndex() | (color.IsIndex256() ? 0x2000000 : 0x4000000));
+    };
+
+    size_t hash = hashColor(attr.GetForeground());
+    hash = hash * 31 + hashColor(attr.GetBackground());
+    hash = hash * 31 + static_cast<size_t>(attr.GetExtendedAttributes());
+    hash = hash * 31 + attr.GetHyperlinkId();
+    hash = hash * 31 + attr.IsReverseVideo();
+    return hash;
+}
@@ -0,0 +1,81 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextAttributeTable.hpp
+
+Abstract:
+- Interning table for text attributes. Each TextBuffer owns one table and its
+  rows store 16-bit IDs into it instead of full TextAttribute values. That way
+  run splicing moves 8-byte runs around and attribute comparisons in the hot
+  paths are a single integer comparison.
+- The table isn't synchronized. Like the TextBuffer that owns it, it may only
+  be accessed, and that includes the reads through At(), while holding the
+  lock that guards the buffer (the console lock in conhost, the Terminal's
+  write lock in Windows Terminal). Readers that run without that lock must
+  copy the attributes they need while holding it, as TextBufferSnapshot does.
+
+--*/
+
+#pragma once
+
+#include "TextAttribute.hpp"
+
+class HyperlinkTable;
+
+class TextAttributeTable final
+{
+public:
+    using id_type = uint16_t;
+
+    // Once we cross this many distinct attributes, the owning buffer should
+    // compact the table before writing more. The remaining head room ensures
+    // that a single write can't exhaust the ID space.
+    static constexpr size_t CompactionThreshold = 0xF000;
+
+    explicit TextAttributeTable(HyperlinkTable* hyperlinks = nullptr);
+
+    id_type Intern(const TextAttribute& attr);
+    std::optional<id_type> Find(const TextAttribute& attr) const noexcept;
+
+    // The returned reference is stable until the next call to Compact().
+    const TextAttribute& At(const id_type id) const noexcept
+    {
+        return til::at(_attributes, id);
+    }
+
+    size_t size() const noexcept;
+    bool ShouldCompact() const noexcept;
+
+    // The hyperlink table that rows using this table keep their references in, if any.
+    HyperlinkTable* GetHyperlinkTable() const noexcept;
+    // Whether any attribute with a hyperlink was ever interned. Lets rows skip
+    // hyperlink bookkeeping entirely in buffers that never saw a hyperlink.
+    bool HasHyperlinks() const noexcept;
+
+    std::vector<id_type> Compact(const std::vector<bool>& inUse);
+
+private:
+    struct Hasher
+    {
+        size_t operator()(const TextAttribute& attr) const noexcept;
+    };
+
+    // std::deque doesn't invalidate references on push_back, which allows
+    // ATTR_ROW iterators to hand out TextAttribute references safely.
+    std::deque<TextAttribute> _attributes;
+    std::unordered_map<TextAttribute, id_type, Hasher> _ids;
+
+    // Nearly every write uses the same attribute as the previous one.
+    id_type _lastId;
+
+    id_type _FindClosest(const TextAttribute& attr) const noexcept;
+
+    HyperlinkTable* _hyperlinks;
+    bool _hasHyperlinks;
+
+#ifdef UNIT_TESTING
+    friend class AttrRowTests;
+#endif
+};
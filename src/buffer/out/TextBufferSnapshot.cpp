@@ -0,0 +1,319 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "TextBufferSnapshot.hpp"
+#include "Row.hpp"
+
+#include "../../types/inc/GlyphWidth.hpp"
+
+// Routine Description:
+// - Captures the contents of a row.
+// Arguments:
+// - row - the row to copy
+TextBufferSnapshot::Row::Row(const ROW& row) :
+    _text{ row.GetText() },
+    _columns{},
+    _attributeRuns{ row.GetAttrRow().GetRuns() },
+    _wrapForced{ row.WasWrapForced() },
+    _lineRendition{ row.GetLineRendition() },
+    _revision{ row.GetRevision() }
+{
+    // Only wide glyphs and surrogate pairs break the 1:1 mapping between
+    // characters and cells. Rows with one character per cell and no trailing
+    // halves can't contain either, so they don't need a column map.
+    const auto& charRow = row.GetCharRow();
+    if (!charRow.IsMaterialized())
+    {
+        return;
+    }
+
+    auto identity = _text.size() == charRow.size();
+    for (size_t column = 0; identity && column < charRow.size(); ++column)
+    {
+        identity = !charRow.DbcsAttrAt(column).IsTrailing();
+    }
+    if (identity)
+    {
+        return;
+    }
+
+    _columns.reserve(_text.size());
+    for (size_t column = 0; column < charRow.size(); ++column)
+    {
+        if (!charRow.DbcsAttrAt(column).IsTrailing())
+        {
+            const std::wstring_view glyph{ charRow.GlyphAt(column) };
+            _columns.insert(_columns.end(), glyph.size(), gsl::narrow_cast<uint16_t>(column));
+        }
+    }
+}
+
+// Routine Description:
+// - Creates an empty snapshot. TextBuffer::TakeSnapshot fills it.
+// Arguments:
+// - bufferId - identifies the buffer the rows are taken from
+// - firstRow - the buffer row that the first row of the snapshot corresponds to
+// - rowWidth - the width of the buffer's rows
+TextBufferSnapshot::TextBufferSnapshot(const uint64_t bufferId, const size_t firstRow, const size_t rowWidth) :
+    _bufferId{ bufferId },
+    _firstRow{ firstRow },
+    _rowWidth{ rowWidth },
+    _rows{},
+    _rowsByRevision{},
+    _sharedRows{ 0 }
+{
+}
+
+// Routine Description:
+// - Returns the row at the given index, relative to GetFirstRow().
+// Note:
+// - will throw if the index is out of bounds
+const TextBufferSnapshot::Row& TextBufferSnapshot::GetRow(const size_t index) const
+{
+    return *_rows.at(index);
+}
+
+// Routine Description:
+// - Looks for a copy of the given revision of a row in this snapshot.
+// Arguments:
+// - bufferId - the buffer the row belongs to
+// - revision - the revision of the row
+// Return Value:
+// - the captured row or nullptr if this snapshot doesn't have it.
+std::shared_ptr<const TextBufferSnapshot::Row> TextBufferSnapshot::FindRow(const uint64_t bufferId, const uint64_t revision) const noexcept
+{
+    if (bufferId != _bufferId)
+    {
+        return nullptr;
+    }
+
+    const auto it = _rowsByRevision.find(revision);
+    return it == _rowsByRevision.end() ? nullptr : til::at(_rows, it->second);
+}
+
+// Routine Description:
+// - Adds the next row to the snapshot.
+// Arguments:
+// - row - the captured row
+// - shared - true if the row was reused from another snapshot rather than copied
+void TextBufferSnapshot::AppendRow(std::shared_ptr<const Row> row, const bool shared)
+{
+    _rowsByRevision.emplace(row->GetRevision(), _rows.size());
+    _rows.emplace_back(std::move(row));
+    _sharedRows += shared ? 1 : 0;
+}
+
+// Method Description:
+// - Finds patterns within the rows of this snapshot
+// Arguments:
+// - idsAndPatterns - the regular expressions to look for, keyed by their ID
+// Return value:
+// - An interval tree containing the patterns found, relative to the first row of the snapshot
+interval_tree::IntervalTree<til::point, size_t> TextBufferSnapshot::FindPatterns(const std::unordered_map<size_t, std::wstring>& idsAndPatterns) const
+{
+    using PointTree = interval_tree::IntervalTree<til::point, size_t>;
+    PointTree::interval_vector intervals;
+
+    std::wstring concatAll;
+    const auto rowSize = _rowWidth;
+    concatAll.reserve(rowSize * _rows.size());
+
+    // to deal with text that spans multiple lines, we will first concatenate
+    // all the text into one string and find the patterns in that string
+    for (const auto& row : _rows)
+    {
+        concatAll += row->GetText();
+    }
+
+    // for each pattern we know of, iterate through the string
+    for (const auto& idAndPattern : idsAndPatterns)
+    {
+        std::wregex regexObj{ idAndPattern.second };
+
+        // search through the run with our regex object
+        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
+        auto words_end = std::wsregex_iterator();
+
+        size_t lenUpToThis = 0;
+        for (auto i = words_begin; i != words_end; ++i)
+        {
+            // record the locations -
+            // when we find a match, the prefix is text that is between this
+            // match and the previous match, so we use the size of the prefix
+            // along with the size of the match to determine the locations
+            size_t prefixSize = 0;
+
+            for (const auto ch : i->prefix().str())
+            {
+                prefixSize += IsGlyphFullWidth(ch) ? 2 : 1;
+            }
+            const auto start = lenUpToThis + prefixSize;
+            size_t matchSize = 0;
+            for (const auto ch : i->str())
+            {
+                matchSize += IsGlyphFullWidth(ch) ? 2 : 1;
+            }
+            const auto end = start + matchSize;
+            lenUpToThis = end;
+
+            const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(start / rowSize) };
+            const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(end / rowSize) };
+
+            // store the intervals
+            // NOTE: these intervals are relative to the VIEWPORT not the buffer
+            // Keeping these relative to the viewport for now because its the renderer
+            // that actually uses these locations and the renderer works relative to
+            // the viewport
+            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
+        }
+    }
+    PointTree result(std::move(intervals));
+    return result;
+}
+
+// Method Description:
+// - Looks for text within the given range of this snapshot. Matches may span rows.
+// - The rows are visited one at a time and the search stops at the first match,
+//   so finding something close to the start of a large range stays cheap.
+// Arguments:
+// - needle - the text to look for
+// - ignoreCase - whether to compare the text case-insensitively
+// - backward - whether to look for the last match rather than the first one
+// - start - the first cell of the range to search, in buffer coordinates (inclusive)
+// - end - the end of the range to search, in buffer coordinates (exclusive)
+// Return value:
+// - the first and the last cell of the match in buffer coordinates (both inclusive),
+//   or nullopt if the range doesn't contain the text.
+std::optional<std::pair<til::point, til::point>> TextBufferSnapshot::FindText(const std::wstring_view needle,
+                                                                              const bool ignoreCase,
+                                                                              const bool backward,
+                                                                              const til::point start,
+                                                                              const til::point end) const
+{
+    if (needle.empty() || _rows.empty())
+    {
+        return std::nullopt;
+    }
+
+    const auto fold = [ignoreCase](const wchar_t wch) noexcept {
+        return ignoreCase ? gsl::narrow_cast<wchar_t>(::towlower(wch)) : wch;
+    };
+
+    std::wstring foldedNeedle;
+    foldedNeedle.reserve(needle.size());
+    std::transform(needle.begin(), needle.end(), std::back_inserter(foldedNeedle), fold);
+
+    // For every character of the haystack we keep the cells of the glyph it
+    // belongs to, and whether the character begins or ends that glyph.
+    // A match has to begin and end on glyph boundaries.
+    struct Character
+    {
+        til::point first;
+        til::point last;
+        bool begins;
+        bool ends;
+    };
+
+    // Appends the characters of the given row that lie within the range.
+    const auto readRow = [&](const ptrdiff_t y, std::wstring& text, std::vector<Character>& characters) {
+        const auto& row = GetRow(gsl::narrow_cast<size_t>(y) - _firstRow);
+        const auto& rowText = row.GetText();
+        const auto left = y == start.y() ? start.x() : 0;
+        const auto right = y == end.y() ? end.x() : gsl::narrow_cast<ptrdiff_t>(_rowWidth);
+
+        for (size_t i = 0; i < rowText.size(); ++i)
+        {
+            const auto column = gsl::narrow_cast<ptrdiff_t>(row.GetColumn(i));
+            if (column < left || column >= right)
+            {
+                continue;
+            }
+
+            auto next = i + 1;
+            while (next < rowText.size() && gsl::narrow_cast<ptrdiff_t>(row.GetColumn(next)) == column)
+            {
+                ++next;
+            }
+            const auto lastColumn = next < rowText.size() ? gsl::narrow_cast<ptrdiff_t>(row.GetColumn(next)) - 1 : gsl::narrow_cast<ptrdiff_t>(_rowWidth) - 1;
+
+            text.push_back(fold(til::at(rowText, i)));
+            characters.push_back({ til::point{ column, y },
+                                   til::point{ lastColumn, y },
+                                   i == 0 || gsl::narrow_cast<ptrdiff_t>(row.GetColumn(i - 1)) != column,
+                                   next == i + 1 });
+        }
+    };
+
+    const auto matchAt = [&](const std::vector<Character>& characters, const size_t pos) -> std::optional<std::pair<til::point, til::point>> {
+        const auto& first = til::at(characters, pos);
+        const auto& last = til::at(characters, pos + foldedNeedle.size() - 1);
+        if (first.begins && last.ends)
+        {
+            return std::pair{ first.first, last.last };
+        }
+        return std::nullopt;
+    };
+
+    const auto firstRow = std::max(start.y(), gsl::narrow_cast<ptrdiff_t>(_firstRow));
+    const auto lastRow = std::min(end.y(), gsl::narrow_cast<ptrdiff_t>(_firstRow + _rows.size()) - 1);
+
+    // The haystack holds the current row plus the few characters of the
+    // previously visited rows that a match spanning into this row could use.
+    // A match can't lie entirely within those, so none is found twice.
+    const auto carry = foldedNeedle.size() - 1;
+    std::wstring haystack;
+    std::vector<Character> characters;
+
+    if (!backward)
+    {
+        for (auto y = firstRow; y <= lastRow; ++y)
+        {
+            readRow(y, haystack, characters);
+
+            for (auto pos = haystack.find(foldedNeedle); pos != std::wstring::npos; pos = haystack.find(foldedNeedle, pos + 1))
+            {
+                if (const auto match = matchAt(characters, pos))
+                {
+                    return match;
+                }
+            }
+
+            if (haystack.size() > carry)
+            {
+                const auto excess = haystack.size() - carry;
+                haystack.erase(0, excess);
+                characters.erase(characters.begin(), characters.begin() + excess);
+            }
+        }
+    }
+    else
+    {
+        std::wstring rowText;
+        std::vector<Character> rowCharacters;
+        for (auto y = lastRow; y >= firstRow; --y)
+        {
+            rowText.clear();
+            rowCharacters.clear();
+            readRow(y, rowText, rowCharacters);
+            haystack.insert(0, rowText);
+            characters.insert(characters.begin(), rowCharacters.begin(), rowCharacters.end());
+
+            for (auto pos = haystack.rfind(foldedNeedle); pos != std::wstring::npos; pos = pos == 0 ? std::wstring::npos : haystack.rfind(foldedNeedle, pos - 1))
+            {
+                if (const auto match = matchAt(characters, pos))
+                {
+                    return match;
+                }
+            }
+
+            if (haystack.size() > carry)
+            {
+                haystack.resize(carry);
+                characters.resize(carry);
+            }
+        }
+    }
+
+    return std::nullopt;
+}
@@ -0,0 +1,82 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- TextBufferSnapshot.hpp
+
+Abstract:
+- An immutable copy of a range of rows of a TextBuffer. Pattern detection
+  (Terminal::UpdatePatterns) and UIA text search (UiaTextRangeBase::FindText)
+  take one while holding the buffer lock and then release the lock before
+  walking it, so that the regular expressions and the search don't stall output
+  processing. Everything else (Search, selection, clipboard and the rest of UIA)
+  still reads the live buffer under the lock.
+- Taking a snapshot is still O(rows in the range) under the lock, since every
+  row's revision has to be compared. Only the rows that changed are copied:
+  every row has a revision that's unique within its buffer and changes whenever
+  it's handed out for writing, and rows whose revision didn't change since the
+  previous snapshot are shared with it.
+
+--*/
+
+#pragma once
+
+#include "TextAttributeRun.hpp"
+#include "LineRendition.hpp"
+
+class ROW;
+
+class TextBufferSnapshot final
+{
+public:
+    class Row final
+    {
+    public:
+        explicit Row(const ROW& row);
+
+        const std::wstring& GetText() const noexcept { return _text; }
+        // The cell that the character at the given index of GetText() belongs to.
+        size_t GetColumn(const size_t index) const noexcept { return _columns.empty() ? index : til::at(_columns, index); }
+        const std::vector<TextAttributeRun>& GetAttributeRuns() const noexcept { return _attributeRuns; }
+        bool WasWrapForced() const noexcept { return _wrapForced; }
+        LineRendition GetLineRendition() const noexcept { return _lineRendition; }
+        uint64_t GetRevision() const noexcept { return _revision; }
+
+    private:
+        std::wstring _text;
+        // Empty if every character maps to exactly one cell, which is true for most rows.
+        std::vector<uint16_t> _columns;
+        std::vector<TextAttributeRun> _attributeRuns;
+        bool _wrapForced;
+        LineRendition _lineRendition;
+        uint64_t _revision;
+    };
+
+    TextBufferSnapshot(const uint64_t bufferId, const size_t firstRow, const size_t rowWidth);
+
+    size_t GetFirstRow() const noexcept { return _firstRow; }
+    size_t GetRowWidth() const noexcept { return _rowWidth; }
+    size_t size() const noexcept { return _rows.size(); }
+    const Row& GetRow(const size_t index) const;
+
+    size_t GetSharedRowCount() const noexcept { return _sharedRows; }
+
+    std::shared_ptr<const Row> FindRow(const uint64_t bufferId, const uint64_t revision) const noexcept;
+    void AppendRow(std::shared_ptr<const Row> row, const bool shared);
+
+    interval_tree::IntervalTree<til::point, size_t> FindPatterns(const std::unordered_map<size_t, std::wstring>& idsAndPatterns) const;
+    std::optional<std::pair<til::point, til::point>> FindText(const std::wstring_view needle,
+                                                              const bool ignoreCase,
+                                                              const bool backward,
+                                                              const til::point start,
+                                                              const til::point end) const;
+
+private:
+    uint64_t _bufferId;
+    size_t _firstRow;
+    size_t _rowWidth;
+    std::vector<std::shared_ptr<const Row>> _rows;
+    std::unordered_map<uint64_t, size_t> _rowsByRevision;
+    size_t _sharedRows;
+};
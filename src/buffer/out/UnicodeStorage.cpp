@@ -5,94 +5,114 @@
 #include "UnicodeStorage.hpp"
 
 UnicodeStorage::UnicodeStorage() noexcept :
-    _map{}
+    _glyphs{},
+    _keys{},
+    _free{},
+    _sizeAfterCompact{ 0 }
 {
 }
 
 // Routine Description:
 // - fetches the text associated with key
 // Arguments:
-// - key - the key into the storage
+// - key - the handle returned by StoreGlyph
 // Return Value:
-// - the glyph data associated with key
+// - the glyph data associated with key. Valid until the glyph is compacted away.
 // Note: will throw exception if key is not stored yet
-const UnicodeStorage::mapped_type& UnicodeStorage::GetText(const key_type key) const
+std::wstring_view UnicodeStorage::GetText(const key_type key) const
 {
-    return _map.at(key);
+    return _glyphs.at(key);
 }
 
 // Routine Description:
-// - stores glyph data associated with key.
+// - stores glyph data, unless an identical glyph is already stored.
 // Arguments:
-// - key - the key into the storage
 // - glyph - the glyph data to store
-void UnicodeStorage::StoreGlyph(const key_type key, const mapped_type& glyph)
+// Return Value:
+// - the handle to store in the cell the glyph belongs to.
+// Note:
+// - will throw E_OUTOFMEMORY if the handle space is exhausted.
+//   The owning buffer is expected to Compact() well before that happens.
+UnicodeStorage::key_type UnicodeStorage::StoreGlyph(const std::wstring_view glyph)
 {
-    _map.insert_or_assign(key, glyph);
+    THROW_HR_IF(E_INVALIDARG, glyph.empty());
+
+    const auto it = _keys.find(glyph);
+    if (it != _keys.end())
+    {
+        return it->second;
+    }
+
+    key_type key;
+    if (!_free.empty())
+    {
+        key = _free.back();
+        til::at(_glyphs, key) = glyph;
+        _free.pop_back();
+    }
+    else
+    {
+        THROW_HR_IF(E_OUTOFMEMORY, _glyphs.size() > std::numeric_limits<key_type>::max());
+        key = gsl::narrow_cast<key_type>(_glyphs.size());
+        _glyphs.emplace_back(glyph);
+    }
+
+    try
+    {
+        _keys.emplace(til::at(_glyphs, key), key);
+    }
+    catch (...)
+    {
+        til::at(_glyphs, key).clear();
+        _free.emplace_back(key);
+        throw;
+    }
+    return key;
 }
 
 // Routine Description:
-// - erases key and its associated data from the storage
-// Arguments:
-// - key - the key to remove
-void UnicodeStorage::Erase(const key_type key) noexcept
+// - returns the number of distinct glyphs stored
+size_t UnicodeStorage::size() const noexcept
 {
-    _map.erase(key);
+    return _keys.size();
 }
 
 // Routine Description:
-// - Remaps all of the stored items to new coordinate positions
-//   based on a bulk rearrangement of row IDs and potential row width resize.
-// Arguments:
-// - rowMap - A map of the old row IDs to the new row IDs.
-// - width - The width of the new row. Remove any items that are beyond the row width.
-//         - Use nullopt if we're not resizing the width of the row, just renumbering the rows.
-void UnicodeStorage::Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width)
+// - returns true if the handle space is running out and enough glyphs were stored
+//   since the last compaction that it could free a meaningful number of handles.
+bool UnicodeStorage::ShouldCompact() const noexcept
 {
-    // Make a temporary map to hold all the new row positioning
-    std::unordered_map<key_type, mapped_type> newMap;
+    return _free.empty() &&
+           _glyphs.size() >= CompactionThreshold &&
+           _keys.size() >= _sizeAfterCompact + CompactionMargin;
+}
 
-    // Walk through every stored item.
-    for (const auto& pair : _map)
+// Routine Description:
+// - Drops all glyphs that aren't in use anymore. Their handles are handed out again
+//   by later calls to StoreGlyph, while the handles of the remaining glyphs stay the same.
+// Arguments:
+// - inUse - a flag for each handle, set if a cell still refers to that handle.
+void UnicodeStorage::Compact(const std::vector<bool>& inUse)
+{
+    for (size_t key = 0; key < _glyphs.size(); ++key)
     {
-        // Extract the old coordinate position
-        const auto oldCoord = pair.first;
-
-        // Only try to short-circuit based on width if we were told it changed
-        // by being given a new width value.
-        if (width.has_value())
-        {
-            // Get the column ID
-            const auto oldColId = oldCoord.X;
-
-            // If the column index is at/beyond the row width, don't bother copying it to the new map.
-            if (oldColId >= width.value())
-            {
-                continue;
-            }
-        }
-
-        // Get the row ID from the position as that's what we need to remap
-        const auto oldRowId = oldCoord.Y;
-
-        // Use the mapping given to convert the old row ID to the new row ID
-        const auto mapIter = rowMap.find(oldRowId);
-
-        // If there's no mapping to a new row, don't bother copying it to the new map. The row is gone.
-        if (mapIter == rowMap.end())
+        auto& glyph = til::at(_glyphs, key);
+        if (!glyph.empty() && (key >= inUse.size() || !inUse[key]))
         {
-            continue;
+            _keys.erase(glyph);
+            glyph.clear();
+            _free.emplace_back(gsl::narrow_cast<key_type>(key));
         }
-
-        const auto newRowId = mapIter->second;
-
-        // Generate a new coordinate with the same X as the old one, but a new Y value.
-        const auto newCoord = COORD{ oldCoord.X, newRowId };
-
-        // Put the adjusted coordinate into the map with the original value.
-        newMap.emplace(newCoord, pair.second);
     }
+    _sizeAfterCompact = _keys.size();
+}
 
-    // Swap into the stored map, free the temporary when we exit.
-    _map.swap(newMap);
+// Routine Description:
+// - erases all stored glyphs
+void UnicodeStorage::clear() noexcept
+{
+    _keys.clear();
+    _glyphs.clear();
+    _free.clear();
+    _sizeAfterCompact = 0;
 }
@@ -7,6 +7,9 @@ Module Name:
 
 Abstract:
 - dynamic storage location for glyphs that can't normally fit in the output buffer
+- Glyphs are interned: every distinct glyph is stored once and cells refer to it
+  through a 16-bit handle kept in their character field. Handles don't depend on
+  the position of the cell, so rows can be moved around without touching this storage.
 
 Author(s):
 - Austin Diviness (AustDi) 02-May-2018
@@ -14,51 +17,43 @@ Author(s):
 
 #pragma once
 
+#include <deque>
 #include <vector>
 #include <unordered_map>
-#include <climits>
-
-// std::unordered_map needs help to know how to hash a COORD
-namespace std
-{
-    template<>
-    struct hash<COORD>
-    {
-        // Routine Description:
-        // - hashes a coord. coord will be hashed by storing the x and y values consecutively in the lower
-        // bits of a size_t.
-        // Arguments:
-        // - coord - the coord to hash
-        // Return Value:
-        // - the hashed coord
-        constexpr size_t operator()(const COORD& coord) const noexcept
-        {
-            size_t retVal = coord.Y;
-            const size_t xCoord = coord.X;
-            retVal |= xCoord << (sizeof(coord.Y) * CHAR_BIT);
-            return retVal;
-        }
-    };
-}
 
 class UnicodeStorage final
 {
 public:
-    using key_type = typename COORD;
-    using mapped_type = typename std::vector<wchar_t>;
+    using key_type = wchar_t;
 
-    UnicodeStorage() noexcept;
+    // Once we cross this many glyphs, the owning buffer should drop the ones
+    // that no cell refers to anymore. The remaining head room ensures that a
+    // single write can't exhaust the handle space.
+    static constexpr size_t CompactionThreshold = 0xF000;
+    // Compacting requires a scan of the entire buffer. If most glyphs are still
+    // in use, we only do it again once this many were stored since the last time.
+    static constexpr size_t CompactionMargin = 0x400;
 
-    const mapped_type& GetText(const key_type key) const;
+    UnicodeStorage() noexcept;
 
-    void StoreGlyph(const key_type key, const mapped_type& glyph);
+    std::wstring_view GetText(const key_type key) const;
 
-    void Erase(const key_type key) noexcept;
+    key_type StoreGlyph(const std::wstring_view glyph);
 
-    void Remap(const std::unordered_map<SHORT, SHORT>& rowMap, const std::optional<SHORT> width);
+    size_t size() const noexcept;
+    bool ShouldCompact() const noexcept;
+    void Compact(const std::vector<bool>& inUse);
+    void clear() noexcept;
 
 private:
-    std::unordered_map<key_type, mapped_type> _map;
+    // std::deque doesn't move its elements on push_back, which keeps the
+    // views used as keys in _keys valid.
+    std::deque<std::wstring> _glyphs;
+    std::unordered_map<std::wstring_view, key_type> _keys;
+    // Handles that were released by Compact() and can be handed out again.
+    std::vector<key_type> _free;
+    // The number of glyphs that were left over by the last Compact().
+    size_t _sizeAfterCompact;
 
 #ifdef UNIT_TESTING
     friend class UnicodeStorageTests;
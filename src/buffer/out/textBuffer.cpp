@@ -5,6 +5,7 @@
 
 #include "textBuffer.hpp"
 #include "CharRow.hpp"
+#include "TextBufferSnapshot.hpp"
 
 #include "../types/inc/utils.hpp"
 #include "../types/inc/convert.hpp"
@@ -17,6 +18,13 @@ using namespace Microsoft::Console::Types;
 
 using PointTree = interval_tree::IntervalTree<til::point, size_t>;
 
+// Every buffer gets its own ID so that snapshots never share rows between buffers.
+static uint64_t s_NextSnapshotId() noexcept
+{
+    static std::atomic<uint64_t> nextId{ 0 };
+    return ++nextId;
+}
+
 // Routine Description:
 // - Creates a new instance of TextBuffer
 // Arguments:
@@ -34,13 +42,18 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
     _firstRow{ 0 },
     _currentAttributes{ defaultAttributes },
     _cursor{ cursorSize, *this },
+    _hyperlinks{},
+    _attributeTable{ &_hyperlinks },
     _storage{},
+    _snapshotId{ s_NextSnapshotId() },
+    _lastRevision{ 0 },
     _unicodeStorage{},
     _renderTarget{ renderTarget },
     _size{},
-    _currentHyperlinkId{ 1 },
     _currentPatternId{ 0 }
 {
+    _hyperlinks.SetCurrentId(_currentAttributes.GetHyperlinkId());
+
     // initialize ROWs
     _storage.reserve(static_cast<size_t>(screenBufferSize.Y));
     for (size_t i = 0; i < static_cast<size_t>(screenBufferSize.Y); ++i)
@@ -48,6 +61,10 @@ TextBuffer::TextBuffer(const COORD screenBufferSize,
         _storage.emplace_back(static_cast<SHORT>(i), screenBufferSize.X, _currentAttributes, this);
     }
 
+    // Every row starts out with a revision of its own, so that no two rows
+    // of this buffer can ever be mistaken for one another by a snapshot.
+    _TouchAllRows();
+
     _UpdateSize();
 }
 
@@ -103,7 +120,66 @@ ROW& TextBuffer::GetRowByOffset(const size_t index)
 
     // Rows are stored circularly, so the index you ask for is offset by the start position and mod the total of rows.
     const size_t offsetIndex = (_firstRow + index) % totalRows;
-    return _storage.at(offsetIndex);
+    auto& row = _storage.at(offsetIndex);
+
+    // The caller may modify the row, so snapshots can't share their copy of it anymore.
+    _TouchRow(row);
+    return row;
+}
+
+// Routine Description:
+// - Gives the row a new revision, so that future snapshots capture it anew.
+void TextBuffer::_TouchRow(ROW& row) noexcept
+{
+    row.SetRevision(++_lastRevision);
+}
+
+// Routine Description:
+// - Gives every row a new revision. Used by operations that rewrite the whole buffer.
+void TextBuffer::_TouchAllRows() noexcept
+{
+    for (auto& row : _storage)
+    {
+        _TouchRow(row);
+    }
+}
+
+// Routine Description:
+// - Takes an immutable copy of the given range of rows. Readers can take the snapshot
+//   while holding the buffer lock and drop the lock before walking it.
+// - Rows that haven't been handed out for writing since the previous snapshot are
+//   shared with it instead of copied again.
+// Arguments:
+// - firstRow - the first row to copy, as an offset from the top of the buffer
+// - lastRow - the last row to copy (inclusive)
+// - previous - an earlier snapshot of this buffer to share rows with, if any
+// Return Value:
+// - the snapshot
+std::shared_ptr<const TextBufferSnapshot> TextBuffer::TakeSnapshot(const size_t firstRow,
+                                                                   const size_t lastRow,
+                                                                   const TextBufferSnapshot* const previous) const
+{
+    auto snapshot = std::make_shared<TextBufferSnapshot>(_snapshotId, firstRow, gsl::narrow_cast<size_t>(GetSize().Width()));
+
+    for (auto i = firstRow; i <= lastRow; ++i)
+    {
+        const auto& row = GetRowByOffset(i);
+
+        std::shared_ptr<const TextBufferSnapshot::Row> captured;
+        if (previous)
+        {
+            captured = previous->FindRow(_snapshotId, row.GetRevision());
+        }
+
+        const auto shared = captured != nullptr;
+        if (!shared)
+        {
+            captured = std::make_shared<const TextBufferSnapshot::Row>(row);
+        }
+        snapshot->AppendRow(std::move(captured), shared);
+    }
+
+    return snapshot;
 }
 
 // Routine Description:
@@ -379,6 +455,9 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
         return givenIt;
     }
 
+    _CompactAttributeTable();
+    _CompactUnicodeStorage();
+
     //  Get the row and write the cells
     ROW& row = GetRowByOffset(target.Y);
     const auto newIt = row.WriteCells(givenIt, target.X, wrap, limitRight);
@@ -391,6 +470,81 @@ OutputCellIterator TextBuffer::WriteLine(const OutputCellIterator givenIt,
     return newIt;
 }
 
+// Routine Description:
+// - Fills a rectangular region of the buffer with a single narrow character and attribute.
+// - Each row is filled in bulk rather than cell by cell. Full-width regions leave a
+//   single attribute run behind in every row.
+// Arguments:
+// - region - the area to fill. Will be clipped to the buffer.
+// - wch - the character to fill with. Must not be a wide glyph.
+// - attr - the attribute to fill with
+// Return Value:
+// - <none>
+void TextBuffer::FillRect(const Viewport& region, const wchar_t wch, const TextAttribute& attr)
+{
+    const auto clipped = Viewport::Intersect(GetSize(), region);
+    if (!clipped.IsValid())
+    {
+        return;
+    }
+
+    _CompactAttributeTable();
+    _CompactUnicodeStorage();
+
+    for (auto y = clipped.Top(); y < clipped.BottomExclusive(); ++y)
+    {
+        GetRowByOffset(y).FillCells(clipped.Left(), clipped.RightExclusive(), wch, attr);
+    }
+
+    _NotifyPaint(clipped);
+}
+
+// Routine Description:
+// - Fills a stream of cells with a single narrow character and attribute, wrapping
+//   from the end of each row to the start of the next one like Write does.
+// - This is split into at most three rectangles: the remainder of the first row,
+//   the rows that are covered entirely, and the start of the last row.
+// Arguments:
+// - start - the position of the first cell to fill
+// - length - the number of cells to fill. Will stop at the end of the buffer.
+// - wch - the character to fill with. Must not be a wide glyph.
+// - attr - the attribute to fill with
+// Return Value:
+// - <none>
+void TextBuffer::Fill(const COORD start, const size_t length, const wchar_t wch, const TextAttribute& attr)
+{
+    const auto size = GetSize();
+    if (length == 0 || !size.IsInBounds(start))
+    {
+        return;
+    }
+
+    const auto width = gsl::narrow_cast<size_t>(size.Width());
+    auto remaining = length;
+    auto y = start.Y;
+
+    // The remainder of the first row.
+    const auto firstLength = std::min(remaining, width - start.X);
+    FillRect(Viewport::FromDimensions(start, gsl::narrow_cast<SHORT>(firstLength), 1), wch, attr);
+    remaining -= firstLength;
+    ++y;
+
+    // All full rows in between.
+    const auto fullRows = std::min(remaining / width, gsl::narrow_cast<size_t>(size.BottomExclusive() - y));
+    if (fullRows > 0)
+    {
+        FillRect(Viewport::FromDimensions({ 0, y }, size.Width(), gsl::narrow_cast<SHORT>(fullRows)), wch, attr);
+        remaining -= fullRows * width;
+        y += gsl::narrow_cast<SHORT>(fullRows);
+    }
+
+    // The start of the last row.
+    if (remaining > 0 && y < size.BottomExclusive())
+    {
+        FillRect(Viewport::FromDimensions({ 0, y }, gsl::narrow_cast<SHORT>(remaining), 1), wch, attr);
+    }
+}
+
 //Routine Description:
 // - Inserts one codepoint into the buffer at the current cursor position and advances the cursor as appropriate.
 //Arguments:
@@ -404,6 +558,9 @@ bool TextBuffer::InsertCharacter(const std::wstring_view chars,
                                  const DbcsAttribute dbcsAttribute,
                                  const TextAttribute attr)
 {
+    _CompactAttributeTable();
+    _CompactUnicodeStorage();
+
     // Ensure consistent buffer state for double byte characters based on the character type we're about to insert
     bool fSuccess = _PrepareForDoubleByteSequence(dbcsAttribute);
 
@@ -558,9 +715,6 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
     // to the logical position 0 in the window (cursor coordinates and all other coordinates).
     _renderTarget.TriggerCircling();
 
-    // Prune hyperlinks to delete obsolete references
-    _PruneHyperlinks();
-
     // Second, clean out the old "first row" as it will become the "last row" of the buffer after the circle is performed.
     auto fillAttributes = _currentAttributes;
     if (inVtMode)
@@ -569,6 +723,7 @@ bool TextBuffer::IncrementCircularBuffer(const bool inVtMode)
         // the current background color, but with no meta attributes set.
         fillAttributes.SetStandardErase();
     }
+    _TouchRow(_storage.at(_firstRow));
     const bool fSuccess = _storage.at(_firstRow).Reset(fillAttributes);
     if (fSuccess)
     {
@@ -778,7 +933,7 @@ void TextBuffer::ScrollRows(const SHORT firstRow, const SHORT size, const SHORT
     }
 
     // Renumber the IDs now that we've rearranged where the rows sit within the buffer.
-    // Refreshing should also delegate to the UnicodeStorage to re-key all the stored unicode sequences (where applicable).
+    // Stored glyphs are referenced by handle rather than position, so they don't need to be touched.
     _RefreshRowIDs(std::nullopt);
 }
 
@@ -799,6 +954,8 @@ const Cursor& TextBuffer::GetCursor() const noexcept
 
 void TextBuffer::SetCurrentAttributes(const TextAttribute& currentAttributes) noexcept
 {
+    // The hyperlink we write with has to stay known even while no row uses it.
+    _hyperlinks.SetCurrentId(currentAttributes.GetHyperlinkId());
     _currentAttributes = currentAttributes;
 }
 
@@ -885,6 +1042,7 @@ void TextBuffer::Reset()
     {
         row.Reset(attr);
     }
+    _TouchAllRows();
 }
 
 // Routine Description:
@@ -931,9 +1089,13 @@ void TextBuffer::Reset()
         }
 
         // Now that we've tampered with the row placement, refresh all the row IDs.
-        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension
-        // and cleanup the UnicodeStorage characters that might fall outside the resized buffer.
+        // Also take advantage of the row ID refresh loop to resize the rows in the X dimension.
         _RefreshRowIDs(newSize.X);
+        _TouchAllRows();
+
+        // We're already touching every row, so this is a good time to
+        // drop the glyphs that were in the rows and columns we just cut off.
+        _CollectGlyphs();
 
         // Update the cached size value
         _UpdateSize();
@@ -953,24 +1115,83 @@ UnicodeStorage& TextBuffer::GetUnicodeStorage() noexcept
     return _unicodeStorage;
 }
 
+const TextAttributeTable& TextBuffer::GetAttributeTable() const noexcept
+{
+    return _attributeTable;
+}
+
+TextAttributeTable& TextBuffer::GetAttributeTable() noexcept
+{
+    return _attributeTable;
+}
+
+const HyperlinkTable& TextBuffer::GetHyperlinkTable() const noexcept
+{
+    return _hyperlinks;
+}
+
+// Routine Description:
+// - Drops attributes from the attribute table that no row refers to anymore.
+// - This is a no-op unless the table is approaching the limit of its ID space,
+//   which only happens after tens of thousands of distinct (e.g. 24-bit) colors.
+void TextBuffer::_CompactAttributeTable()
+{
+    if (!_attributeTable.ShouldCompact())
+    {
+        return;
+    }
+
+    std::vector<bool> inUse(_attributeTable.size(), false);
+    for (const auto& row : _storage)
+    {
+        row.GetAttrRow().CollectAttributeIds(inUse);
+    }
+
+    const auto newIds = _attributeTable.Compact(inUse);
+    for (auto& row : _storage)
+    {
+        row.GetAttrRow().RemapAttributeIds(newIds);
+    }
+}
+
+// Routine Description:
+// - Drops glyphs from the UnicodeStorage that no cell refers to anymore.
+// - This is a no-op until the storage is approaching the limit of its handle space.
+//   Scrolling and overwriting cells merely leave their glyphs behind until then.
+void TextBuffer::_CompactUnicodeStorage()
+{
+    if (_unicodeStorage.ShouldCompact())
+    {
+        _CollectGlyphs();
+    }
+}
+
+// Routine Description:
+// - Drops all glyphs from the UnicodeStorage that no cell refers to anymore.
+void TextBuffer::_CollectGlyphs()
+{
+    std::vector<bool> inUse(size_t{ std::numeric_limits<UnicodeStorage::key_type>::max() } + 1, false);
+    for (const auto& row : _storage)
+    {
+        row.GetCharRow().CollectGlyphs(inUse);
+    }
+    _unicodeStorage.Compact(inUse);
+}
+
 // Routine Description:
 // - Method to help refresh all the Row IDs after manipulating the row
 //   by shuffling pointers around.
 // - This will also update parent pointers that are stored in depth within the buffer
 //   (e.g. it will update CharRow parents pointing at Rows that might have been moved around)
-// - Optionally takes a new row width if we're resizing to perform a resize operation and cleanup
-//   any high unicode (UnicodeStorage) runs while we're already looping through the rows.
+// - Optionally takes a new row width if we're resizing to perform a resize operation
+//   while we're already looping through the rows.
 // Arguments:
 // - newRowWidth - Optional new value for the row width.
 void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
 {
-    std::unordered_map<SHORT, SHORT> rowMap;
     SHORT i = 0;
     for (auto& it : _storage)
     {
-        // Build a map so we can update Unicode Storage
-        rowMap.emplace(it.GetId(), i);
-
         // Update the IDs
         it.SetId(i++);
 
@@ -984,9 +1205,6 @@ void TextBuffer::_RefreshRowIDs(std::optional<SHORT> newRowWidth)
             THROW_IF_FAILED(it.Resize(newRowWidth.value()));
         }
     }
-
-    // Give the new mapping to Unicode Storage
-    _unicodeStorage.Remap(rowMap, newRowWidth);
 }
 
 void TextBuffer::_NotifyPaint(const Viewport& viewport) const
@@ -1023,7 +1241,9 @@ ROW& TextBuffer::_GetPrevRowNoWrap(const ROW& Row)
     }
 
     THROW_HR_IF(E_FAIL, Row.GetId() == _firstRow);
-    return _storage.at(prevRowIndex);
+    auto& prevRow = _storage.at(prevRowIndex);
+    _TouchRow(prevRow);
+    return prevRow;
 }
 
 // Method Description:
@@ -1295,52 +1515,6 @@ const COORD TextBuffer::_GetWordEndForSelection(const COORD target, const std::w
     return result;
 }
 
-void TextBuffer::_PruneHyperlinks()
-{
-    // Check the old first row for hyperlink references
-    // If there are any, search the entire buffer for the same reference
-    // If the buffer does not contain the same reference, we can remove that hyperlink from our map
-    // This way, obsolete hyperlink references are cleared from our hyperlink map instead of hanging around
-    // Get all the hyperlink references in the row we're erasing
-    const auto hyperlinks = _storage.at(_firstRow).GetAttrRow().GetHyperlinks();
-
-    if (!hyperlinks.empty())
-    {
-        // Move to unordered set so we can use hashed lookup of IDs instead of linear search.
-        // Only make it an unordered set now because set always heap allocates but vector
-        // doesn't when the set is empty (saving an allocation in the common case of no links.)
-        std::unordered_set<uint16_t> firstRowRefs{ hyperlinks.cbegin(), hyperlinks.cend() };
-
-        const auto total = TotalRowCount();
-        // Loop through all the rows in the buffer except the first row -
-        // we have found all hyperlink references in the first row and put them in refs,
-        // now we need to search the rest of the buffer (i.e. all the rows except the first)
-        // to see if those references are anywhere else
-        for (size_t i = 1; i != total; ++i)
-        {
-            const auto nextRowRefs = GetRowByOffset(i).GetAttrRow().GetHyperlinks();
-            for (auto id : nextRowRefs)
-            {
-                if (firstRowRefs.find(id) != firstRowRefs.end())
-                {
-                    firstRowRefs.erase(id);
-                }
-            }
-            if (firstRowRefs.empty())
-            {
-                // No more hyperlink references left to search for, terminate early
-                break;
-            }
-        }
-
-        // Now delete obsolete references from our map
-        for (auto hyperlinkReference : firstRowRefs)
-        {
-            RemoveHyperlinkFromMap(hyperlinkReference);
-        }
-    }
-}
-
 // Method Description:
 // - Update pos to be the position of the first character of the next word. This is used for accessibility
 // Arguments:
@@ -1501,8 +1675,30 @@ bool TextBuffer::MoveToPreviousGlyph(til::point& pos) const
 // - bufferCoordinates: when enabled, treat the coordinates as relative to
 //                      the buffer rather than the screen.
 // Return Value:
-// - the delimiter class for the given char
+// - one rectangle per row of the text region
 const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates) const
+{
+    const auto bufferSize = GetSize();
+    return GetTextRects(start, end, blockSelection, bufferCoordinates, bufferSize.Top(), bufferSize.BottomInclusive());
+}
+
+// Method Description:
+// - Same as above, but only computes the rectangles of the rows in
+//   [firstRow, lastRow]. This lets callers like the renderer ask for the
+//   visible part of a region without paying for all of its rows.
+// Arguments:
+// - start: a corner of the text region of interest (inclusive)
+// - end: the other corner of the text region of interest (inclusive)
+// - blockSelection: when enabled, only get the rectangular text region,
+//                   as opposed to the text extending to the left/right
+//                   buffer margins
+// - bufferCoordinates: when enabled, treat the coordinates as relative to
+//                      the buffer rather than the screen.
+// - firstRow: the first row to compute a rectangle for (inclusive)
+// - lastRow: the last row to compute a rectangle for (inclusive)
+// Return Value:
+// - one rectangle per row of the text region within [firstRow, lastRow]
+const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates, SHORT firstRow, SHORT lastRow) const
 {
     std::vector<SMALL_RECT> textRects;
 
@@ -1515,9 +1711,16 @@ const std::vector<SMALL_RECT> TextBuffer::GetTextRects(COORD start, COORD end, b
                                                std::make_tuple(start, end) :
                                                std::make_tuple(end, start);
 
-    const auto textRectSize = base::ClampedNumeric<short>(1) + lowerCoord.Y - higherCoord.Y;
+    const auto topRow = std::max(higherCoord.Y, firstRow);
+    const auto bottomRow = std::min(lowerCoord.Y, lastRow);
+    if (topRow > bottomRow)
+    {
+        return textRects;
+    }
+
+    const auto textRectSize = base::ClampedNumeric<short>(1) + bottomRow - topRow;
     textRects.reserve(textRectSize);
-    for (auto row = higherCoord.Y; row <= lowerCoord.Y; row++)
+    for (auto row = topRow; row <= bottomRow; row++)
     {
         SMALL_RECT textRow;
 
@@ -2363,7 +2566,7 @@ HRESULT TextBuffer::Reflow(TextBuffer& oldBuffer,
 // - The hyperlink URI, the hyperlink id (could be new or old)
 void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
 {
-    _hyperlinkMap[id] = uri;
+    _hyperlinks.Add(uri, id);
 }
 
 // Method Description:
@@ -2374,7 +2577,7 @@ void TextBuffer::AddHyperlinkToMap(std::wstring_view uri, uint16_t id)
 // - The URI
 std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
 {
-    return _hyperlinkMap.at(id);
+    return _hyperlinks.GetUri(id);
 }
 
 // Method description:
@@ -2385,33 +2588,7 @@ std::wstring TextBuffer::GetHyperlinkUriFromId(uint16_t id) const
 // - The internal hyperlink ID
 uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 {
-    uint16_t numericId = 0;
-    if (id.empty())
-    {
-        // no custom id specified, return our internal count
-        numericId = _currentHyperlinkId;
-        ++_currentHyperlinkId;
-    }
-    else
-    {
-        // assign _currentHyperlinkId if the custom id does not already exist
-        std::wstring newId{ id };
-        // hash the URL and add it to the custom ID - GH#7698
-        newId += L"%" + std::to_wstring(std::hash<std::wstring_view>{}(uri));
-        const auto result = _hyperlinkCustomIdMap.emplace(newId, _currentHyperlinkId);
-        if (result.second)
-        {
-            // the custom id did not already exist
-            ++_currentHyperlinkId;
-        }
-        numericId = (*(result.first)).second;
-    }
-    // _currentHyperlinkId could overflow, make sure its not 0
-    if (_currentHyperlinkId == 0)
-    {
-        ++_currentHyperlinkId;
-    }
-    return numericId;
+    return _hyperlinks.GetId(uri, id);
 }
 
 // Method Description:
@@ -2421,15 +2598,7 @@ uint16_t TextBuffer::GetHyperlinkId(std::wstring_view uri, std::wstring_view id)
 // - The ID of the hyperlink to be removed
 void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 {
-    _hyperlinkMap.erase(id);
-    for (const auto& customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            _hyperlinkCustomIdMap.erase(customIdPair.first);
-            break;
-        }
-    }
+    _hyperlinks.Remove(id);
 }
 
 // Method Description:
@@ -2441,14 +2610,7 @@ void TextBuffer::RemoveHyperlinkFromMap(uint16_t id) noexcept
 // - The custom ID if there was one, empty string otherwise
 std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 {
-    for (auto customIdPair : _hyperlinkCustomIdMap)
-    {
-        if (customIdPair.second == id)
-        {
-            return customIdPair.first;
-        }
-    }
-    return {};
+    return _hyperlinks.GetCustomId(id);
 }
 
 // Method Description:
@@ -2458,9 +2620,7 @@ std::wstring TextBuffer::GetCustomIdFromId(uint16_t id) const
 // - The other buffer
 void TextBuffer::CopyHyperlinkMaps(const TextBuffer& other)
 {
-    _hyperlinkMap = other._hyperlinkMap;
-    _hyperlinkCustomIdMap = other._hyperlinkCustomIdMap;
-    _currentHyperlinkId = other._currentHyperlinkId;
+    _hyperlinks.CopyFrom(other._hyperlinks);
 }
 
 // Method Description:
@@ -2496,62 +2656,450 @@ void TextBuffer::CopyPatterns(const TextBuffer& OtherBuffer)
 // - An interval tree containing the patterns found
 PointTree TextBuffer::GetPatterns(const size_t firstRow, const size_t lastRow) const
 {
-    PointTree::interval_vector intervals;
+    return TakeSnapshot(firstRow, lastRow)->FindPatterns(_idsAndPatterns);
+}
 
-    std::wstring concatAll;
-    const auto rowSize = GetRowByOffset(0).size();
-    concatAll.reserve(rowSize * (lastRow - firstRow + 1));
+// Method Description:
+// - Returns the regular expressions that GetPatterns looks for, keyed by their ID.
+//   Used along with TakeSnapshot to find patterns without holding the buffer lock.
+const std::unordered_map<size_t, std::wstring>& TextBuffer::GetPatternRecognizers() const noexcept
+{
+    return _idsAndPatterns;
+}
+
+// The format written by TextBuffer::Serialize. The sections below follow each
+// other in this order, each starting at an 8 byte boundary, so that a snapshot
+// can be used in place, straight from a memory mapped file:
+//   SerializedHeader
+//   TextAttribute[attributeCount]        - the attribute table, followed by the current attributes
+//   SerializedRow[height]                - in logical order, top row first
+//   TextAttributeIdRun[runCount]         - the attribute runs of all rows
+//   CharRowCell[cellRowCount * width]    - the cells of the rows that were ever written to
+//   SerializedString[glyphCount]         - UnicodeStorage glyphs, keyed by row and column
+//   SerializedString[hyperlinkCount]     - hyperlink URIs, keyed by hyperlink ID
+//   SerializedString[customIdCount]      - custom hyperlink IDs, keyed by hyperlink ID
+//   wchar_t[poolLength]                  - the text of all strings above
+// Cells, attributes and runs are stored in the layout of the writing process.
+// The header records their sizes and Deserialize rejects snapshots that don't match.
+namespace
+{
+    constexpr uint32_t SerializedMagic = 0x53425443; // "CTBS"
+    constexpr uint32_t SerializedVersion = 1;
+    constexpr uint32_t SerializedNoCells = UINT32_MAX;
+
+    static_assert(std::is_trivially_copyable_v<TextAttribute>);
+    static_assert(std::is_trivially_copyable_v<TextAttributeIdRun>);
+    static_assert(std::is_trivially_copyable_v<CharRowCell>);
+
+    struct SerializedHeader
+    {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t cellSize;
+        uint32_t attributeSize;
+        uint32_t runSize;
+        uint32_t width;
+        uint32_t height;
+        int32_t cursorX;
+        int32_t cursorY;
+        uint32_t currentHyperlinkId;
+        uint32_t attributeCount;
+        uint32_t runCount;
+        uint32_t cellRowCount;
+        uint32_t glyphCount;
+        uint32_t hyperlinkCount;
+        uint32_t customIdCount;
+        uint64_t poolLength;
+    };
+
+    struct SerializedRow
+    {
+        uint32_t firstRun;
+        uint32_t runCount;
+        uint32_t cellRow; // SerializedNoCells if the row was never written to
+        uint8_t lineRendition;
+        uint8_t wrapForced;
+        uint8_t doubleBytePadded;
+        uint8_t reserved;
+    };
+
+    struct SerializedString
+    {
+        uint32_t row; // glyphs only
+        uint32_t key; // the column for glyphs, the hyperlink ID otherwise
+        uint64_t offset; // into the pool, in characters
+        uint64_t length;
+    };
+
+    struct SerializedLayout
+    {
+        size_t attributes;
+        size_t rows;
+        size_t runs;
+        size_t cells;
+        size_t glyphs;
+        size_t hyperlinks;
+        size_t customIds;
+        size_t pool;
+        size_t total;
+    };
+
+    constexpr size_t AlignSection(const size_t offset) noexcept
+    {
+        return (offset + 7) & ~size_t{ 7 };
+    }
+
+    // Computes the byte offset of every section. The counts in the header
+    // must have been validated, so that none of this can overflow.
+    SerializedLayout ComputeLayout(const SerializedHeader& header) noexcept
+    {
+        SerializedLayout layout{};
+        size_t offset = AlignSection(sizeof(SerializedHeader));
+        const auto section = [&](size_t& start, const size_t count, const size_t size) noexcept {
+            start = offset;
+            offset = AlignSection(offset + count * size);
+        };
+
+        section(layout.attributes, header.attributeCount, sizeof(TextAttribute));
+        section(layout.rows, header.height, sizeof(SerializedRow));
+        section(layout.runs, header.runCount, sizeof(TextAttributeIdRun));
+        section(layout.cells, size_t{ header.cellRowCount } * header.width, sizeof(CharRowCell));
+        section(layout.glyphs, header.glyphCount, sizeof(SerializedString));
+        section(layout.hyperlinks, header.hyperlinkCount, sizeof(SerializedString));
+        section(layout.customIds, header.customIdCount, sizeof(SerializedString));
+        section(layout.pool, gsl::narrow_cast<size_t>(header.poolLength), sizeof(wchar_t));
+        layout.total = offset;
+        return layout;
+    }
+
+    template<typename T>
+    gsl::span<T> WriteSection(std::vector<std::byte>& data, const size_t offset, const size_t count)
+    {
+        const auto bytes = gsl::make_span(data).subspan(offset, count * sizeof(T));
+        return { reinterpret_cast<T*>(bytes.data()), count };
+    }
+
+    template<typename T>
+    gsl::span<const T> ReadSection(const gsl::span<const std::byte> data, const size_t offset, const size_t count)
+    {
+        const auto bytes = data.subspan(offset, count * sizeof(T));
+        // The sections are aligned relative to the start of the snapshot,
+        // which in turn has to be aligned like any heap allocation or mapped view.
+        THROW_HR_IF(E_INVALIDARG, reinterpret_cast<uintptr_t>(bytes.data()) % alignof(T) != 0);
+        return { reinterpret_cast<const T*>(bytes.data()), count };
+    }
+}
 
-    // to deal with text that spans multiple lines, we will first concatenate
-    // all the text into one string and find the patterns in that string
-    for (auto i = firstRow; i <= lastRow; ++i)
+// Routine Description:
+// - Writes the contents of the buffer into a versioned binary snapshot that
+//   Deserialize can restore. This includes the rows with their wrap flags, line
+//   renditions and attribute runs, the glyphs in the UnicodeStorage, the hyperlink
+//   maps, the cursor position and the current attributes.
+// - The snapshot is written in a single pass with a single allocation. Rows that
+//   were never written to only take up their row record and attribute runs.
+// Return Value:
+// - The snapshot. See the comment above SerializedHeader for its layout.
+std::vector<std::byte> TextBuffer::Serialize() const
+{
+    const auto width = gsl::narrow<size_t>(_size.Width());
+    const auto height = gsl::narrow<size_t>(_size.Height());
+
+    SerializedHeader header{};
+    header.magic = SerializedMagic;
+    header.version = SerializedVersion;
+    header.cellSize = sizeof(CharRowCell);
+    header.attributeSize = sizeof(TextAttribute);
+    header.runSize = sizeof(TextAttributeIdRun);
+    header.width = gsl::narrow_cast<uint32_t>(width);
+    header.height = gsl::narrow_cast<uint32_t>(height);
+    header.cursorX = _cursor.GetPosition().X;
+    header.cursorY = _cursor.GetPosition().Y;
+    header.currentHyperlinkId = _hyperlinks.GetNextId();
+    header.attributeCount = gsl::narrow<uint32_t>(_attributeTable.size() + 1);
+    header.hyperlinkCount = gsl::narrow<uint32_t>(_hyperlinks.GetUris().size());
+    header.customIdCount = gsl::narrow<uint32_t>(_hyperlinks.GetCustomIds().size());
+
+    size_t runCount = 0;
+    size_t cellRowCount = 0;
+    size_t glyphCount = 0;
+    size_t poolLength = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        const auto& row = GetRowByOffset(y);
+        const auto& charRow = row.GetCharRow();
+        runCount += row.GetAttrRow().GetIdRuns().size();
+        if (charRow.IsMaterialized())
+        {
+            ++cellRowCount;
+            for (size_t x = 0; x < width; ++x)
+            {
+                if (charRow.DbcsAttrAt(x).IsGlyphStored())
+                {
+                    ++glyphCount;
+                    poolLength += std::wstring_view{ charRow.GlyphAt(x) }.size();
+                }
+            }
+        }
+    }
+    header.runCount = gsl::narrow<uint32_t>(runCount);
+    header.cellRowCount = gsl::narrow<uint32_t>(cellRowCount);
+    header.glyphCount = gsl::narrow<uint32_t>(glyphCount);
+
+    for (const auto& [id, uri] : _hyperlinks.GetUris())
     {
-        auto& row = GetRowByOffset(i);
-        concatAll += row.GetText();
+        poolLength += uri.size();
     }
+    for (const auto& [customId, id] : _hyperlinks.GetCustomIds())
+    {
+        poolLength += customId.size();
+    }
+    header.poolLength = poolLength;
 
-    // for each pattern we know of, iterate through the string
-    for (const auto& idAndPattern : _idsAndPatterns)
+    const auto layout = ComputeLayout(header);
+    std::vector<std::byte> data(layout.total);
+    memcpy(data.data(), &header, sizeof(header));
+
+    const auto attributes = WriteSection<TextAttribute>(data, layout.attributes, header.attributeCount);
+    for (size_t id = 0; id < _attributeTable.size(); ++id)
     {
-        std::wregex regexObj{ idAndPattern.second };
+        til::at(attributes, id) = _attributeTable.At(gsl::narrow_cast<TextAttributeTable::id_type>(id));
+    }
+    til::at(attributes, _attributeTable.size()) = _currentAttributes;
 
-        // search through the run with our regex object
-        auto words_begin = std::wsregex_iterator(concatAll.begin(), concatAll.end(), regexObj);
-        auto words_end = std::wsregex_iterator();
+    const auto rows = WriteSection<SerializedRow>(data, layout.rows, height);
+    const auto runs = WriteSection<TextAttributeIdRun>(data, layout.runs, runCount);
+    const auto cells = WriteSection<CharRowCell>(data, layout.cells, cellRowCount * width);
+    size_t nextRun = 0;
+    size_t nextCellRow = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        const auto& row = GetRowByOffset(y);
+        const auto& charRow = row.GetCharRow();
+        const auto rowRuns = row.GetAttrRow().GetIdRuns();
+        auto& record = til::at(rows, y);
+
+        record.firstRun = gsl::narrow_cast<uint32_t>(nextRun);
+        record.runCount = gsl::narrow_cast<uint32_t>(rowRuns.size());
+        std::copy(rowRuns.begin(), rowRuns.end(), runs.subspan(nextRun, rowRuns.size()).begin());
+        nextRun += rowRuns.size();
 
-        size_t lenUpToThis = 0;
-        for (auto i = words_begin; i != words_end; ++i)
+        if (charRow.IsMaterialized())
+        {
+            record.cellRow = gsl::narrow_cast<uint32_t>(nextCellRow);
+            std::copy(charRow.cbegin(), charRow.cend(), cells.subspan(nextCellRow * width, width).begin());
+            ++nextCellRow;
+        }
+        else
         {
-            // record the locations -
-            // when we find a match, the prefix is text that is between this
-            // match and the previous match, so we use the size of the prefix
-            // along with the size of the match to determine the locations
-            size_t prefixSize = 0;
+            record.cellRow = SerializedNoCells;
+        }
+
+        record.lineRendition = gsl::narrow_cast<uint8_t>(row.GetLineRendition());
+        record.wrapForced = row.WasWrapForced();
+        record.doubleBytePadded = row.WasDoubleBytePadded();
+    }
+
+    const auto pool = WriteSection<wchar_t>(data, layout.pool, poolLength);
+    size_t nextChar = 0;
+    const auto writeString = [&](SerializedString& record, const auto& text) {
+        record.offset = nextChar;
+        record.length = text.size();
+        std::copy(text.begin(), text.end(), pool.subspan(nextChar, text.size()).begin());
+        nextChar += text.size();
+    };
 
-            for (const auto ch : i->prefix().str())
+    // The cells only hold handles into our UnicodeStorage, so the glyphs are written out by position.
+    const auto glyphs = WriteSection<SerializedString>(data, layout.glyphs, header.glyphCount);
+    size_t i = 0;
+    for (size_t y = 0; y < height; ++y)
+    {
+        const auto& charRow = GetRowByOffset(y).GetCharRow();
+        if (!charRow.IsMaterialized())
+        {
+            continue;
+        }
+        for (size_t x = 0; x < width; ++x)
+        {
+            if (charRow.DbcsAttrAt(x).IsGlyphStored())
             {
-                prefixSize += IsGlyphFullWidth(ch) ? 2 : 1;
+                auto& record = til::at(glyphs, i++);
+                record.row = gsl::narrow_cast<uint32_t>(y);
+                record.key = gsl::narrow_cast<uint32_t>(x);
+                writeString(record, std::wstring_view{ charRow.GlyphAt(x) });
             }
-            const auto start = lenUpToThis + prefixSize;
-            size_t matchSize = 0;
-            for (const auto ch : i->str())
+        }
+    }
+
+    const auto hyperlinks = WriteSection<SerializedString>(data, layout.hyperlinks, header.hyperlinkCount);
+    i = 0;
+    for (const auto& [id, uri] : _hyperlinks.GetUris())
+    {
+        auto& record = til::at(hyperlinks, i++);
+        record.key = id;
+        writeString(record, uri);
+    }
+
+    const auto customIds = WriteSection<SerializedString>(data, layout.customIds, header.customIdCount);
+    i = 0;
+    for (const auto& [customId, id] : _hyperlinks.GetCustomIds())
+    {
+        auto& record = til::at(customIds, i++);
+        record.key = id;
+        writeString(record, customId);
+    }
+
+    return data;
+}
+
+// Routine Description:
+// - Replaces the contents of the buffer with a snapshot written by Serialize.
+//   The buffer is resized to the dimensions of the snapshot if necessary.
+// - The snapshot is validated in full before the buffer is modified, so that an
+//   invalid one leaves the buffer untouched.
+// Arguments:
+// - data - the snapshot. It is only read from and may point into a memory mapped file.
+// Note:
+// - will throw E_INVALIDARG if the snapshot is malformed or was written with
+//   a different version or memory layout.
+void TextBuffer::Deserialize(const gsl::span<const std::byte> data)
+{
+    THROW_HR_IF(E_INVALIDARG, data.size() < sizeof(SerializedHeader));
+
+    SerializedHeader header{};
+    memcpy(&header, data.data(), sizeof(header));
+
+    THROW_HR_IF(E_INVALIDARG, header.magic != SerializedMagic || header.version != SerializedVersion);
+    THROW_HR_IF(E_INVALIDARG, header.cellSize != sizeof(CharRowCell) || header.attributeSize != sizeof(TextAttribute) || header.runSize != sizeof(TextAttributeIdRun));
+
+    // These limits keep ComputeLayout from overflowing.
+    constexpr size_t maxIds = size_t{ std::numeric_limits<uint16_t>::max() } + 1;
+    THROW_HR_IF(E_INVALIDARG, header.width == 0 || header.width > SHRT_MAX || header.height == 0 || header.height > SHRT_MAX);
+    const size_t width = header.width;
+    const size_t height = header.height;
+    THROW_HR_IF(E_INVALIDARG, header.attributeCount < 2 || header.attributeCount > maxIds + 1);
+    THROW_HR_IF(E_INVALIDARG, header.runCount > width * height || header.cellRowCount > height || header.glyphCount > width * height);
+    THROW_HR_IF(E_INVALIDARG, header.hyperlinkCount > maxIds || header.customIdCount > maxIds || header.poolLength > data.size());
+
+    const auto layout = ComputeLayout(header);
+    THROW_HR_IF(E_INVALIDARG, layout.total > data.size());
+
+    const auto attributes = ReadSection<TextAttribute>(data, layout.attributes, header.attributeCount);
+    const auto rows = ReadSection<SerializedRow>(data, layout.rows, height);
+    const auto runs = ReadSection<TextAttributeIdRun>(data, layout.runs, header.runCount);
+    const auto cells = ReadSection<CharRowCell>(data, layout.cells, size_t{ header.cellRowCount } * width);
+    const auto glyphs = ReadSection<SerializedString>(data, layout.glyphs, header.glyphCount);
+    const auto hyperlinks = ReadSection<SerializedString>(data, layout.hyperlinks, header.hyperlinkCount);
+    const auto customIds = ReadSection<SerializedString>(data, layout.customIds, header.customIdCount);
+    const auto pool = ReadSection<wchar_t>(data, layout.pool, gsl::narrow_cast<size_t>(header.poolLength));
+
+    // The last attribute is the current one, the others form the attribute table.
+    const size_t tableSize = header.attributeCount - 1;
+
+    for (const auto& record : rows)
+    {
+        THROW_HR_IF(E_INVALIDARG, record.firstRun > header.runCount || record.runCount > header.runCount - record.firstRun);
+        THROW_HR_IF(E_INVALIDARG, record.cellRow != SerializedNoCells && record.cellRow >= header.cellRowCount);
+        THROW_HR_IF(E_INVALIDARG, record.lineRendition > static_cast<uint8_t>(LineRendition::DoubleHeightBottom));
+
+        size_t total = 0;
+        for (const auto& run : runs.subspan(record.firstRun, record.runCount))
+        {
+            THROW_HR_IF(E_INVALIDARG, run.GetLength() == 0 || run.GetAttributeId() >= tableSize);
+            total += run.GetLength();
+        }
+        THROW_HR_IF(E_INVALIDARG, total != width);
+    }
+
+    const auto validateString = [&](const SerializedString& record) {
+        THROW_HR_IF(E_INVALIDARG, record.offset > header.poolLength || record.length > header.poolLength - record.offset);
+    };
+    for (const auto& record : glyphs)
+    {
+        validateString(record);
+        THROW_HR_IF(E_INVALIDARG, record.row >= height || record.key >= width || record.length == 0);
+    }
+    for (const auto& record : hyperlinks)
+    {
+        validateString(record);
+        THROW_HR_IF(E_INVALIDARG, record.key >= maxIds);
+    }
+    for (const auto& record : customIds)
+    {
+        validateString(record);
+        THROW_HR_IF(E_INVALIDARG, record.key >= maxIds);
+    }
+
+    const auto getString = [&](const SerializedString& record) {
+        const auto text = pool.subspan(gsl::narrow_cast<size_t>(record.offset), gsl::narrow_cast<size_t>(record.length));
+        return std::wstring_view{ text.data(), text.size() };
+    };
+
+    // The snapshot is valid. Now replace our contents with it.
+    if (gsl::narrow_cast<size_t>(_size.Width()) != width || gsl::narrow_cast<size_t>(_size.Height()) != height)
+    {
+        THROW_IF_FAILED(ResizeTraditional({ gsl::narrow_cast<SHORT>(width), gsl::narrow_cast<SHORT>(height) }));
+    }
+
+    // Every row is about to be replaced, so none of our current attributes are needed anymore.
+    TextAttributeTable table{ &_hyperlinks };
+    std::vector<TextAttributeTable::id_type> newIds(tableSize);
+    for (size_t id = 0; id < tableSize; ++id)
+    {
+        til::at(newIds, id) = table.Intern(til::at(attributes, id));
+    }
+    _attributeTable = std::move(table);
+    SetCurrentAttributes(til::at(attributes, tableSize));
+    _unicodeStorage.clear();
+
+    for (size_t y = 0; y < height; ++y)
+    {
+        const auto& record = til::at(rows, y);
+        auto& row = GetRowByOffset(y);
+
+        row.Reset(TextAttribute{});
+        row.SetLineRendition(static_cast<LineRendition>(record.lineRendition));
+        row.SetWrapForced(record.wrapForced != 0);
+        row.SetDoubleBytePadded(record.doubleBytePadded != 0);
+
+        if (record.cellRow != SerializedNoCells)
+        {
+            const auto source = cells.subspan(record.cellRow * width, width);
+            std::copy(source.begin(), source.end(), row.GetCharRow().begin());
+
+            // The handles of stored glyphs are meaningless to us. They're restored from the glyph records below.
+            for (auto& cell : row.GetCharRow())
             {
-                matchSize += IsGlyphFullWidth(ch) ? 2 : 1;
+                if (cell.DbcsAttr().IsGlyphStored())
+                {
+                    cell.EraseChars();
+                }
             }
-            const auto end = start + matchSize;
-            lenUpToThis = end;
-
-            const til::point startCoord{ gsl::narrow<SHORT>(start % rowSize), gsl::narrow<SHORT>(start / rowSize) };
-            const til::point endCoord{ gsl::narrow<SHORT>(end % rowSize), gsl::narrow<SHORT>(end / rowSize) };
-
-            // store the intervals
-            // NOTE: these intervals are relative to the VIEWPORT not the buffer
-            // Keeping these relative to the viewport for now because its the renderer
-            // that actually uses these locations and the renderer works relative to
-            // the viewport
-            intervals.push_back(PointTree::interval(startCoord, endCoord, idAndPattern.first));
         }
+
+        row.GetAttrRow().SetIdRuns(runs.subspan(record.firstRun, record.runCount), newIds);
     }
-    PointTree result(std::move(intervals));
-    return result;
+
+    for (const auto& record : glyphs)
+    {
+        GetRowByOffset(record.row).GetCharRow().GlyphAt(record.key) = getString(record);
+    }
+
+    // Resetting the rows above may have released the last reference to some of
+    // our old hyperlinks, but their reference counts are accurate for the new rows.
+    _hyperlinks.Clear();
+    for (const auto& record : hyperlinks)
+    {
+        _hyperlinks.Add(getString(record), gsl::narrow_cast<uint16_t>(record.key));
+    }
+    for (const auto& record : customIds)
+    {
+        _hyperlinks.AddCustomId(getString(record), gsl::narrow_cast<uint16_t>(record.key));
+    }
+    _hyperlinks.SetNextId(gsl::narrow_cast<uint16_t>(header.currentHyperlinkId));
+
+    const auto cursorX = std::clamp<int32_t>(header.cursorX, 0, gsl::narrow_cast<int32_t>(width) - 1);
+    const auto cursorY = std::clamp<int32_t>(header.cursorY, 0, gsl::narrow_cast<int32_t>(height) - 1);
+    _cursor.SetPosition({ gsl::narrow_cast<SHORT>(cursorX), gsl::narrow_cast<SHORT>(cursorY) });
+
+    _NotifyPaint(GetSize());
 }
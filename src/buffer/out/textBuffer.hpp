@@ -52,8 +52,11 @@ filling in the last row, and updating the screen.
 #include <vector>
 
 #include "cursor.h"
+#include "HyperlinkTable.hpp"
 #include "Row.hpp"
 #include "TextAttribute.hpp"
+#include "TextAttributeTable.hpp"
+#include "TextBufferSnapshot.hpp"
 #include "UnicodeStorage.hpp"
 #include "../types/inc/Viewport.hpp"
 
@@ -97,6 +100,9 @@ public:
                                  const std::optional<bool> setWrap = std::nullopt,
                                  const std::optional<size_t> limitRight = std::nullopt);
 
+    void FillRect(const Microsoft::Console::Types::Viewport& region, const wchar_t wch, const TextAttribute& attr);
+    void Fill(const COORD start, const size_t length, const wchar_t wch, const TextAttribute& attr);
+
     bool InsertCharacter(const wchar_t wch, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool InsertCharacter(const std::wstring_view chars, const DbcsAttribute dbcsAttribute, const TextAttribute attr);
     bool IncrementCursor();
@@ -139,6 +145,10 @@ public:
     const UnicodeStorage& GetUnicodeStorage() const noexcept;
     UnicodeStorage& GetUnicodeStorage() noexcept;
 
+    const TextAttributeTable& GetAttributeTable() const noexcept;
+    TextAttributeTable& GetAttributeTable() noexcept;
+    const HyperlinkTable& GetHyperlinkTable() const noexcept;
+
     Microsoft::Console::Render::IRenderTarget& GetRenderTarget() noexcept;
 
     const COORD GetWordStart(const COORD target, const std::wstring_view wordDelimiters, bool accessibilityMode = false) const;
@@ -152,6 +162,7 @@ public:
     bool MoveToPreviousGlyph(til::point& pos) const;
 
     const std::vector<SMALL_RECT> GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates) const;
+    const std::vector<SMALL_RECT> GetTextRects(COORD start, COORD end, bool blockSelection, bool bufferCoordinates, SHORT firstRow, SHORT lastRow) const;
 
     void AddHyperlinkToMap(std::wstring_view uri, uint16_t id);
     std::wstring GetHyperlinkUriFromId(uint16_t id) const;
@@ -198,13 +209,34 @@ public:
     const size_t AddPatternRecognizer(const std::wstring_view regexString);
     void CopyPatterns(const TextBuffer& OtherBuffer);
     interval_tree::IntervalTree<til::point, size_t> GetPatterns(const size_t firstRow, const size_t lastRow) const;
+    const std::unordered_map<size_t, std::wstring>& GetPatternRecognizers() const noexcept;
+
+    std::shared_ptr<const TextBufferSnapshot> TakeSnapshot(const size_t firstRow,
+                                                           const size_t lastRow,
+                                                           const TextBufferSnapshot* const previous = nullptr) const;
+
+    std::vector<std::byte> Serialize() const;
+    void Deserialize(const gsl::span<const std::byte> data);
 
 private:
     void _UpdateSize();
     Microsoft::Console::Types::Viewport _size;
+
+    // The hyperlinks referenced by the rows in _storage. The rows hold a
+    // reference to each hyperlink they use, so this must outlive them too.
+    HyperlinkTable _hyperlinks;
+    // The interned attributes referenced by the rows in _storage.
+    // This must be declared (and thus constructed) before the rows.
+    TextAttributeTable _attributeTable;
     std::vector<ROW> _storage;
     Cursor _cursor;
 
+    // Identifies this buffer to snapshots, and the last revision handed out to one of its rows.
+    const uint64_t _snapshotId;
+    uint64_t _lastRevision;
+    void _TouchRow(ROW& row) noexcept;
+    void _TouchAllRows() noexcept;
+
     SHORT _firstRow; // indexes top row (not necessarily 0)
 
     TextAttribute _currentAttributes;
@@ -212,10 +244,6 @@ private:
     // storage location for glyphs that can't fit into the buffer normally
     UnicodeStorage _unicodeStorage;
 
-    std::unordered_map<uint16_t, std::wstring> _hyperlinkMap;
-    std::unordered_map<std::wstring, uint16_t> _hyperlinkCustomIdMap;
-    uint16_t _currentHyperlinkId;
-
     void _RefreshRowIDs(std::optional<SHORT> newRowWidth);
 
     Microsoft::Console::Render::IRenderTarget& _renderTarget;
@@ -244,7 +272,9 @@ private:
     const COORD _GetWordEndForAccessibility(const COORD target, const std::wstring_view wordDelimiters, const COORD lastCharPos) const;
     const COORD _GetWordEndForSelection(const COORD target, const std::wstring_view wordDelimiters) const;
 
-    void _PruneHyperlinks();
+    void _CompactAttributeTable();
+    void _CompactUnicodeStorage();
+    void _CollectGlyphs();
 
     std::unordered_map<size_t, std::wstring> _idsAndPatterns;
     size_t _currentPatternId;
@@ -58,6 +58,7 @@ namespace WEX
 
 class AttrRowTests
 {
+    TextAttributeTable _table;
     ATTR_ROW* pSingle;
     ATTR_ROW* pChain;
 
@@ -77,7 +78,7 @@ class AttrRowTests
 
     TEST_METHOD_SETUP(MethodSetup)
     {
-        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
+        pSingle = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
 
         // Segment length is the expected length divided by the row length
         // E.g. row of 80, 4 segments, 20 segment length each
@@ -97,31 +98,37 @@ class AttrRowTests
         }
 
         // Create the chain
-        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr);
-        pChain->_list.resize(sChainSegmentsNeeded);
+        pChain = new ATTR_ROW(_sDefaultLength, _DefaultAttr, _table);
+        std::vector<TextAttributeRun> chain;
 
         // Attach all chain segments that are even multiples of the row length
         for (short iChain = 0; iChain < _sDefaultChainLength; iChain++)
         {
-            TextAttributeRun* pRun = &pChain->_list[iChain];
-
-            pRun->SetAttributes(TextAttribute{ gsl::narrow_cast<WORD>(iChain) }); // Just use the chain position as the value
-            pRun->SetLength(sChainSegLength);
+            chain.emplace_back(sChainSegLength, TextAttribute{ gsl::narrow_cast<WORD>(iChain) }); // Just use the chain position as the value
         }
 
         if (sChainLeftover > 0)
         {
             // If we had a leftover, then this chain is one longer than we expected (the default length)
-            // So use it as the index (because indices start at 0)
-            TextAttributeRun* pRun = &pChain->_list[_sDefaultChainLength];
-
-            pRun->SetAttributes(_DefaultChainAttr);
-            pRun->SetLength(sChainLeftover);
+            chain.emplace_back(sChainLeftover, _DefaultChainAttr);
         }
 
+        SetRuns(*pChain, chain);
+
         return true;
     }
 
+    // Routine Description:
+    // - Replaces the runs stored in the given row without going through InsertAttrRuns.
+    void SetRuns(ATTR_ROW& row, const std::vector<TextAttributeRun>& runs)
+    {
+        row._list.clear();
+        for (const auto& run : runs)
+        {
+            row._list.emplace_back(run.GetLength(), row._table->Intern(run.GetAttributes()));
+        }
+    }
+
     TEST_METHOD_CLEANUP(MethodCleanup)
     {
         delete pSingle;
@@ -146,9 +153,10 @@ class AttrRowTests
 
             pUnderTest->Reset(attr);
 
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), attr);
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            const auto runs = pUnderTest->GetRuns();
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), attr);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
         }
     }
 
@@ -220,24 +228,6 @@ class AttrRowTests
         return NoThrowString().Format(L"%wc%d", run.GetAttributes().GetLegacyAttributes(), run.GetLength());
     }
 
-    void LogChain(_In_ PCWSTR pwszPrefix,
-                  boost::container::small_vector_base<TextAttributeRun>& chain)
-    {
-        NoThrowString str(pwszPrefix);
-
-        if (chain.size() > 0)
-        {
-            str.Append(LogRunElement(chain[0]));
-
-            for (size_t i = 1; i < chain.size(); i++)
-            {
-                str.AppendFormat(L"->%s", (const wchar_t*)(LogRunElement(chain[i])));
-            }
-        }
-
-        Log::Comment(str);
-    }
-
     void LogChain(_In_ PCWSTR pwszPrefix,
                   std::vector<TextAttributeRun>& chain)
     {
@@ -269,16 +259,10 @@ class AttrRowTests
 
         // Set up our "original row" that we are going to try to insert into.
         // This will represent a 10 column run of R3->B5->G2 that we will use for all tests.
-        ATTR_ROW originalRow{ static_cast<UINT>(_sDefaultLength), _DefaultAttr };
-        originalRow._list.resize(3);
-        originalRow._cchRowWidth = 10;
-        originalRow._list[0].SetAttributes(TextAttribute{ 'R' });
-        originalRow._list[0].SetLength(3);
-        originalRow._list[1].SetAttributes(TextAttribute{ 'B' });
-        originalRow._list[1].SetLength(5);
-        originalRow._list[2].SetAttributes(TextAttribute{ 'G' });
-        originalRow._list[2].SetLength(2);
-        LogChain(L"Original: ", originalRow._list);
+        ATTR_ROW originalRow{ 10, _DefaultAttr, _table };
+        SetRuns(originalRow, { { 3, TextAttribute{ 'R' } }, { 5, TextAttribute{ 'B' } }, { 2, TextAttribute{ 'G' } } });
+        auto originalRuns = originalRow.GetRuns();
+        LogChain(L"Original: ", originalRuns);
 
         // Set up our "insertion run"
         size_t cInsertRow = 1;
@@ -350,17 +334,18 @@ class AttrRowTests
         VERIFY_SUCCEEDED(originalRow.InsertAttrRuns({ insertRow.data(), insertRow.size() }, uiStartPos, uiEndPos, (UINT)originalRow._cchRowWidth));
 
         // Compare and ensure that the expected and actual match.
-        VERIFY_ARE_EQUAL(cPackedRun, originalRow._list.size(), L"Ensure that number of array elements required for RLE are the same.");
+        auto actualRuns = originalRow.GetRuns();
+        VERIFY_ARE_EQUAL(cPackedRun, actualRuns.size(), L"Ensure that number of array elements required for RLE are the same.");
 
         std::vector<TextAttributeRun> packedRunExpected;
         std::copy_n(packedRun.get(), cPackedRun, std::back_inserter(packedRunExpected));
 
         LogChain(L"Expected: ", packedRunExpected);
-        LogChain(L"Actual: ", originalRow._list);
+        LogChain(L"Actual: ", actualRuns);
 
         for (size_t testIndex = 0; testIndex < cPackedRun; testIndex++)
         {
-            VERIFY_ARE_EQUAL(packedRun[testIndex], originalRow._list[testIndex]);
+            VERIFY_ARE_EQUAL(packedRun[testIndex], actualRuns[testIndex]);
         }
     }
 
@@ -542,26 +527,15 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate through ubuntu prompt");
         {
             // Create attr row representing a buffer that's 121 wide.
-            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(121, _DefaultAttr, _table);
 
             // The repro case had 4 chain segments.
-            chain->_list.resize(4);
-
-            // The color 10 went for the first 18.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(18);
-
-            // Default color for the next 1
-            chain->_list[1].SetAttributes(TextAttribute());
-            chain->_list[1].SetLength(1);
-
-            // Color 12 for the next 29
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(29);
-
-            // Then default color to end the run
-            chain->_list[3].SetAttributes(TextAttribute());
-            chain->_list[3].SetLength(73);
+            SetRuns(*chain, {
+                                { 18, TextAttribute(0xA) }, // The color 10 went for the first 18.
+                                { 1, TextAttribute() }, // Default color for the next 1
+                                { 29, TextAttribute(0xC) }, // Color 12 for the next 29
+                                { 73, TextAttribute() }, // Then default color to end the run
+                            });
 
             // The sum of the lengths should be 121.
             VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength + chain->_list[3]._cchLength);
@@ -574,22 +548,14 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across a text run in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
-
-            // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
-
-            // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
-
-            // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            SetRuns(*chain, {
+                                { 1, TextAttribute(0xA) }, // The color 10 went for the first 1.
+                                { 1, TextAttribute(0xB) }, // The color 11 for the next 1
+                                { 1, TextAttribute(0xC) }, // Color 12 for the next 1
+                            });
 
             // The sum of the lengths should be 3.
             VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
@@ -603,22 +569,14 @@ class AttrRowTests
         Log::Comment(L"Reverse iterate across two text runs in the chain");
         {
             // Create attr row representing a buffer that's 3 wide.
-            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr);
+            auto chain = std::make_unique<ATTR_ROW>(3, _DefaultAttr, _table);
 
             // The repro case had 3 chain segments.
-            chain->_list.resize(3);
-
-            // The color 10 went for the first 1.
-            chain->_list[0].SetAttributes(TextAttribute(0xA));
-            chain->_list[0].SetLength(1);
-
-            // The color 11 for the next 1
-            chain->_list[1].SetAttributes(TextAttribute(0xB));
-            chain->_list[1].SetLength(1);
-
-            // Color 12 for the next 1
-            chain->_list[2].SetAttributes(TextAttribute(0xC));
-            chain->_list[2].SetLength(1);
+            SetRuns(*chain, {
+                                { 1, TextAttribute(0xA) }, // The color 10 went for the first 1.
+                                { 1, TextAttribute(0xB) }, // The color 11 for the next 1
+                                { 1, TextAttribute(0xC) }, // Color 12 for the next 1
+                            });
 
             // The sum of the lengths should be 3.
             VERIFY_ARE_EQUAL(chain->_cchRowWidth, chain->_list[0]._cchLength + chain->_list[1]._cchLength + chain->_list[2]._cchLength);
@@ -643,35 +601,37 @@ class AttrRowTests
         pSingle->SetAttrToEnd(iTestIndex, TestAttr);
 
         // Was 1 (single), should now have 2 segments
-        VERIFY_ARE_EQUAL(pSingle->_list.size(), 2u);
+        const auto singleRuns = pSingle->GetRuns();
+        VERIFY_ARE_EQUAL(singleRuns.size(), 2u);
 
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetAttributes(), _DefaultAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
+        VERIFY_ARE_EQUAL(singleRuns[0].GetAttributes(), _DefaultAttr);
+        VERIFY_ARE_EQUAL(singleRuns[0].GetLength(), (unsigned int)(_sDefaultLength - (_sDefaultLength - iTestIndex)));
 
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetAttributes(), TestAttr);
-        VERIFY_ARE_EQUAL(pSingle->_list[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
+        VERIFY_ARE_EQUAL(singleRuns[1].GetAttributes(), TestAttr);
+        VERIFY_ARE_EQUAL(singleRuns[1].GetLength(), (unsigned int)(_sDefaultLength - iTestIndex));
 
         Log::Comment(L"SetAttrToEnd for existing chain of multiple colors.");
         pChain->SetAttrToEnd(iTestIndex, TestAttr);
 
         // From 7 segments down to 5.
-        VERIFY_ARE_EQUAL(pChain->_list.size(), 5u);
+        const auto chainRuns = pChain->GetRuns();
+        VERIFY_ARE_EQUAL(chainRuns.size(), 5u);
 
         // Verify chain colors and lengths
-        VERIFY_ARE_EQUAL(TextAttribute(0), pChain->_list[0].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[0].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(0), chainRuns[0].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[0].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(1), pChain->_list[1].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[1].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(1), chainRuns[1].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[1].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(2), pChain->_list[2].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[2].GetLength(), (unsigned int)13);
+        VERIFY_ARE_EQUAL(TextAttribute(2), chainRuns[2].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[2].GetLength(), (unsigned int)13);
 
-        VERIFY_ARE_EQUAL(TextAttribute(3), pChain->_list[3].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[3].GetLength(), (unsigned int)11);
+        VERIFY_ARE_EQUAL(TextAttribute(3), chainRuns[3].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[3].GetLength(), (unsigned int)11);
 
-        VERIFY_ARE_EQUAL(TestAttr, pChain->_list[4].GetAttributes());
-        VERIFY_ARE_EQUAL(pChain->_list[4].GetLength(), (unsigned int)30);
+        VERIFY_ARE_EQUAL(TestAttr, chainRuns[4].GetAttributes());
+        VERIFY_ARE_EQUAL(chainRuns[4].GetLength(), (unsigned int)30);
 
         Log::Comment(L"SECOND: Set index to 0 to test replacing anything with a single");
 
@@ -684,13 +644,14 @@ class AttrRowTests
             pUnderTest->SetAttrToEnd(0, TestAttr);
 
             // should be down to 1 attribute set from beginning to end of string
-            VERIFY_ARE_EQUAL(pUnderTest->_list.size(), 1u);
+            const auto runs = pUnderTest->GetRuns();
+            VERIFY_ARE_EQUAL(runs.size(), 1u);
 
             // singular pair should contain the color
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetAttributes(), TestAttr);
+            VERIFY_ARE_EQUAL(runs[0].GetAttributes(), TestAttr);
 
             // and its length should be the length of the whole string
-            VERIFY_ARE_EQUAL(pUnderTest->_list[0].GetLength(), (unsigned int)_sDefaultLength);
+            VERIFY_ARE_EQUAL(runs[0].GetLength(), (unsigned int)_sDefaultLength);
         }
     }
 
@@ -728,4 +689,75 @@ class AttrRowTests
         VERIFY_THROWS_SPECIFIC(pSingle->Resize(0), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
         VERIFY_THROWS_SPECIFIC(pChain->Resize(0), wil::ResultException, [](wil::ResultException& e) { return e.GetErrorCode() == E_INVALIDARG; });
     }
+
+    TEST_METHOD(TestAttributeInterning)
+    {
+        Log::Comment(L"Equal attributes must share a single table entry.");
+        const TextAttribute attr{ RGB(12, 34, 56), RGB(65, 43, 21) };
+        VERIFY_IS_FALSE(_table.Find(attr).has_value());
+
+        const auto sizeBefore = _table.size();
+        const auto id1 = _table.Intern(attr);
+        const auto id2 = _table.Intern(attr);
+        VERIFY_ARE_EQUAL(id1, id2);
+        VERIFY_ARE_EQUAL(sizeBefore + 1, _table.size());
+        VERIFY_ARE_EQUAL(attr, _table.At(id1));
+
+        Log::Comment(L"Rows written with the same attribute must store the same ID.");
+        pSingle->SetAttrToEnd(10, attr);
+        pChain->SetAttrToEnd(20, attr);
+        VERIFY_ARE_EQUAL(id1, pSingle->_list.back().GetAttributeId());
+        VERIFY_ARE_EQUAL(id1, pChain->_list.back().GetAttributeId());
+    }
+
+    TEST_METHOD(TestAttributeTableCompaction)
+    {
+        TextAttributeTable table;
+        ATTR_ROW row{ 10, _DefaultAttr, table };
+
+        Log::Comment(L"Fill the table with attributes that no row uses.");
+        for (WORD i = 0; i < 100; i++)
+        {
+            table.Intern(TextAttribute{ RGB(i, 0, 0), RGB(0, i, 0) });
+        }
+        const TextAttribute kept{ RGB(1, 2, 3), RGB(4, 5, 6) };
+        row.SetAttrToEnd(5, kept);
+
+        std::vector<bool> inUse(table.size(), false);
+        row.CollectAttributeIds(inUse);
+        const auto newIds = table.Compact(inUse);
+        row.RemapAttributeIds(newIds);
+
+        Log::Comment(L"Only the default attribute and the ones in use remain.");
+        VERIFY_ARE_EQUAL(3u, table.size());
+        VERIFY_ARE_EQUAL(_DefaultAttr, row.GetAttrByColumn(0));
+        VERIFY_ARE_EQUAL(kept, row.GetAttrByColumn(9));
+    }
+
+    TEST_METHOD(TestAttributeTableExhaustion)
+    {
+        TextAttributeTable table;
+
+        Log::Comment(L"Fill the entire 16-bit ID space.");
+        for (DWORD i = 0; table.size() <= std::numeric_limits<TextAttributeTable::id_type>::max(); i++)
+        {
+            table.Intern(TextAttribute{ RGB(i & 0xff, (i >> 8) & 0xff, 0), RGB(0, 0, 0) });
+        }
+        const auto sizeBefore = table.size();
+
+        Log::Comment(L"Interning into a full table must neither throw nor grow it.");
+        const TextAttribute attr{ RGB(10, 20, 1), RGB(0, 0, 0) };
+        TextAttributeTable::id_type id = 0;
+        VERIFY_NO_THROW(id = table.Intern(attr));
+        VERIFY_ARE_EQUAL(sizeBefore, table.size());
+
+        Log::Comment(L"The stand-in is the closest color that is already interned.");
+        const TextAttribute closest{ RGB(10, 20, 0), RGB(0, 0, 0) };
+        VERIFY_ARE_EQUAL(closest, table.At(id));
+
+        Log::Comment(L"Rows can still be written.");
+        ATTR_ROW row{ 10, _DefaultAttr, table };
+        VERIFY_NO_THROW(row.SetAttrToEnd(5, attr));
+        VERIFY_ARE_EQUAL(closest, row.GetAttrByColumn(9));
+    }
 };
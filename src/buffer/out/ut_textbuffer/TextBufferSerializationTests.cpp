@@ -0,0 +1,113 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../textBuffer.hpp"
+#include "../../renderer/inc/DummyRenderTarget.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+class TextBufferSerializationTests
+{
+    TEST_CLASS(TextBufferSerializationTests);
+
+    static void VerifyBuffersAreEqual(const TextBuffer& expected, const TextBuffer& actual)
+    {
+        const auto size = expected.GetSize().Dimensions();
+        VERIFY_ARE_EQUAL(size, actual.GetSize().Dimensions());
+        VERIFY_ARE_EQUAL(expected.GetCursor().GetPosition(), actual.GetCursor().GetPosition());
+        VERIFY_ARE_EQUAL(expected.GetCurrentAttributes(), actual.GetCurrentAttributes());
+
+        for (SHORT y = 0; y < size.Y; ++y)
+        {
+            const auto& expectedRow = expected.GetRowByOffset(y);
+            const auto& actualRow = actual.GetRowByOffset(y);
+            Log::Comment(NoThrowString().Format(L"Row %d", y));
+
+            VERIFY_ARE_EQUAL(expectedRow.GetText(), actualRow.GetText());
+            VERIFY_ARE_EQUAL(expectedRow.WasWrapForced(), actualRow.WasWrapForced());
+            VERIFY_ARE_EQUAL(expectedRow.WasDoubleBytePadded(), actualRow.WasDoubleBytePadded());
+            VERIFY_IS_TRUE(expectedRow.GetLineRendition() == actualRow.GetLineRendition());
+            VERIFY_ARE_EQUAL(expectedRow.GetCharRow().IsMaterialized(), actualRow.GetCharRow().IsMaterialized());
+            VERIFY_ARE_EQUAL(expectedRow.GetAttrRow().GetNumberOfRuns(), actualRow.GetAttrRow().GetNumberOfRuns());
+
+            for (SHORT x = 0; x < size.X; ++x)
+            {
+                const auto& expectedCell = expected.GetCellDataAt({ x, y });
+                const auto& actualCell = actual.GetCellDataAt({ x, y });
+                VERIFY_IS_TRUE(expectedCell->Chars() == actualCell->Chars());
+                VERIFY_ARE_EQUAL(expectedCell->DbcsAttr().IsTrailing(), actualCell->DbcsAttr().IsTrailing());
+                VERIFY_ARE_EQUAL(expectedCell->TextAttr(), actualCell->TextAttr());
+            }
+        }
+    }
+
+    TEST_METHOD(RoundTrip)
+    {
+        DummyRenderTarget target;
+        TextBuffer buffer{ { 10, 6 }, TextAttribute{ 0x7 }, 0, target };
+
+        // Rotate the circular buffer, so that row IDs and offsets differ.
+        buffer.IncrementCircularBuffer();
+        buffer.IncrementCircularBuffer();
+
+        const auto hyperlinkId = buffer.GetHyperlinkId(L"https://example.com", L"custom");
+        buffer.AddHyperlinkToMap(L"https://example.com", hyperlinkId);
+        auto linkAttr = TextAttribute{ RGB(1, 2, 3), RGB(4, 5, 6) };
+        linkAttr.SetHyperlinkId(hyperlinkId);
+
+        buffer.Write(OutputCellIterator{ L"plain", TextAttribute{ 0x1e } }, { 0, 0 });
+        buffer.Write(OutputCellIterator{ L"link", linkAttr }, { 5, 0 });
+        buffer.Write(OutputCellIterator{ L"\xFF21\xFF22", TextAttribute{ 0x4a } }, { 1, 1 });
+        buffer.Write(OutputCellIterator{ L"\xD83D\xDE00", TextAttribute{ 0x2c } }, { 6, 1 });
+        buffer.GetRowByOffset(1).SetWrapForced(true);
+        buffer.GetRowByOffset(3).SetLineRendition(LineRendition::DoubleWidth);
+        buffer.Write(OutputCellIterator{ L"last" }, { 0, 5 });
+        buffer.GetCursor().SetPosition({ 4, 5 });
+        buffer.SetCurrentAttributes(linkAttr);
+
+        const auto data = buffer.Serialize();
+
+        Log::Comment(L"Restore into a buffer of a different size.");
+        TextBuffer restored{ { 4, 3 }, TextAttribute{ 0x7 }, 0, target };
+        restored.Deserialize(data);
+        VerifyBuffersAreEqual(buffer, restored);
+
+        VERIFY_ARE_EQUAL(L"https://example.com", restored.GetHyperlinkUriFromId(hyperlinkId));
+        VERIFY_ARE_EQUAL(buffer.GetCustomIdFromId(hyperlinkId), restored.GetCustomIdFromId(hyperlinkId));
+        VERIFY_IS_FALSE(restored.GetRowByOffset(2).GetCharRow().IsMaterialized());
+
+        Log::Comment(L"A restored buffer round-trips as well.");
+        TextBuffer restoredTwice{ { 10, 6 }, TextAttribute{ 0x7 }, 0, target };
+        restoredTwice.Deserialize(restored.Serialize());
+        VerifyBuffersAreEqual(buffer, restoredTwice);
+    }
+
+    TEST_METHOD(RejectsInvalidSnapshots)
+    {
+        DummyRenderTarget target;
+        TextBuffer buffer{ { 10, 4 }, TextAttribute{ 0x7 }, 0, target };
+        buffer.Write(OutputCellIterator{ L"keep" }, { 0, 0 });
+
+        TextBuffer other{ { 8, 2 }, TextAttribute{ 0x7 }, 0, target };
+        other.Write(OutputCellIterator{ L"replace" }, { 0, 1 });
+        const auto data = other.Serialize();
+
+        Log::Comment(L"Truncated snapshot");
+        VERIFY_THROWS(buffer.Deserialize(gsl::make_span(data).first(data.size() - 1)), wil::ResultException);
+
+        Log::Comment(L"Unknown version");
+        auto wrongVersion = data;
+        wrongVersion.at(4) = std::byte{ 0xff };
+        VERIFY_THROWS(buffer.Deserialize(wrongVersion), wil::ResultException);
+
+        Log::Comment(L"The buffer is unchanged after a failed restore.");
+        VERIFY_ARE_EQUAL(10, buffer.GetSize().Width());
+        VERIFY_ARE_EQUAL(L"keep      ", buffer.GetRowByOffset(0).GetText());
+    }
+};
@@ -15,37 +15,81 @@ class UnicodeStorageTests
 {
     TEST_CLASS(UnicodeStorageTests);
 
-    TEST_METHOD(CanOverwriteEmoji)
+    TEST_METHOD(StoresIdenticalGlyphsOnce)
     {
         UnicodeStorage storage;
-        const COORD coord{ 1, 3 };
-        const std::vector<wchar_t> newMoon{ 0xD83C, 0xDF11 };
-        const std::vector<wchar_t> fullMoon{ 0xD83C, 0xDF15 };
-
-        // store initial glyph
-        storage.StoreGlyph(coord, newMoon);
-
-        // verify it was stored
-        auto findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& newMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(newMoonGlyph.size(), newMoon.size());
-        for (size_t i = 0; i < newMoon.size(); ++i)
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
+
+        const auto newMoonKey = storage.StoreGlyph(newMoon);
+        const auto fullMoonKey = storage.StoreGlyph(fullMoon);
+        VERIFY_ARE_NOT_EQUAL(newMoonKey, fullMoonKey);
+
+        // Storing the same glyph again hands out the same key.
+        VERIFY_ARE_EQUAL(newMoonKey, storage.StoreGlyph(newMoon));
+        VERIFY_ARE_EQUAL(2u, storage.size());
+
+        VERIFY_IS_TRUE(storage.GetText(newMoonKey) == newMoon);
+        VERIFY_IS_TRUE(storage.GetText(fullMoonKey) == fullMoon);
+    }
+
+    TEST_METHOD(CompactKeepsKeysAndReusesFreedOnes)
+    {
+        UnicodeStorage storage;
+        const std::wstring_view newMoon{ L"\xD83C\xDF11" };
+        const std::wstring_view fullMoon{ L"\xD83C\xDF15" };
+        const std::wstring_view peach{ L"\xD83C\xDF51" };
+
+        const auto newMoonKey = storage.StoreGlyph(newMoon);
+        const auto fullMoonKey = storage.StoreGlyph(fullMoon);
+
+        std::vector<bool> inUse(storage._glyphs.size(), false);
+        inUse.at(fullMoonKey) = true;
+        storage.Compact(inUse);
+
+        // The glyph still in use keeps its key, the other one is gone.
+        VERIFY_ARE_EQUAL(1u, storage.size());
+        VERIFY_IS_TRUE(storage.GetText(fullMoonKey) == fullMoon);
+        VERIFY_ARE_EQUAL(fullMoonKey, storage.StoreGlyph(fullMoon));
+
+        // The freed key is handed out again.
+        VERIFY_ARE_EQUAL(newMoonKey, storage.StoreGlyph(peach));
+        VERIFY_IS_TRUE(storage.GetText(newMoonKey) == peach);
+        VERIFY_ARE_EQUAL(2u, storage.size());
+    }
+
+    TEST_METHOD(CompactsAgainOnlyAfterMarginWasStored)
+    {
+        UnicodeStorage storage;
+        wchar_t surrogates[2]{ 0xD800, 0xDC00 };
+        const auto storeNext = [&]() {
+            storage.StoreGlyph({ surrogates, 2 });
+            if (++surrogates[1] > 0xDFFF)
+            {
+                surrogates[1] = 0xDC00;
+                ++surrogates[0];
+            }
+        };
+
+        while (storage.size() < UnicodeStorage::CompactionThreshold)
         {
-            VERIFY_ARE_EQUAL(newMoonGlyph.at(i), newMoon.at(i));
+            VERIFY_IS_FALSE(storage.ShouldCompact());
+            storeNext();
         }
+        VERIFY_IS_TRUE(storage.ShouldCompact());
 
-        // overwrite it
-        storage.StoreGlyph(coord, fullMoon);
+        Log::Comment(L"Compact while all glyphs are still in use. Nothing is freed.");
+        storage.Compact(std::vector<bool>(storage._glyphs.size(), true));
+        VERIFY_ARE_EQUAL(UnicodeStorage::CompactionThreshold, storage.size());
+        VERIFY_IS_FALSE(storage.ShouldCompact());
 
-        // verify the glyph was overwritten
-        findIt = storage._map.find(coord);
-        VERIFY_ARE_NOT_EQUAL(findIt, storage._map.end());
-        const std::vector<wchar_t>& fullMoonGlyph = findIt->second;
-        VERIFY_ARE_EQUAL(fullMoonGlyph.size(), fullMoon.size());
-        for (size_t i = 0; i < fullMoon.size(); ++i)
+        for (size_t i = 1; i < UnicodeStorage::CompactionMargin; ++i)
         {
-            VERIFY_ARE_EQUAL(fullMoonGlyph.at(i), fullMoon.at(i));
+            storeNext();
+            VERIFY_IS_FALSE(storage.ShouldCompact());
         }
+
+        storeNext();
+        VERIFY_IS_TRUE(storage.ShouldCompact());
     }
 };
@@ -257,6 +257,30 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         }
 
         _startTime = std::chrono::high_resolution_clock::now();
+        _lastOutputQueueTrace = std::chrono::steady_clock::now();
+
+        auto [producer, consumer] = til::spsc::channel<winrt::hstring>(OutputQueueCapacity);
+        _outputProducer.emplace(std::move(producer));
+        _outputConsumer.emplace(std::move(consumer));
+
+        // The apply thread raises TerminalOutput for everything the output thread reads.
+        // It runs until the output thread drops its end of the queue.
+        _hApplyThread.reset(CreateThread(
+            nullptr,
+            0,
+            [](LPVOID lpParameter) noexcept {
+                ConptyConnection* const pInstance = static_cast<ConptyConnection*>(lpParameter);
+                if (pInstance)
+                {
+                    return pInstance->_ApplyThread();
+                }
+                return gsl::narrow_cast<DWORD>(E_INVALIDARG);
+            },
+            this,
+            0,
+            nullptr));
+
+        THROW_LAST_ERROR_IF_NULL(_hApplyThread);
 
         // Create our own output handling thread
         // This must be done after the pipes are populated.
@@ -304,6 +328,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         // Tear down any state we may have accumulated.
         _hPC.reset();
+
+        // Without an output thread nobody would ever stop the apply thread.
+        if (!_hOutputThread)
+        {
+            _DrainOutputQueue();
+        }
     }
 
     // Method Description:
@@ -388,6 +418,10 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
             // EXIT POINT
             _clientExitWait.reset(); // immediately stop waiting for the client to exit.
 
+            // Whatever output is still queued up is for a terminal that's going away.
+            // Don't make the caller wait for the apply thread to raise all of it.
+            _discardOutput.store(true, std::memory_order_relaxed);
+
             _hPC.reset(); // tear down the pseudoconsole (this is like clicking X on a console window)
 
             _inPipe.reset(); // break the pipes
@@ -431,6 +465,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 if (lastError != ERROR_BROKEN_PIPE && !_isStateAtOrBeyond(ConnectionState::Closing))
                 {
                     // EXIT POINT
+                    _DrainOutputQueue();
                     _indicateExitWithStatus(HRESULT_FROM_WIN32(lastError)); // print a message
                     _transitionToState(ConnectionState::Failed);
                     return gsl::narrow_cast<DWORD>(HRESULT_FROM_WIN32(lastError));
@@ -444,10 +479,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 if (_isStateAtOrBeyond(ConnectionState::Closing))
                 {
                     // This termination was expected.
+                    _DrainOutputQueue();
                     return 0;
                 }
 
                 // EXIT POINT
+                _DrainOutputQueue();
                 _indicateExitWithStatus(result); // print a message
                 _transitionToState(ConnectionState::Failed);
                 return gsl::narrow_cast<DWORD>(result);
@@ -455,6 +492,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
             if (_u16Str.empty())
             {
+                _DrainOutputQueue();
                 return 0;
             }
 
@@ -474,13 +512,143 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
                 _receivedFirstByte = true;
             }
 
-            // Pass the output to our registered event handlers
-            _TerminalOutputHandlers(_u16Str);
+            // Hand the output over to the apply thread. This only blocks if the
+            // apply thread has fallen OutputQueueCapacity chunks behind.
+            const auto depth = _outputQueueDepth.fetch_add(1, std::memory_order_relaxed) + 1;
+            if (depth > _outputQueuePeakDepth.load(std::memory_order_relaxed))
+            {
+                _outputQueuePeakDepth.store(depth, std::memory_order_relaxed);
+            }
+            _outputChunks.fetch_add(1, std::memory_order_relaxed);
+
+            if (!_outputProducer->emplace(_u16Str))
+            {
+                // The apply thread is gone; there's nobody left to deliver output to.
+                _DrainOutputQueue();
+                return 0;
+            }
+        }
+    }
+
+    // Method Description:
+    // - The body of the apply thread. Raises TerminalOutput for each chunk
+    //   that the output thread queued up, until the output thread is done.
+    //   Once the connection is closed, the remaining chunks are only popped,
+    //   so that the output thread never blocks on a full queue.
+    // Return Value:
+    // - 0
+    DWORD ConptyConnection::_ApplyThread()
+    {
+        // Keep us alive until the apply thread terminates, see _OutputThread.
+        auto strongThis{ get_strong() };
+
+        while (auto chunk = _outputConsumer->pop())
+        {
+            _outputQueueDepth.fetch_sub(1, std::memory_order_relaxed);
+
+            if (_discardOutput.load(std::memory_order_relaxed))
+            {
+                _coalescedOutput = std::wstring{};
+                continue;
+            }
+
+            ++_outputBatches;
+            if (std::chrono::steady_clock::now() - _lastOutputQueueTrace >= OutputQueueTraceInterval)
+            {
+                _TraceOutputQueueStats(false);
+            }
+
+            // If the output thread got ahead of us, apply everything it queued up
+            // since in one go, so that the terminal only needs to lock once.
+            // _outputQueueDepth is incremented before a chunk is pushed and
+            // decremented after it was popped, so it never exceeds the number of
+            // chunks that are in the queue or about to be. pop() can't stall here.
+            const auto backlog = std::min(_outputQueueDepth.load(std::memory_order_relaxed), OutputQueueCapacity);
+            if (backlog == 0)
+            {
+                // We caught up, so the burst that needed a large buffer is over.
+                if (_coalescedOutput.capacity() != 0)
+                {
+                    _coalescedOutput = std::wstring{};
+                }
+
+                _TerminalOutputHandlers(*chunk);
+                continue;
+            }
+
+            // Only take what was queued up when we started. Otherwise a producer that
+            // keeps up with us would keep this batch (and its buffer) growing forever,
+            // and the terminal would see none of it until the output pauses.
+            _coalescedOutput.assign(*chunk);
+            for (uint32_t i = 0; i < backlog; ++i)
+            {
+                auto next = _outputConsumer->pop();
+                if (!next)
+                {
+                    break;
+                }
+                _outputQueueDepth.fetch_sub(1, std::memory_order_relaxed);
+                _coalescedOutput.append(*next);
+            }
+
+            // Close() may have been called while we were collecting the batch.
+            if (!_discardOutput.load(std::memory_order_relaxed))
+            {
+                _TerminalOutputHandlers(_coalescedOutput);
+            }
         }
 
         return 0;
     }
 
+    // Method Description:
+    // - Tells the apply thread that no more output is coming and waits
+    //   until it has raised TerminalOutput for everything still queued up
+    //   (or, after Close(), thrown it away).
+    //   Called by the output thread before it exits (and by Start() if the
+    //   output thread couldn't be created), so that waiting on the output
+    //   thread is enough to know that all output was delivered.
+    void ConptyConnection::_DrainOutputQueue() noexcept
+    {
+        _outputProducer.reset();
+
+        if (auto localApplyThreadHandle = std::move(_hApplyThread))
+        {
+            LOG_LAST_ERROR_IF(WAIT_FAILED == WaitForSingleObject(localApplyThreadHandle.get(), INFINITE));
+            _TraceOutputQueueStats(true);
+        }
+    }
+
+    // Method Description:
+    // - Reports how far the output thread got ahead of the apply thread since
+    //   the last report, and starts a new reporting period. Called by the apply
+    //   thread every OutputQueueTraceInterval while there's output, and once
+    //   more after it exited.
+    // Arguments:
+    // - final: true if the output thread is done.
+    void ConptyConnection::_TraceOutputQueueStats(const bool final) noexcept
+    {
+        _lastOutputQueueTrace = std::chrono::steady_clock::now();
+
+        const auto peakDepth = _outputQueuePeakDepth.exchange(0, std::memory_order_relaxed);
+        const auto chunks = _outputChunks.exchange(0, std::memory_order_relaxed);
+        const auto batches = std::exchange(_outputBatches, 0);
+
+#pragma warning(suppress : 26477 26485 26494 26482 26446) // We don't control TraceLoggingWrite
+        TraceLoggingWrite(g_hTerminalConnectionProvider,
+                          "OutputQueueStats",
+                          TraceLoggingDescription("An event emitted periodically while a connection produces output, and once when it stops, describing how far its reader got ahead of the terminal"),
+                          TraceLoggingGuid(_guid, "SessionGuid", "The WT_SESSION's GUID"),
+                          TraceLoggingUInt32(OutputQueueCapacity, "Capacity", "The maximum number of chunks that can be queued up"),
+                          TraceLoggingUInt32(peakDepth, "PeakDepth", "The maximum number of chunks that were queued up at once since the last event"),
+                          TraceLoggingUInt64(chunks, "Chunks", "The number of chunks read from the output pipe since the last event"),
+                          TraceLoggingUInt64(batches, "Batches", "The number of times TerminalOutput was raised since the last event"),
+                          TraceLoggingBool(final, "Final", "Whether the connection stopped producing output"),
+                          TraceLoggingBool(_discardOutput.load(std::memory_order_relaxed), "Discarded", "Whether output still queued up at Close() was thrown away"),
+                          TraceLoggingKeyword(MICROSOFT_KEYWORD_MEASURES),
+                          TelemetryPrivacyDataTag(PDT_ProductAndServicePerformance));
+    }
+
     static winrt::event<NewConnectionHandler> _newConnectionHandlers;
 
     winrt::event_token ConptyConnection::NewConnection(NewConnectionHandler const& handler) { return _newConnectionHandlers.add(handler); };
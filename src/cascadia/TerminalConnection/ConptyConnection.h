@@ -56,6 +56,12 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
 
         static HRESULT NewHandoff(HANDLE in, HANDLE out, HANDLE signal, HANDLE process) noexcept;
 
+        // The number of decoded chunks (each at most _buffer.size() characters long)
+        // that the output thread may read ahead of the apply thread.
+        static constexpr uint32_t OutputQueueCapacity = 64;
+        // How often the apply thread reports how the queue is doing, while there's output.
+        static constexpr std::chrono::seconds OutputQueueTraceInterval{ 10 };
+
         uint32_t _initialRows{};
         uint32_t _initialCols{};
         hstring _commandline;
@@ -71,6 +77,7 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         wil::unique_hfile _inPipe; // The pipe for writing input to
         wil::unique_hfile _outPipe; // The pipe for reading output from
         wil::unique_handle _hOutputThread;
+        wil::unique_handle _hApplyThread;
         wil::unique_process_information _piClient;
         wil::unique_static_pseudoconsole_handle _hPC;
         wil::unique_threadpool_wait _clientExitWait;
@@ -79,7 +86,25 @@ namespace winrt::Microsoft::Terminal::TerminalConnection::implementation
         std::wstring _u16Str;
         std::array<char, 4096> _buffer;
 
+        // _OutputThread reads and decodes the output pipe and hands the text over
+        // to _ApplyThread, which raises TerminalOutput. That way the pipe keeps
+        // being drained while the terminal is busy (or locked) applying output.
+        std::optional<til::spsc::producer<winrt::hstring>> _outputProducer;
+        std::optional<til::spsc::consumer<winrt::hstring>> _outputConsumer;
+        std::wstring _coalescedOutput; // at most OutputQueueCapacity + 1 chunks, released once the apply thread caught up
+        std::atomic<bool> _discardOutput{ false }; // set by Close(): nobody wants to see the output that's still queued up
+        std::atomic<uint32_t> _outputQueueDepth{ 0 };
+
+        // Queue statistics since the last OutputQueueStats event.
+        std::atomic<uint32_t> _outputQueuePeakDepth{ 0 };
+        std::atomic<uint64_t> _outputChunks{ 0 };
+        uint64_t _outputBatches{ 0 };
+        std::chrono::steady_clock::time_point _lastOutputQueueTrace{};
+
         DWORD _OutputThread();
+        DWORD _ApplyThread();
+        void _DrainOutputQueue() noexcept;
+        void _TraceOutputQueueStats(const bool final) noexcept;
     };
 }
 
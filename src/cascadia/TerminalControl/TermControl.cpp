@@ -39,6 +39,10 @@ constexpr const auto TsfRedrawInterval = std::chrono::milliseconds(100);
 // The minimum delay between updating the locations of regex patterns
 constexpr const auto UpdatePatternLocationsInterval = std::chrono::milliseconds(500);
 
+// The minimum delay between VT mouse motion reports. Motion in between is
+// coalesced into the latest position, so that's at most one report per frame.
+constexpr const auto MouseMotionFlushInterval = std::chrono::milliseconds(16);
+
 DEFINE_ENUM_FLAG_OPERATORS(winrt::Microsoft::Terminal::Control::CopyFormat);
 
 namespace winrt::Microsoft::Terminal::Control::implementation
@@ -87,6 +91,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         InitializeComponent();
 
         _terminal = std::make_unique<::Microsoft::Terminal::Core::Terminal>();
+        _terminal->EnableMouseMotionCoalescing(true);
 
         // GH#8969: pre-seed working directory to prevent potential races
         _terminal->SetWorkingDirectory(_settings.StartingDirectory());
@@ -122,7 +127,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         _connectionOutputEventToken = _connection.TerminalOutput(onReceiveOutputFn);
 
         _terminal->SetWriteInputCallback([this](std::wstring& wstr) {
-            _SendInputToConnection(wstr);
+            _WriteInputToConnection(wstr);
         });
 
         _terminal->UpdateSettings(settings);
@@ -167,6 +172,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             UpdatePatternLocationsInterval,
             Dispatcher());
 
+        _flushMouseMotion = std::make_shared<ThrottledFunc<>>(
+            [weakThis = get_weak()]() {
+                if (auto control{ weakThis.get() })
+                {
+                    control->_FlushPendingMouseMotion();
+                }
+            },
+            MouseMotionFlushInterval,
+            Dispatcher());
+
         _updateScrollBar = std::make_shared<ThrottledFunc<ScrollBarUpdate>>(
             [weakThis = get_weak()](const auto& update) {
                 if (auto control{ weakThis.get() })
@@ -1240,7 +1255,16 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         const auto modifiers = _GetPressedModifierKeys();
         const TerminalInput::MouseButtonState state{ props.IsLeftButtonPressed(), props.IsMiddleButtonPressed(), props.IsRightButtonPressed() };
-        return _terminal->SendMouseEvent(terminalPosition, uiButton, modifiers, sWheelDelta, state);
+        const auto handled = _terminal->SendMouseEvent(terminalPosition, uiButton, modifiers, sWheelDelta, state);
+
+        // Motion reports are held back by the terminal. Make sure the
+        // latest one gets sent within a frame.
+        if (handled && uiButton == WM_MOUSEMOVE)
+        {
+            _flushMouseMotion->Run();
+        }
+
+        return handled;
     }
 
     // Method Description:
@@ -2055,25 +2079,36 @@ namespace winrt::Microsoft::Terminal::Control::implementation
     }
 
     // Method Description:
-    // - Writes the given sequence as input to the active terminal connection.
+    // - Writes the given sequence as input to the active terminal connection,
+    //   after any mouse motion report the terminal is still holding back, so
+    //   that the client sees the input in the order it happened.
     // - This method has been overloaded to allow zero-copy winrt::param::hstring optimizations.
+    // - Must not be called while holding the terminal lock.
     // Arguments:
     // - wstr: the string of characters to write to the terminal connection.
     // Return Value:
     // - <none>
     void TermControl::_SendInputToConnection(const winrt::hstring& wstr)
     {
-        if (_isReadOnly)
-        {
-            _RaiseReadOnlyWarning();
-        }
-        else
-        {
-            _connection.WriteInput(wstr);
-        }
+        _FlushPendingMouseMotion();
+        _WriteInputToConnection(wstr);
     }
 
     void TermControl::_SendInputToConnection(std::wstring_view wstr)
+    {
+        _FlushPendingMouseMotion();
+        _WriteInputToConnection(wstr);
+    }
+
+    // Method Description:
+    // - Writes the given sequence straight to the active terminal connection.
+    //   This is what the terminal's own input callback uses: the terminal
+    //   sends any pending motion report ahead of its other input itself.
+    // Arguments:
+    // - wstr: the string of characters to write to the terminal connection.
+    // Return Value:
+    // - <none>
+    void TermControl::_WriteInputToConnection(const winrt::param::hstring& wstr)
     {
         if (_isReadOnly)
         {
@@ -2085,11 +2120,25 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         }
     }
 
+    // Method Description:
+    // - Sends the mouse motion report the terminal is holding back, if any.
+    //   Takes the terminal lock, so must not be called while holding it.
+    // Arguments:
+    // - <none>
+    // Return Value:
+    // - <none>
+    void TermControl::_FlushPendingMouseMotion()
+    {
+        auto lock = _terminal->LockForWriting();
+        _terminal->FlushPendingMouseMotion();
+    }
+
     // Method Description:
     // - Pre-process text pasted (presumably from the clipboard)
     //   before sending it over the terminal's connection.
     void TermControl::_SendPastedTextToConnection(const std::wstring& wstr)
     {
+        _FlushPendingMouseMotion();
         _terminal->WritePastedText(wstr);
         _terminal->ClearSelection();
         _terminal->TrySnapOnInput();
@@ -2496,43 +2545,53 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return false;
         }
 
-        // no selection --> nothing to copy
-        if (!_terminal->IsSelectionActive())
+        std::wstring textData;
+        std::string htmlData;
+        std::string rtfData;
         {
-            return false;
-        }
+            // The exporter walks the live buffer once per format. Hold the lock for all
+            // of them, so that output or a resize can't change the buffer in between.
+            auto lock = _terminal->LockForReading();
 
-        // Mark the current selection as copied
-        _selectionNeedsToBeCopied = false;
+            // no selection --> nothing to copy
+            if (!_terminal->IsSelectionActive())
+            {
+                return false;
+            }
 
-        // extract text from buffer
-        const auto bufferData = _terminal->RetrieveSelectedTextFromBuffer(singleLine);
+            // Mark the current selection as copied
+            _selectionNeedsToBeCopied = false;
 
-        // convert text: vector<string> --> string
-        std::wstring textData;
-        for (const auto& text : bufferData.text)
-        {
-            textData += text;
-        }
-
-        // convert text to HTML format
-        // GH#5347 - Don't provide a title for the generated HTML, as many
-        // web applications will paste the title first, followed by the HTML
-        // content, which is unexpected.
-        const auto htmlData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML) ?
-                                  TextBuffer::GenHTML(bufferData,
-                                                      _actualFont.GetUnscaledSize().Y,
-                                                      _actualFont.GetFaceName(),
-                                                      til::color{ _settings.DefaultBackground() }) :
-                                  "";
-
-        // convert to RTF format
-        const auto rtfData = formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF) ?
-                                 TextBuffer::GenRTF(bufferData,
-                                                    _actualFont.GetUnscaledSize().Y,
-                                                    _actualFont.GetFaceName(),
-                                                    til::color{ _settings.DefaultBackground() }) :
-                                 "";
+            // Stream the selection straight out of the buffer into each format,
+            // instead of collecting the text and colors of every cell first.
+            const auto exporter = _terminal->GetSelectionExporter(singleLine);
+            const auto getAttributeColors = [&](const TextAttribute& attr) {
+                return _terminal->GetAttributeColors(attr);
+            };
+
+            textData = exporter.GetText();
+
+            // convert text to HTML format
+            // GH#5347 - Don't provide a title for the generated HTML, as many
+            // web applications will paste the title first, followed by the HTML
+            // content, which is unexpected.
+            if (formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::HTML))
+            {
+                htmlData = exporter.GetHTML(getAttributeColors,
+                                            _actualFont.GetUnscaledSize().Y,
+                                            _actualFont.GetFaceName(),
+                                            til::color{ _settings.DefaultBackground() });
+            }
+
+            // convert to RTF format
+            if (formats == nullptr || WI_IsFlagSet(formats.Value(), CopyFormat::RTF))
+            {
+                rtfData = exporter.GetRTF(getAttributeColors,
+                                          _actualFont.GetUnscaledSize().Y,
+                                          _actualFont.GetFaceName(),
+                                          til::color{ _settings.DefaultBackground() });
+            }
+        }
 
         if (!_settings.CopyOnSelect())
         {
@@ -2992,6 +3051,7 @@ namespace winrt::Microsoft::Terminal::Control::implementation
             return;
         }
 
+        _FlushPendingMouseMotion();
         _connection.WriteInput(text);
     }
 
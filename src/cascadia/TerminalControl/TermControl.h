@@ -141,6 +141,8 @@ namespace winrt::Microsoft::Terminal::Control::implementation
 
         std::shared_ptr<ThrottledFunc<>> _updatePatternLocations;
 
+        std::shared_ptr<ThrottledFunc<>> _flushMouseMotion;
+
         struct ScrollBarUpdate
         {
             std::optional<double> newValue;
@@ -225,7 +227,9 @@ namespace winrt::Microsoft::Terminal::Control::implementation
         void _SetEndSelectionPointAtCursor(Windows::Foundation::Point const& cursorPosition);
         void _SendInputToConnection(const winrt::hstring& wstr);
         void _SendInputToConnection(std::wstring_view wstr);
+        void _WriteInputToConnection(const winrt::param::hstring& wstr);
         void _SendPastedTextToConnection(const std::wstring& wstr);
+        void _FlushPendingMouseMotion();
         void _SwapChainSizeChanged(Windows::Foundation::IInspectable const& sender, Windows::UI::Xaml::SizeChangedEventArgs const& e);
         void _SwapChainScaleChanged(Windows::UI::Xaml::Controls::SwapChainPanel const& sender, Windows::Foundation::IInspectable const& args);
         void _DoResizeUnderLock(const double newWidth, const double newHeight);
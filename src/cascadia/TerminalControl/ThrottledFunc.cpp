@@ -9,11 +9,127 @@ using namespace winrt::Windows::Foundation;
 using namespace winrt::Windows::UI::Core;
 using namespace winrt::Windows::UI::Xaml;
 
+namespace
+{
+    // Class Description:
+    // - Runs a ThrottledFuncScheduler on a CoreDispatcher, driving its wheel
+    //   with a single DispatcherTimer that's created on first use.
+    class CoreDispatcherAdapter final : public ThrottledFuncScheduler::Dispatcher
+    {
+    public:
+        explicit CoreDispatcherAdapter(CoreDispatcher dispatcher) noexcept :
+            _dispatcher{ std::move(dispatcher) }
+        {
+        }
+
+        // A running DispatcherTimer is kept alive by XAML. Its handler only holds
+        // a weak reference to the scheduler, but it should stop ticking anyway.
+        ~CoreDispatcherAdapter()
+        {
+            try
+            {
+                StopTimer();
+            }
+            CATCH_LOG();
+        }
+
+        void Post(const std::weak_ptr<ThrottledFuncScheduler>& scheduler) noexcept override
+        {
+            try
+            {
+                _dispatcher.RunAsync(CoreDispatcherPriority::Low, [scheduler]() {
+                    if (const auto self{ scheduler.lock() })
+                    {
+                        self->Wake();
+                    }
+                });
+            }
+            CATCH_LOG();
+        }
+
+        void StartTimer(const std::weak_ptr<ThrottledFuncScheduler>& scheduler, ThrottledFuncScheduler::duration interval) override
+        {
+            if (!_timer)
+            {
+                _timer = DispatcherTimer{};
+                _timer.Tick([scheduler](auto&&...) {
+                    if (const auto self{ scheduler.lock() })
+                    {
+                        self->Tick();
+                    }
+                });
+            }
+            else
+            {
+                // Restart the countdown, in case the timer is running with another interval.
+                _timer.Stop();
+            }
+            _timer.Interval(std::chrono::duration_cast<TimeSpan>(interval));
+            _timer.Start();
+        }
+
+        void StopTimer() override
+        {
+            if (_timer)
+            {
+                _timer.Stop();
+            }
+        }
+
+        ThrottledFuncScheduler::time_point Now() const noexcept override
+        {
+            return std::chrono::steady_clock::now();
+        }
+
+    private:
+        CoreDispatcher _dispatcher;
+        DispatcherTimer _timer{ nullptr };
+    };
+}
+
+// Function Description:
+// - Returns the scheduler shared by all ThrottledFuncs on the given dispatcher,
+//   creating it if necessary. Each scheduler holds a strong reference to its
+//   dispatcher, so the ABI pointer identifies it for as long as it's alive.
+// - This is only called when a ThrottledFunc is constructed, never from Run.
+// Arguments:
+// - dispatcher: the dispatcher the throttled functions will run on
+// Return Value:
+// - The shared scheduler for that dispatcher.
+std::shared_ptr<ThrottledFuncScheduler> GetThrottledFuncScheduler(const CoreDispatcher& dispatcher)
+{
+    static std::mutex lock;
+    static std::vector<std::pair<void*, std::weak_ptr<ThrottledFuncScheduler>>> schedulers;
+
+    const auto key = winrt::get_abi(dispatcher);
+    std::lock_guard guard{ lock };
+
+    schedulers.erase(std::remove_if(schedulers.begin(), schedulers.end(), [](const auto& pair) { return pair.second.expired(); }), schedulers.end());
+
+    for (const auto& [abi, weak] : schedulers)
+    {
+        if (abi == key)
+        {
+            if (auto scheduler{ weak.lock() })
+            {
+                return scheduler;
+            }
+        }
+    }
+
+    auto scheduler = std::make_shared<ThrottledFuncScheduler>(std::make_unique<CoreDispatcherAdapter>(dispatcher));
+    schedulers.emplace_back(key, scheduler);
+    return scheduler;
+}
+
 ThrottledFunc<>::ThrottledFunc(ThrottledFunc::Func func, TimeSpan delay, CoreDispatcher dispatcher) :
-    _func{ func },
-    _delay{ delay },
-    _dispatcher{ dispatcher },
-    _isRunPending{}
+    ThrottledFunc{ std::move(func), delay, GetThrottledFuncScheduler(dispatcher) }
+{
+}
+
+ThrottledFunc<>::ThrottledFunc(ThrottledFunc::Func func, ThrottledFuncScheduler::duration delay, std::shared_ptr<ThrottledFuncScheduler> scheduler) :
+    Entry{ std::move(scheduler), delay },
+    _func{ std::move(func) }
 {
 }
 
@@ -22,33 +138,17 @@ ThrottledFunc<>::ThrottledFunc(ThrottledFunc::Func func, TimeSpan delay, CoreDis
 //   with a new argument, in which case the request will be ignored.
 // - For more information, read the class' documentation.
 // - This method is always thread-safe. It can be called multiple times on
-//   different threads.
+//   different threads. It neither locks nor allocates.
 // Arguments:
 // - <none>
 // Return Value:
 // - <none>
 void ThrottledFunc<>::Run()
 {
-    if (_isRunPending.test_and_set(std::memory_order_acquire))
-    {
-        // already pending
-        return;
-    }
+    _Schedule();
+}
 
-    _dispatcher.RunAsync(CoreDispatcherPriority::Low, [weakThis = this->weak_from_this()]() {
-        if (auto self{ weakThis.lock() })
-        {
-            DispatcherTimer timer;
-            timer.Interval(self->_delay);
-            timer.Tick([=](auto&&...) {
-                if (auto self{ weakThis.lock() })
-                {
-                    timer.Stop();
-                    self->_isRunPending.clear(std::memory_order_release);
-                    self->_func();
-                }
-            });
-            timer.Start();
-        }
-    });
+void ThrottledFunc<>::_Fire()
+{
+    _func();
 }
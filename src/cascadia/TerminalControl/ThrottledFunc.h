@@ -8,6 +8,12 @@ Module Name:
 
 #pragma once
 #include "pch.h"
+#include "ThrottledFuncScheduler.h"
+
+// Function Description:
+// - Returns the scheduler shared by all ThrottledFuncs on the given dispatcher,
+//   creating it if necessary.
+std::shared_ptr<ThrottledFuncScheduler> GetThrottledFuncScheduler(const winrt::Windows::UI::Core::CoreDispatcher& dispatcher);
 
 // Class Description:
 // - Represents a function that takes arguments and whose invocation is
@@ -16,16 +22,21 @@ Module Name:
 //   pending, then the previous call with the previous arguments will be
 //   cancelled and the call will be made with the new arguments instead.
 // - The function will be run on the the specified dispatcher.
+// - Instances must be owned by a std::shared_ptr.
 template<typename... Args>
-class ThrottledFunc : public std::enable_shared_from_this<ThrottledFunc<Args...>>
+class ThrottledFunc : public ThrottledFuncScheduler::Entry
 {
 public:
     using Func = std::function<void(Args...)>;
 
     ThrottledFunc(Func func, winrt::Windows::Foundation::TimeSpan delay, winrt::Windows::UI::Core::CoreDispatcher dispatcher) :
-        _func{ func },
-        _delay{ delay },
-        _dispatcher{ dispatcher }
+        ThrottledFunc{ std::move(func), delay, GetThrottledFuncScheduler(dispatcher) }
+    {
+    }
+
+    ThrottledFunc(Func func, ThrottledFuncScheduler::duration delay, std::shared_ptr<ThrottledFuncScheduler> scheduler) :
+        Entry{ std::move(scheduler), delay },
+        _func{ std::move(func) }
     {
     }
 
@@ -45,38 +56,10 @@ public:
     {
         {
             std::lock_guard guard{ _lock };
-
-            bool hadValue = _pendingRunArgs.has_value();
             _pendingRunArgs.emplace(std::forward<MakeArgs>(args)...);
-
-            if (hadValue)
-            {
-                // already pending
-                return;
-            }
         }
 
-        _dispatcher.RunAsync(CoreDispatcherPriority::Low, [weakThis = this->weak_from_this()]() {
-            if (auto self{ weakThis.lock() })
-            {
-                DispatcherTimer timer;
-                timer.Interval(self->_delay);
-                timer.Tick([=](auto&&...) {
-                    if (auto self{ weakThis.lock() })
-                    {
-                        timer.Stop();
-
-                        std::optional<std::tuple<Args...>> args;
-                        {
-                            std::lock_guard guard{ self->_lock };
-                            self->_pendingRunArgs.swap(args);
-                        }
-                        std::apply(self->_func, args.value());
-                    }
-                });
-                timer.Start();
-            }
-        });
+        _Schedule();
     }
 
     // Method Description:
@@ -110,10 +93,27 @@ public:
     }
 
 private:
+    void _Fire() override
+    {
+        std::optional<std::tuple<Args...>> args;
+        {
+            std::lock_guard guard{ _lock };
+            _pendingRunArgs.swap(args);
+        }
+
+        // A Run racing with the previous invocation may have scheduled us
+        // again after its arguments were already consumed.
+        if (args.has_value())
+        {
+            std::apply(_func, args.value());
+        }
+    }
+
     Func _func;
-    winrt::Windows::Foundation::TimeSpan _delay;
-    winrt::Windows::UI::Core::CoreDispatcher _dispatcher;
 
+    // The scheduler only coordinates the pending flag. The arguments
+    // themselves are guarded by this lock, which is only ever held
+    // for as long as it takes to copy them.
     std::optional<std::tuple<Args...>> _pendingRunArgs;
     std::mutex _lock;
 };
@@ -123,20 +123,20 @@ private:
 //   and rate-limited such that if the code tries to run the function while a
 //   call to the function is already pending, the request will be ignored.
 // - The function will be run on the the specified dispatcher.
+// - Instances must be owned by a std::shared_ptr.
 template<>
-class ThrottledFunc<> : public std::enable_shared_from_this<ThrottledFunc<>>
+class ThrottledFunc<> : public ThrottledFuncScheduler::Entry
 {
 public:
     using Func = std::function<void()>;
 
     ThrottledFunc(Func func, winrt::Windows::Foundation::TimeSpan delay, winrt::Windows::UI::Core::CoreDispatcher dispatcher);
+    ThrottledFunc(Func func, ThrottledFuncScheduler::duration delay, std::shared_ptr<ThrottledFuncScheduler> scheduler);
 
     void Run();
 
 private:
-    Func _func;
-    winrt::Windows::Foundation::TimeSpan _delay;
-    winrt::Windows::UI::Core::CoreDispatcher _dispatcher;
+    void _Fire() override;
 
-    std::atomic_flag _isRunPending;
+    Func _func;
 };
@@ -0,0 +1,396 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ThrottledFuncScheduler.h
+
+Abstract:
+- A coalescing scheduler shared by all ThrottledFuncs running on the same
+  dispatcher. Instead of posting a dispatcher callback and creating a
+  DispatcherTimer for every pending call, each throttled function only sets an
+  atomic pending flag and, if it wasn't pending yet, pushes itself onto a
+  lock-free list. The dispatcher thread moves those entries into a timer wheel
+  driven by a single timer, which only runs while something is pending and
+  sleeps until the next occupied slot of the wheel.
+- Like the dispatcher callbacks ThrottledFunc used to post, the wheel only
+  holds weak references to the functions: one that's destroyed while pending
+  simply doesn't fire.
+- Neither Run nor a timer tick allocates. The dispatcher is only posted to
+  when the scheduler goes from idle to busy.
+- This header is deliberately free of WinRT types, so that the scheduler can
+  be tested with a fake dispatcher.
+
+--*/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <utility>
+
+class ThrottledFuncScheduler final : public std::enable_shared_from_this<ThrottledFuncScheduler>
+{
+public:
+    using duration = std::chrono::nanoseconds;
+    using time_point = std::chrono::steady_clock::time_point;
+
+    // The length of a single slot of the timer wheel, and thus the shortest
+    // interval of the timer driving it. Delays are rounded up to a multiple of this.
+    static constexpr duration Resolution = std::chrono::milliseconds(8);
+    // 64 slots of 8ms cover 512ms. Longer delays take more than one lap.
+    static constexpr size_t SlotCount = 64;
+
+    // Class Description:
+    // - The thread the scheduler runs its entries on. The real implementation
+    //   wraps a CoreDispatcher and a DispatcherTimer; tests use a fake one.
+    class Dispatcher
+    {
+    public:
+        virtual ~Dispatcher() = default;
+
+        // Calls scheduler.Wake() on the dispatcher thread. May be called from any thread.
+        virtual void Post(const std::weak_ptr<ThrottledFuncScheduler>& scheduler) noexcept = 0;
+        // (Re)starts the timer, which calls scheduler.Tick() on the dispatcher thread
+        // every interval until StopTimer or StartTimer is called.
+        // Only ever called on the dispatcher thread, just like StopTimer and Now.
+        virtual void StartTimer(const std::weak_ptr<ThrottledFuncScheduler>& scheduler, duration interval) = 0;
+        virtual void StopTimer() = 0;
+        // The monotonic time the wheel is advanced by.
+        virtual time_point Now() const noexcept = 0;
+    };
+
+    class Entry;
+
+private:
+    // Struct Description:
+    // - The part of an Entry that the wheel links. It's allocated once per
+    //   entry and outlives it for as long as it's pending, so that an entry
+    //   can be destroyed at any time without unlinking it from the wheel.
+    struct Node
+    {
+        explicit Node(size_t delayTicks) noexcept :
+            delayTicks{ delayTicks }
+        {
+        }
+
+        const size_t delayTicks;
+        std::atomic<bool> pending{ false };
+        // Written by the thread that set pending, read once the node is due.
+        std::weak_ptr<Entry> entry;
+        // Set while pending. Doesn't allocate, as it's a copy of Entry::_node.
+        std::shared_ptr<Node> keepAlive;
+        // Link in either the incoming list or a wheel slot, never both at once.
+        Node* next{ nullptr };
+        size_t rounds{ 0 };
+    };
+
+public:
+    // Class Description:
+    // - A function scheduled by the ThrottledFuncScheduler. Entries must be
+    //   owned by a std::shared_ptr. A pending entry doesn't keep itself alive:
+    //   if it's destroyed before it's due, it just doesn't fire.
+    class Entry : public std::enable_shared_from_this<Entry>
+    {
+    public:
+        Entry(std::shared_ptr<ThrottledFuncScheduler> scheduler, duration delay) :
+            _scheduler{ std::move(scheduler) },
+            _node{ std::make_shared<Node>(_TicksFor(delay)) }
+        {
+        }
+
+        virtual ~Entry() = default;
+
+        Entry(const Entry&) = delete;
+        Entry& operator=(const Entry&) = delete;
+
+    protected:
+        // Method Description:
+        // - Schedules _Fire to be called after the delay, unless it's already pending.
+        // - This method is always thread-safe.
+        // Return Value:
+        // - true if the entry was scheduled, false if it was already pending.
+        bool _Schedule() noexcept
+        {
+            return _scheduler->_Schedule(*this);
+        }
+
+        // Called on the dispatcher thread. The pending flag is already cleared
+        // at this point, so _Fire may schedule the entry again.
+        virtual void _Fire() = 0;
+
+    private:
+        static size_t _TicksFor(const duration delay) noexcept
+        {
+            const auto ticks = (delay.count() + Resolution.count() - 1) / Resolution.count();
+            return gsl::narrow_cast<size_t>(std::max<duration::rep>(1, ticks));
+        }
+
+        std::shared_ptr<ThrottledFuncScheduler> _scheduler;
+        std::shared_ptr<Node> _node;
+
+        friend class ThrottledFuncScheduler;
+    };
+
+    explicit ThrottledFuncScheduler(std::unique_ptr<Dispatcher> dispatcher) noexcept :
+        _dispatcher{ std::move(dispatcher) }
+    {
+    }
+
+    // Every entry holds a strong reference to its scheduler, so by now all of
+    // them are gone and nobody can schedule anymore. If the dispatcher stopped
+    // running us, their nodes may still be pending, which keeps them alive.
+    ~ThrottledFuncScheduler()
+    {
+        _Release(_incoming.exchange(nullptr));
+        for (auto& head : _slots)
+        {
+            _Release(std::exchange(head, nullptr));
+        }
+    }
+
+    ThrottledFuncScheduler(const ThrottledFuncScheduler&) = delete;
+    ThrottledFuncScheduler& operator=(const ThrottledFuncScheduler&) = delete;
+
+    // Method Description:
+    // - Called by the dispatcher in response to Post. Moves newly scheduled
+    //   entries into the wheel and starts the timer if necessary.
+    // - Must be called on the dispatcher thread.
+    void Wake()
+    {
+        _Settle();
+    }
+
+    // Method Description:
+    // - Called by the dispatcher's timer. Advances the wheel by the slots that
+    //   passed since, runs all entries that became due and reprograms the timer
+    //   for the next occupied slot, or stops it once nothing is pending anymore.
+    // - Must be called on the dispatcher thread.
+    void Tick()
+    {
+        _Settle();
+    }
+
+    // Returns true if the timer driving the wheel is currently running.
+    // Only meaningful on the dispatcher thread.
+    bool IsTimerRunning() const noexcept
+    {
+        return _timerRunning;
+    }
+
+private:
+    // Method Description:
+    // - Marks the entry as pending and hands its node to the dispatcher thread.
+    // - This method is always thread-safe.
+    bool _Schedule(Entry& entry) noexcept
+    {
+        auto& node = *entry._node;
+        if (node.pending.exchange(true))
+        {
+            // already pending
+            return false;
+        }
+
+        // The node is ours until it's due, so nobody else touches these.
+        node.entry = entry.weak_from_this();
+        node.keepAlive = entry._node;
+
+        auto head = _incoming.load();
+        do
+        {
+            node.next = head;
+        } while (!_incoming.compare_exchange_weak(head, &node));
+
+        // Only the first entry after the scheduler went idle posts to the
+        // dispatcher. Everything else piggybacks on the running timer.
+        if (!_awake.exchange(true))
+        {
+            _dispatcher->Post(weak_from_this());
+        }
+        return true;
+    }
+
+    // Method Description:
+    // - Advances the wheel to the current time, running every entry in the
+    //   slots that it passes. Fractions of a slot are rounded to the nearest,
+    //   since the timer may fire a little early or late.
+    void _Advance()
+    {
+        const auto now = _dispatcher->Now();
+        auto steps = gsl::narrow_cast<size_t>(std::max<duration::rep>(0, (now - _currentTime + Resolution / 2) / Resolution));
+        if (steps >= SlotCount)
+        {
+            // We were blocked for a whole lap (or the system was asleep).
+            // Visiting every slot once runs everything that was due in it;
+            // entries with rounds left are merely late by up to a lap.
+            steps = SlotCount;
+            _currentTime = now;
+        }
+        else
+        {
+            _currentTime += steps * Resolution;
+        }
+
+        for (; steps != 0; --steps)
+        {
+            _current = (_current + 1) % SlotCount;
+            _RunSlot(_current);
+        }
+    }
+
+    void _RunSlot(const size_t slot)
+    {
+        auto node = std::exchange(til::at(_slots, slot), nullptr);
+        while (node)
+        {
+            const auto next = std::exchange(node->next, nullptr);
+
+            if (node->rounds != 0)
+            {
+                --node->rounds;
+                _Link(slot, *node);
+            }
+            else
+            {
+                --_scheduled;
+                // Runs that happen from here on (including from within _Fire)
+                // will schedule the entry anew. Everything we need from the
+                // node is moved out first, since _Schedule may set it again.
+                const auto keepAlive = std::move(node->keepAlive);
+                const auto entry = node->entry.lock();
+                node->pending.store(false);
+                if (entry)
+                {
+                    try
+                    {
+                        entry->_Fire();
+                    }
+                    CATCH_LOG();
+                }
+            }
+
+            node = next;
+        }
+    }
+
+    // Returns the number of slots until the next non-empty one (at most a lap).
+    size_t _TicksUntilNextSlot() const noexcept
+    {
+        for (size_t ticks = 1; ticks < SlotCount; ++ticks)
+        {
+            if (til::at(_slots, (_current + ticks) % SlotCount))
+            {
+                return ticks;
+            }
+        }
+        return SlotCount;
+    }
+
+    // Method Description:
+    // - Moves all entries from the incoming list into the wheel. Since we take
+    //   the entire list at once, the usual ABA problems of lock-free stacks
+    //   don't apply here.
+    void _Drain() noexcept
+    {
+        auto node = _incoming.exchange(nullptr);
+        while (node)
+        {
+            const auto next = std::exchange(node->next, nullptr);
+            const auto ticks = node->delayTicks;
+            node->rounds = (ticks - 1) / SlotCount;
+            _Link((_current + ticks) % SlotCount, *node);
+            ++_scheduled;
+            node = next;
+        }
+    }
+
+    void _Link(const size_t slot, Node& node) noexcept
+    {
+        auto& head = til::at(_slots, slot);
+        node.next = head;
+        head = &node;
+    }
+
+    // Drops the pending nodes of the given list, whose entries are gone.
+    static void _Release(Node* node) noexcept
+    {
+        while (node)
+        {
+            const auto next = std::exchange(node->next, nullptr);
+            node->keepAlive.reset();
+            node = next;
+        }
+    }
+
+    // Method Description:
+    // - Catches the wheel up with the time, then programs the timer to fire at
+    //   the next occupied slot, or stops it if nothing is pending.
+    // - While the timer ticks every Resolution, new entries piggyback on it.
+    //   Otherwise (idle, or only long delays pending) we clear _awake and check
+    //   the incoming list once more, so that the next _Schedule posts a Wake().
+    //   Together with _Schedule pushing before it tests _awake, this ensures
+    //   that an entry is never left waiting longer than its delay.
+    void _Settle()
+    {
+        // We drain below, so entries scheduled from here on (e.g. by _Fire) needn't post.
+        _awake.store(true);
+
+        for (;;)
+        {
+            if (_timerRunning)
+            {
+                _Advance();
+            }
+            else
+            {
+                _currentTime = _dispatcher->Now();
+            }
+
+            _Drain();
+
+            if (_scheduled != 0)
+            {
+                const auto ticks = _TicksUntilNextSlot();
+                if (!_timerRunning || ticks != _timerTicks)
+                {
+                    _dispatcher->StartTimer(weak_from_this(), ticks * Resolution);
+                    _timerRunning = true;
+                    _timerTicks = ticks;
+                }
+                if (ticks == 1)
+                {
+                    return;
+                }
+            }
+            else if (_timerRunning)
+            {
+                _dispatcher->StopTimer();
+                _timerRunning = false;
+            }
+
+            _awake.store(false);
+            if (!_incoming.load() || _awake.exchange(true))
+            {
+                // Either nothing's incoming, or whoever pushed it posted a Wake().
+                return;
+            }
+        }
+    }
+
+    std::unique_ptr<Dispatcher> _dispatcher;
+
+    // Touched by any thread.
+    std::atomic<Node*> _incoming{ nullptr };
+    std::atomic<bool> _awake{ false };
+
+    // Only touched on the dispatcher thread.
+    std::array<Node*, SlotCount> _slots{};
+    size_t _current{ 0 };
+    // The time at which the wheel arrived at _current.
+    time_point _currentTime{};
+    size_t _scheduled{ 0 };
+    size_t _timerTicks{ 0 };
+    bool _timerRunning{ false };
+};
@@ -371,6 +371,7 @@ void Terminal::UpdateSettings(ICoreSettings settings)
     _mutableViewport = Viewport::FromDimensions({ 0, proposedTop }, viewportSize);
 
     _buffer.swap(newTextBuffer);
+    _selectionRectCache.reset();
 
     // GH#3494: Maintain scrollbar position during resize
     // Make sure that we don't scroll past the mutableViewport at the bottom of the buffer
@@ -397,6 +398,8 @@ void Terminal::Write(std::wstring_view stringView)
 {
     auto lock = LockForWriting();
 
+    // The output may change the contents of the selected rows.
+    _selectionRectCache.reset();
     _stateMachine->ProcessString(stringView);
 }
 
@@ -447,6 +450,30 @@ bool Terminal::IsTrackingMouseInput() const noexcept
     return _terminalInput->IsTrackingMouseInput();
 }
 
+// Method Description:
+// - Makes SendMouseEvent hold back mouse motion reports until the next call to
+//   FlushPendingMouseMotion, keeping only the latest one. Only enable this if
+//   you're going to call FlushPendingMouseMotion regularly.
+// Arguments:
+// - enable: whether to coalesce mouse motion.
+// Return Value:
+// - <none>
+void Terminal::EnableMouseMotionCoalescing(const bool enable) noexcept
+{
+    _terminalInput->EnableMotionCoalescing(enable);
+}
+
+// Method Description:
+// - Sends the latest mouse motion report held back since the last flush, if any.
+// Arguments:
+// - <none>
+// Return Value:
+// - true if a motion report was sent.
+bool Terminal::FlushPendingMouseMotion()
+{
+    return _terminalInput->FlushPendingMouseMotion();
+}
+
 // Method Description:
 // - Given a coord, get the URI at that location
 // Arguments:
@@ -1183,9 +1210,24 @@ bool Terminal::IsCursorBlinkingAllowed() const noexcept
 //   region changes (for example by text entering the buffer or scrolling)
 void Terminal::UpdatePatterns() noexcept
 {
+    // Only copy the visible rows while holding the lock. Rows that didn't change
+    // since the last update are shared with the previous snapshot.
+    std::shared_ptr<const TextBufferSnapshot> snapshot;
+    std::unordered_map<size_t, std::wstring> patterns;
+    {
+        auto lock = LockForReading();
+        snapshot = _buffer->TakeSnapshot(_VisibleStartIndex(), _VisibleEndIndex(), _patternSnapshot.get());
+        patterns = _buffer->GetPatternRecognizers();
+    }
+
+    // Running the regular expressions is by far the most expensive part,
+    // so we do that without blocking the output thread.
+    auto newTree = snapshot->FindPatterns(patterns);
+
     auto lock = LockForWriting();
+    _patternSnapshot = std::move(snapshot);
     auto oldTree = _patternIntervalTree;
-    _patternIntervalTree = _buffer->GetPatterns(_VisibleStartIndex(), _VisibleEndIndex());
+    _patternIntervalTree = std::move(newTree);
     _InvalidatePatternTree(oldTree);
     _InvalidatePatternTree(_patternIntervalTree);
 }
@@ -6,6 +6,7 @@
 #include <conattrs.hpp>
 
 #include "../../buffer/out/textBuffer.hpp"
+#include "../../buffer/out/ClipboardExporter.hpp"
 #include "../../types/inc/sgrStack.hpp"
 #include "../../renderer/inc/BlinkingState.hpp"
 #include "../../terminal/parser/StateMachine.hpp"
@@ -143,6 +144,8 @@ public:
 
     void TrySnapOnInput() override;
     bool IsTrackingMouseInput() const noexcept;
+    void EnableMouseMotionCoalescing(const bool enable) noexcept;
+    bool FlushPendingMouseMotion();
 
     std::wstring GetHyperlinkAtPosition(const COORD position);
     uint16_t GetHyperlinkIdAtPosition(const COORD position);
@@ -228,6 +231,7 @@ public:
     void SetBlockSelection(const bool isEnabled) noexcept;
 
     const TextBuffer::TextAndColor RetrieveSelectedTextFromBuffer(bool trimTrailingWhitespace) const;
+    ClipboardExporter GetSelectionExporter(bool singleLine) const;
 #pragma endregion
 
 private:
@@ -281,6 +285,19 @@ private:
     };
     std::optional<SelectionAnchors> _selection;
     bool _blockSelection;
+
+    // The selection rects of the visible rows, as of the last time the
+    // renderer asked for them. rows has one slot per viewport row, but only the
+    // slots of selected rows are meaningful. See _GetVisibleSelectionRects.
+    struct SelectionRectCache
+    {
+        COORD start;
+        COORD end;
+        bool blockSelection;
+        SHORT top;
+        std::vector<SMALL_RECT> rows;
+    };
+    std::optional<SelectionRectCache> _selectionRectCache;
     std::wstring _wordDelimiters;
     SelectionExpansionMode _multiClickSelectionMode;
 #pragma endregion
@@ -310,6 +327,7 @@ private:
     //      Either way, we should make this behavior controlled by a setting.
 
     interval_tree::IntervalTree<til::point, size_t> _patternIntervalTree;
+    std::shared_ptr<const TextBufferSnapshot> _patternSnapshot;
     void _InvalidatePatternTree(interval_tree::IntervalTree<til::point, size_t>& tree);
     void _InvalidateFromCoords(const COORD start, const COORD end);
 
@@ -348,6 +366,7 @@ private:
 #pragma region TextSelection
     // These methods are defined in TerminalSelection.cpp
     std::vector<SMALL_RECT> _GetSelectionRects() const noexcept;
+    std::vector<SMALL_RECT> _GetVisibleSelectionRects() noexcept;
     std::pair<COORD, COORD> _PivotSelection(const COORD targetPos, bool& targetStart) const;
     std::pair<COORD, COORD> _ExpandSelectionAnchors(std::pair<COORD, COORD> anchors) const;
     COORD _ConvertToBufferCell(const COORD viewportPos) const;
@@ -60,6 +60,82 @@ std::vector<SMALL_RECT> Terminal::_GetSelectionRects() const noexcept
     return result;
 }
 
+// Method Description:
+// - Helper to determine the visible part of the selected region. Used for rendering.
+// - The rects are cached between calls. When the anchors move, only the rows
+//   between their old and new positions are recomputed, because every other
+//   row is either still fully selected or still not selected at all. That
+//   way dragging a selection across a huge scrollback costs at most
+//   O(viewport rows) per mouse move instead of O(selected rows).
+// Return Value:
+// - A vector of rectangles representing the visible regions to select, line by line. They are absolute coordinates relative to the buffer origin.
+std::vector<SMALL_RECT> Terminal::_GetVisibleSelectionRects() noexcept
+{
+    std::vector<SMALL_RECT> result;
+
+    if (!IsSelectionActive())
+    {
+        _selectionRectCache.reset();
+        return result;
+    }
+
+    try
+    {
+        const auto start = _selection->start;
+        const auto end = _selection->end;
+        const auto viewport = _GetVisibleViewport();
+        const auto top = viewport.Top();
+        const auto bottom = viewport.BottomInclusive();
+
+        const auto refresh = [&](const SHORT firstRow, const SHORT lastRow) {
+            for (const auto& rect : _buffer->GetTextRects(start, end, _blockSelection, false, std::max(firstRow, top), std::min(lastRow, bottom)))
+            {
+                til::at(_selectionRectCache->rows, rect.Top - top) = rect;
+            }
+        };
+
+        // A block selection's columns apply to every row,
+        // so moving an anchor horizontally invalidates all of them.
+        auto& cache = _selectionRectCache;
+        if (cache &&
+            cache->top == top &&
+            cache->rows.size() == gsl::narrow_cast<size_t>(viewport.Height()) &&
+            cache->blockSelection == _blockSelection &&
+            (!_blockSelection || (cache->start.X == start.X && cache->end.X == end.X)))
+        {
+            if (cache->start != start)
+            {
+                refresh(std::min(cache->start.Y, start.Y), std::max(cache->start.Y, start.Y));
+            }
+            if (cache->end != end)
+            {
+                refresh(std::min(cache->end.Y, end.Y), std::max(cache->end.Y, end.Y));
+            }
+            cache->start = start;
+            cache->end = end;
+        }
+        else
+        {
+            cache = SelectionRectCache{ start, end, _blockSelection, top, std::vector<SMALL_RECT>(viewport.Height()) };
+            refresh(top, bottom);
+        }
+
+        const auto firstRow = std::max(std::min(start.Y, end.Y), top);
+        const auto lastRow = std::min(std::max(start.Y, end.Y), bottom);
+        for (auto row = firstRow; row <= lastRow; ++row)
+        {
+            result.emplace_back(til::at(cache->rows, row - top));
+        }
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        _selectionRectCache.reset();
+        result.clear();
+    }
+    return result;
+}
+
 // Method Description:
 // - Get the current anchor position relative to the whole text buffer
 // Arguments:
@@ -266,6 +342,24 @@ const TextBuffer::TextAndColor Terminal::RetrieveSelectedTextFromBuffer(bool sin
                             _blockSelection);
 }
 
+// Method Description:
+// - Creates an exporter that streams the highlighted portion of the text
+//   buffer into the clipboard formats, without materializing per-cell colors.
+// Arguments:
+// - singleLine: collapse all of the text to one line
+// Return Value:
+// - an exporter over the current selection. It refers to the text buffer, so the
+//   caller must hold LockForReading() from creating it until it's done using it.
+ClipboardExporter Terminal::GetSelectionExporter(bool singleLine) const
+{
+    // See RetrieveSelectedTextFromBuffer for the formatting rules (GH#6740).
+    return ClipboardExporter{ *_buffer,
+                              _GetSelectionRects(),
+                              !singleLine || _blockSelection,
+                              !singleLine && !_blockSelection,
+                              _blockSelection };
+}
+
 // Method Description:
 // - convert viewport position to the corresponding location on the buffer
 // Arguments:
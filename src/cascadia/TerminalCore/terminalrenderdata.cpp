@@ -164,7 +164,7 @@ try
 {
     std::vector<Viewport> result;
 
-    for (const auto& lineRect : _GetSelectionRects())
+    for (const auto& lineRect : _GetVisibleSelectionRects())
     {
         result.emplace_back(Viewport::FromInclusive(lineRect));
     }
@@ -0,0 +1,152 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/headless/HeadlessEngine.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "consoletaeftemplates.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TerminalCoreUnitTests
+{
+    class HeadlessEngineTests;
+};
+using namespace TerminalCoreUnitTests;
+
+class TerminalCoreUnitTests::HeadlessEngineTests final
+{
+    TEST_CLASS(HeadlessEngineTests);
+
+    TEST_METHOD(RecordsPaintedText);
+    TEST_METHOD(SkipsFramesWithoutChanges);
+    TEST_METHOD(HashesFrames);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        term = std::make_unique<Terminal>();
+        engine = std::make_unique<HeadlessEngine>();
+        IRenderEngine* engines[]{ engine.get() };
+        renderer = std::make_unique<Renderer>(term.get(), engines, 1, nullptr);
+        term->Create({ 80, 25 }, 100, *renderer);
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        renderer = nullptr;
+        engine = nullptr;
+        term = nullptr;
+        return true;
+    }
+
+private:
+    std::wstring _RowText(const short row) const
+    {
+        const auto& frame = engine->GetLastFrame();
+
+        std::vector<const HeadlessFrame::Line*> lines;
+        for (const auto& line : frame.lines)
+        {
+            if (line.origin.Y == row)
+            {
+                lines.emplace_back(&line);
+            }
+        }
+        std::sort(lines.begin(), lines.end(), [](auto a, auto b) { return a->origin.X < b->origin.X; });
+
+        std::wstring text;
+        for (const auto line : lines)
+        {
+            text.append(frame.GetText(*line));
+        }
+        return text;
+    }
+
+    std::unique_ptr<Terminal> term;
+    std::unique_ptr<HeadlessEngine> engine;
+    std::unique_ptr<Renderer> renderer;
+};
+
+void HeadlessEngineTests::RecordsPaintedText()
+{
+    term->Write(L"Hello\x1b[31mWorld\x1b[m");
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+
+    const auto& frame = engine->GetLastFrame();
+    VERIFY_ARE_EQUAL(1u, engine->GetFrameCount());
+    VERIFY_ARE_EQUAL(1u, frame.number);
+    VERIFY_IS_FALSE(frame.dirty.empty());
+
+    const auto row = _RowText(0);
+    Log::Comment(NoThrowString().Format(L"Row 0: \"%s\"", row.c_str()));
+    VERIFY_ARE_EQUAL(0u, row.find(L"HelloWorld"));
+
+    Log::Comment(L"The red text must have been painted separately, in a different color.");
+    std::set<COLORREF> foregrounds;
+    for (const auto& line : frame.lines)
+    {
+        if (line.origin.Y == 0)
+        {
+            foregrounds.emplace(line.foreground);
+        }
+    }
+    VERIFY_IS_GREATER_THAN_OR_EQUAL(foregrounds.size(), 2u);
+
+    VERIFY_IS_TRUE(frame.cursor.has_value());
+    VERIFY_ARE_EQUAL((COORD{ 10, 0 }), frame.cursor->coordCursor);
+}
+
+void HeadlessEngineTests::SkipsFramesWithoutChanges()
+{
+    term->Write(L"Hello");
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    VERIFY_ARE_EQUAL(1u, engine->GetFrameCount());
+
+    Log::Comment(L"Nothing was invalidated, so there's nothing to paint.");
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    VERIFY_ARE_EQUAL(1u, engine->GetFrameCount());
+
+    Log::Comment(L"Only the changed part of the viewport is painted.");
+    term->Write(L"\r\n\r\nWorld");
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    VERIFY_ARE_EQUAL(2u, engine->GetFrameCount());
+
+    const auto& frame = engine->GetLastFrame();
+    for (const auto& rect : frame.dirty)
+    {
+        VERIFY_IS_LESS_THAN(rect.height(), 25);
+    }
+    VERIFY_ARE_EQUAL(0u, _RowText(2).find(L"World"));
+}
+
+void HeadlessEngineTests::HashesFrames()
+{
+    engine->SetHashing(true);
+
+    term->Write(L"\x1b[44mHello\x1b[m\r\nWorld");
+    renderer->TriggerRedrawAll();
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    const auto first = engine->GetLastFrame().hash;
+
+    Log::Comment(L"Painting the same contents again results in the same hash, even without recording.");
+    engine->SetRecording(false);
+    renderer->TriggerRedrawAll();
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    VERIFY_ARE_EQUAL(first, engine->GetLastFrame().hash);
+    VERIFY_IS_TRUE(engine->GetLastFrame().lines.empty());
+
+    Log::Comment(L"Different contents result in a different hash.");
+    term->Write(L"!");
+    renderer->TriggerRedrawAll();
+    VERIFY_SUCCEEDED(renderer->PaintFrame());
+    VERIFY_ARE_NOT_EQUAL(first, engine->GetLastFrame().hash);
+}
@@ -0,0 +1,148 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../../renderer/base/renderer.hpp"
+#include "../../renderer/headless/HeadlessEngine.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "consoletaeftemplates.hpp"
+#include "VtThroughputBenchmark.hpp"
+
+using namespace Microsoft::Terminal::Core;
+using namespace Microsoft::Console::Render;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TerminalCoreUnitTests
+{
+    class RendererBenchmarks;
+};
+using namespace TerminalCoreUnitTests;
+
+// Measures Renderer::PaintFrame for a Terminal, painting into a HeadlessEngine.
+// Like the ThroughputBenchmarks these only run with /runIgnoredTests.
+// /p:MinFPS=<n> and /p:MaxAllocationsPerFrame=<n> turn them into a regression gate.
+class TerminalCoreUnitTests::RendererBenchmarks final
+{
+    static constexpr SHORT ViewWidth = 120;
+    static constexpr SHORT ViewHeight = 30;
+    static constexpr size_t Frames = 2000;
+
+    BEGIN_TEST_CLASS(RendererBenchmarks)
+        TEST_CLASS_PROPERTY(L"Ignore", L"true")
+    END_TEST_CLASS()
+
+    TEST_METHOD(FullRedraw);
+    TEST_METHOD(Scroll);
+    TEST_METHOD(Selection);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        term = std::make_unique<Terminal>();
+        engine = std::make_unique<HeadlessEngine>();
+        IRenderEngine* engines[]{ engine.get() };
+        renderer = std::make_unique<Renderer>(term.get(), engines, 1, nullptr);
+        term->Create({ ViewWidth, ViewHeight }, 9001, *renderer);
+
+        // Start out with a screen full of colorful text.
+        // Each redraw of the TUI corpus ends with the cursor being shown again.
+        static constexpr std::wstring_view redrawEnd{ L"\x1b[?25h" };
+        const auto corpus = VtThroughputBenchmark::MakeCorpus(VtThroughputBenchmark::Corpus::TuiRedraw);
+        const auto end = corpus.find(redrawEnd);
+        VERIFY_ARE_NOT_EQUAL(std::wstring::npos, end);
+        term->Write(std::wstring_view{ corpus }.substr(0, end + redrawEnd.size()));
+        VERIFY_SUCCEEDED(renderer->PaintFrame());
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        renderer = nullptr;
+        engine = nullptr;
+        term = nullptr;
+        return true;
+    }
+
+private:
+    // Routine Description:
+    // - Calls prepare and paints a frame, Frames times, and reports
+    //   the frames per second and the allocations per frame.
+    template<typename T>
+    void _Measure(const std::wstring_view name, T&& prepare)
+    {
+        const auto framesBefore = engine->GetFrameCount();
+        std::optional<VtThroughputBenchmark::AllocationCounter> allocations{ std::in_place };
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < Frames; ++i)
+        {
+            prepare(i);
+            VERIFY_SUCCEEDED(renderer->PaintFrame());
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto allocationCount = allocations->Count();
+        allocations.reset();
+
+        const auto frames = engine->GetFrameCount() - framesBefore;
+        VERIFY_ARE_EQUAL(Frames, frames);
+
+        const auto fps = frames / std::chrono::duration<double>(end - start).count();
+        const auto allocationsPerFrame = static_cast<double>(allocationCount) / frames;
+        const auto allocationText = VtThroughputBenchmark::AllocationCounter::Available ? fmt::format(L"{:.2f}", allocationsPerFrame) : std::wstring{ L"(uncounted in release builds)" };
+        Log::Comment(NoThrowString().Format(L"%.*s: %.1f frames/s, %s allocations/frame",
+                                            gsl::narrow_cast<int>(name.size()),
+                                            name.data(),
+                                            fps,
+                                            allocationText.c_str()));
+
+        double gate = 0;
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MinFPS", gate)))
+        {
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(fps, gate);
+        }
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MaxAllocationsPerFrame", gate)))
+        {
+            VERIFY_IS_TRUE(VtThroughputBenchmark::AllocationCounter::Available, L"MaxAllocationsPerFrame requires a debug build");
+            VERIFY_IS_LESS_THAN_OR_EQUAL(allocationsPerFrame, gate);
+        }
+    }
+
+    std::unique_ptr<Terminal> term;
+    std::unique_ptr<HeadlessEngine> engine;
+    std::unique_ptr<Renderer> renderer;
+};
+
+void RendererBenchmarks::FullRedraw()
+{
+    _Measure(L"FullRedraw", [&](size_t) {
+        renderer->TriggerRedrawAll();
+    });
+}
+
+void RendererBenchmarks::Scroll()
+{
+    // Each line scrolls the viewport by one row, invalidating the row at the bottom.
+    std::wstring line;
+    _Measure(L"Scroll", [&](size_t i) {
+        line = fmt::format(L"\x1b[3{}mline {}\x1b[m\r\n", i % 8, i);
+        term->Write(line);
+    });
+}
+
+void RendererBenchmarks::Selection()
+{
+    // Drag a selection back and forth across the viewport, like a user would with the mouse.
+    const auto top = gsl::narrow<SHORT>(term->GetViewport().Top());
+    term->SetSelectionAnchor({ 10, top });
+    _Measure(L"Selection", [&](size_t i) {
+        const auto offset = gsl::narrow_cast<SHORT>(i % (2 * ViewHeight));
+        const auto row = gsl::narrow_cast<SHORT>(offset < ViewHeight ? offset : 2 * ViewHeight - 1 - offset);
+        term->SetSelectionEnd({ gsl::narrow_cast<SHORT>(i % ViewWidth), gsl::narrow_cast<SHORT>(top + row) });
+        renderer->TriggerSelection();
+    });
+}
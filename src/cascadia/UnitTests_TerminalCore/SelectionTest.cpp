@@ -383,6 +383,64 @@ namespace TerminalCoreUnitTests
             }
         }
 
+        TEST_METHOD(SelectAcrossScrollback)
+        {
+            Terminal term;
+            DummyRenderTarget emptyRT;
+            term.Create({ 20, 10 }, 1000, emptyRT);
+
+            // Push enough lines into the scrollback to scroll around in.
+            for (auto i = 0; i < 500; ++i)
+            {
+                term.Write(L"\r\n");
+            }
+
+            // Click on row 2 of the buffer, then scroll far down and drag there.
+            term.UserScrollViewport(0);
+            term.SetSelectionAnchor({ 3, 2 });
+            term.UserScrollViewport(300);
+            term.SetSelectionEnd({ 7, 5 });
+
+            Log::Comment(L"Only the visible rows of the selection should be returned");
+            auto viewport = term.GetViewport();
+            auto selectionRects = term.GetSelectionRects();
+            VERIFY_ARE_EQUAL(static_cast<size_t>(viewport.Height()), selectionRects.size());
+
+            SHORT rowValue = viewport.Top();
+            for (const auto& selectionRect : selectionRects)
+            {
+                VERIFY_ARE_EQUAL(SMALL_RECT({ 0, rowValue, viewport.RightInclusive(), rowValue }), selectionRect.ToInclusive());
+                rowValue++;
+            }
+
+            Log::Comment(L"Dragging around should keep the visible rows in sync with the anchors");
+            const COORD drags[] = { { 7, 9 }, { 2, 0 }, { 19, 4 }, { 0, 4 } };
+            for (const auto& drag : drags)
+            {
+                term.SetSelectionEnd(drag);
+
+                const auto expected = term.GetTextBuffer().GetTextRects(term.GetSelectionAnchor(),
+                                                                        term.GetSelectionEnd(),
+                                                                        false,
+                                                                        false,
+                                                                        viewport.Top(),
+                                                                        viewport.BottomInclusive());
+                selectionRects = term.GetSelectionRects();
+                VERIFY_ARE_EQUAL(expected.size(), selectionRects.size());
+                for (size_t i = 0; i < expected.size(); ++i)
+                {
+                    VERIFY_ARE_EQUAL(expected.at(i), selectionRects.at(i).ToInclusive());
+                }
+            }
+
+            Log::Comment(L"Scrolling the anchor row into view should include it again");
+            term.UserScrollViewport(0);
+            viewport = term.GetViewport();
+            selectionRects = term.GetSelectionRects();
+            VERIFY_ARE_EQUAL(static_cast<size_t>(8), selectionRects.size());
+            VERIFY_ARE_EQUAL(SMALL_RECT({ 3, 2, viewport.RightInclusive(), 2 }), selectionRects.at(0).ToInclusive());
+        }
+
         TEST_METHOD(SelectWideGlyph_Trailing)
         {
             Terminal term;
@@ -0,0 +1,315 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../TerminalControl/ThrottledFuncScheduler.h"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TerminalCoreUnitTests
+{
+    class ThrottledFuncSchedulerTests;
+};
+using namespace TerminalCoreUnitTests;
+
+namespace
+{
+    // Stands in for the CoreDispatcher. Nothing runs until the test calls
+    // RunPosted() or advances the fake clock itself, which makes the wheel
+    // fully deterministic.
+    struct FakeDispatcher final : ThrottledFuncScheduler::Dispatcher
+    {
+        struct State
+        {
+            size_t posts{ 0 };
+            size_t timerStarts{ 0 };
+            size_t timerTicks{ 0 };
+            bool timerRunning{ false };
+            ThrottledFuncScheduler::duration interval{};
+            ThrottledFuncScheduler::time_point deadline{};
+            ThrottledFuncScheduler::time_point now{};
+            std::weak_ptr<ThrottledFuncScheduler> posted;
+        };
+
+        explicit FakeDispatcher(State& state) noexcept :
+            _state{ state }
+        {
+        }
+
+        void Post(const std::weak_ptr<ThrottledFuncScheduler>& scheduler) noexcept override
+        {
+            ++_state.posts;
+            _state.posted = scheduler;
+        }
+
+        void StartTimer(const std::weak_ptr<ThrottledFuncScheduler>&, ThrottledFuncScheduler::duration interval) override
+        {
+            ++_state.timerStarts;
+            _state.timerRunning = true;
+            _state.interval = interval;
+            _state.deadline = _state.now + interval;
+        }
+
+        void StopTimer() override
+        {
+            _state.timerRunning = false;
+        }
+
+        ThrottledFuncScheduler::time_point Now() const noexcept override
+        {
+            return _state.now;
+        }
+
+    private:
+        State& _state;
+    };
+
+    struct CountingEntry final : ThrottledFuncScheduler::Entry
+    {
+        using Entry::Entry;
+
+        bool Run() noexcept
+        {
+            return _Schedule();
+        }
+
+        size_t calls{ 0 };
+        std::function<void()> onFire;
+
+    private:
+        void _Fire() override
+        {
+            ++calls;
+            if (onFire)
+            {
+                onFire();
+            }
+        }
+    };
+
+    constexpr auto Resolution = ThrottledFuncScheduler::Resolution;
+}
+
+class TerminalCoreUnitTests::ThrottledFuncSchedulerTests final
+{
+    TEST_CLASS(ThrottledFuncSchedulerTests);
+
+    TEST_METHOD(CoalescesRepeatedRuns);
+    TEST_METHOD(SharesOneTimerBetweenEntries);
+    TEST_METHOD(RunFromCallbackSchedulesAgain);
+    TEST_METHOD(LongDelaysTakeSeveralLaps);
+    TEST_METHOD(SleepsUntilTheNextOccupiedSlot);
+    TEST_METHOD(DestroyedEntriesDontFire);
+    TEST_METHOD(PendingEntriesDontKeepTheSchedulerAlive);
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        state = {};
+        scheduler = std::make_shared<ThrottledFuncScheduler>(std::make_unique<FakeDispatcher>(state));
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        scheduler = nullptr;
+        return true;
+    }
+
+private:
+    void _RunPosted()
+    {
+        if (const auto posted{ std::exchange(state.posted, {}).lock() })
+        {
+            posted->Wake();
+        }
+    }
+
+    // Advances the fake clock by count * Resolution, firing the timer on the way.
+    void _Tick(size_t count)
+    {
+        for (; count != 0; --count)
+        {
+            state.now += Resolution;
+            if (state.timerRunning && state.now >= state.deadline)
+            {
+                ++state.timerTicks;
+                state.deadline += state.interval;
+                scheduler->Tick();
+            }
+        }
+    }
+
+    FakeDispatcher::State state;
+    std::shared_ptr<ThrottledFuncScheduler> scheduler;
+};
+
+void ThrottledFuncSchedulerTests::CoalescesRepeatedRuns()
+{
+    const auto entry = std::make_shared<CountingEntry>(scheduler, 3 * Resolution);
+
+    VERIFY_IS_TRUE(entry->Run());
+    VERIFY_IS_FALSE(entry->Run());
+    VERIFY_IS_FALSE(entry->Run());
+    VERIFY_ARE_EQUAL(1u, state.posts);
+    VERIFY_IS_FALSE(state.timerRunning);
+
+    _RunPosted();
+    VERIFY_IS_TRUE(state.timerRunning);
+
+    _Tick(2);
+    VERIFY_ARE_EQUAL(0u, entry->calls);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, entry->calls);
+    VERIFY_IS_FALSE(state.timerRunning, L"The timer should stop once nothing is pending.");
+
+    Log::Comment(L"After firing, the next Run has to wake the scheduler again.");
+    VERIFY_IS_TRUE(entry->Run());
+    VERIFY_ARE_EQUAL(2u, state.posts);
+
+    _RunPosted();
+    _Tick(3);
+    VERIFY_ARE_EQUAL(2u, entry->calls);
+}
+
+void ThrottledFuncSchedulerTests::SharesOneTimerBetweenEntries()
+{
+    const auto fast = std::make_shared<CountingEntry>(scheduler, Resolution);
+    const auto medium = std::make_shared<CountingEntry>(scheduler, 2 * Resolution);
+    const auto slow = std::make_shared<CountingEntry>(scheduler, 4 * Resolution);
+
+    fast->Run();
+    slow->Run();
+    VERIFY_ARE_EQUAL(1u, state.posts, L"Only the first Run should post to the dispatcher.");
+
+    _RunPosted();
+    VERIFY_ARE_EQUAL(Resolution, state.interval);
+
+    Log::Comment(L"Running while the timer ticks every Resolution must not post again.");
+    medium->Run();
+    VERIFY_ARE_EQUAL(1u, state.posts);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, fast->calls);
+    VERIFY_ARE_EQUAL(0u, medium->calls);
+    VERIFY_ARE_EQUAL(0u, slow->calls);
+
+    _Tick(2);
+    VERIFY_ARE_EQUAL(1u, medium->calls);
+    VERIFY_ARE_EQUAL(0u, slow->calls);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, fast->calls);
+    VERIFY_ARE_EQUAL(1u, slow->calls);
+    VERIFY_IS_FALSE(state.timerRunning);
+    VERIFY_ARE_EQUAL(1u, state.posts);
+}
+
+void ThrottledFuncSchedulerTests::RunFromCallbackSchedulesAgain()
+{
+    const auto entry = std::make_shared<CountingEntry>(scheduler, 2 * Resolution);
+    entry->onFire = [&]() {
+        if (entry->calls < 3)
+        {
+            VERIFY_IS_TRUE(entry->Run());
+        }
+    };
+
+    entry->Run();
+    _RunPosted();
+    _Tick(6);
+    VERIFY_ARE_EQUAL(3u, entry->calls);
+    VERIFY_IS_FALSE(state.timerRunning);
+    VERIFY_ARE_EQUAL(1u, state.posts);
+}
+
+void ThrottledFuncSchedulerTests::LongDelaysTakeSeveralLaps()
+{
+    const auto laps = 2;
+    const auto ticks = laps * ThrottledFuncScheduler::SlotCount + 5;
+    const auto entry = std::make_shared<CountingEntry>(scheduler, ticks * Resolution);
+
+    entry->Run();
+    _RunPosted();
+    _Tick(ticks - 1);
+    VERIFY_ARE_EQUAL(0u, entry->calls);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, entry->calls);
+    VERIFY_IS_FALSE(state.timerRunning);
+    VERIFY_ARE_EQUAL(laps + 1u, state.timerTicks, L"The timer should only fire once per lap and once more when the entry is due.");
+}
+
+void ThrottledFuncSchedulerTests::SleepsUntilTheNextOccupiedSlot()
+{
+    const auto slow = std::make_shared<CountingEntry>(scheduler, std::chrono::milliseconds(500));
+    const auto fast = std::make_shared<CountingEntry>(scheduler, Resolution);
+
+    slow->Run();
+    _RunPosted();
+    VERIFY_ARE_EQUAL(63 * Resolution, state.interval);
+
+    _Tick(10);
+    VERIFY_ARE_EQUAL(0u, state.timerTicks);
+
+    Log::Comment(L"A short delay scheduled while the timer sleeps has to wake the scheduler up.");
+    VERIFY_IS_TRUE(fast->Run());
+    VERIFY_ARE_EQUAL(2u, state.posts);
+
+    _RunPosted();
+    VERIFY_ARE_EQUAL(Resolution, state.interval);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, fast->calls);
+    VERIFY_ARE_EQUAL(0u, slow->calls);
+    VERIFY_ARE_EQUAL(52 * Resolution, state.interval, L"The timer should go back to sleep until the slow entry is due.");
+
+    _Tick(51);
+    VERIFY_ARE_EQUAL(0u, slow->calls);
+
+    _Tick(1);
+    VERIFY_ARE_EQUAL(1u, slow->calls);
+    VERIFY_IS_FALSE(state.timerRunning);
+    VERIFY_ARE_EQUAL(2u, state.timerTicks);
+}
+
+void ThrottledFuncSchedulerTests::DestroyedEntriesDontFire()
+{
+    auto destroyed = std::make_shared<CountingEntry>(scheduler, Resolution);
+    const auto kept = std::make_shared<CountingEntry>(scheduler, Resolution);
+    auto fired = false;
+    destroyed->onFire = [&]() { fired = true; };
+
+    destroyed->Run();
+    kept->Run();
+    _RunPosted();
+
+    const std::weak_ptr<CountingEntry> weak{ destroyed };
+    destroyed = nullptr;
+    VERIFY_IS_TRUE(weak.expired(), L"A pending entry must not keep itself alive.");
+
+    _Tick(1);
+    VERIFY_IS_FALSE(fired);
+    VERIFY_ARE_EQUAL(1u, kept->calls);
+    VERIFY_IS_FALSE(state.timerRunning);
+}
+
+void ThrottledFuncSchedulerTests::PendingEntriesDontKeepTheSchedulerAlive()
+{
+    auto entry = std::make_shared<CountingEntry>(scheduler, Resolution);
+
+    Log::Comment(L"Schedule the entry, but never let the dispatcher run the scheduler.");
+    entry->Run();
+
+    const std::weak_ptr<ThrottledFuncScheduler> weak{ scheduler };
+    scheduler = nullptr;
+    VERIFY_IS_FALSE(weak.expired(), L"The entry still holds on to its scheduler.");
+
+    entry = nullptr;
+    VERIFY_IS_TRUE(weak.expired());
+    VERIFY_IS_TRUE(state.posted.expired());
+}
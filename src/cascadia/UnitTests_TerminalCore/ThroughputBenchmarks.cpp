@@ -0,0 +1,56 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "pch.h"
+#include <WexTestClass.h>
+
+#include "../renderer/inc/DummyRenderTarget.hpp"
+#include "../cascadia/TerminalCore/Terminal.hpp"
+#include "consoletaeftemplates.hpp"
+#include "VtThroughputBenchmark.hpp"
+
+using namespace Microsoft::Terminal::Core;
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace TerminalCoreUnitTests
+{
+    class ThroughputBenchmarks;
+};
+using namespace TerminalCoreUnitTests;
+
+// Feeds VT output through Terminal::Write (StateMachine and TerminalDispatch)
+// into a Terminal that renders into a DummyRenderTarget, taking the write
+// lock for each chunk just like TermControl does.
+// See VtThroughputBenchmark.hpp for how to run these.
+class TerminalCoreUnitTests::ThroughputBenchmarks final
+{
+    BEGIN_TEST_CLASS(ThroughputBenchmarks)
+        TEST_CLASS_PROPERTY(L"Ignore", L"true")
+    END_TEST_CLASS()
+
+    TEST_METHOD(WriteCorpus)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:corpus", L"{AsciiLog, CompilerOutput, CjkEmoji, TuiRedraw, Hyperlinks}")
+        END_TEST_METHOD_PROPERTIES();
+
+        String corpusName;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"corpus", corpusName));
+
+        const auto corpus = VtThroughputBenchmark::LoadCorpus(static_cast<const wchar_t*>(corpusName));
+
+        DummyRenderTarget emptyRT;
+        Terminal term;
+        term.Create({ 120, 30 }, 9001, emptyRT);
+
+        const auto result = VtThroughputBenchmark::Measure(corpus, 8, [&](const std::wstring_view chunk) {
+            auto lock = term.LockForWriting();
+            term.Write(chunk);
+        });
+
+        VtThroughputBenchmark::Report(static_cast<const wchar_t*>(corpusName), result);
+    }
+};
@@ -0,0 +1,129 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "ReadOnlyApiWorkers.hpp"
+
+#include "../server/IoSorter.h"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+namespace
+{
+    struct WorkItem
+    {
+        ReadOnlyApiWorkers* workers;
+        CONSOLE_API_MSG message;
+    };
+}
+
+ReadOnlyApiWorkers::ReadOnlyApiWorkers() noexcept :
+    _srwInFlight{},
+    _runningDown{ false }
+{
+    InitializeSRWLock(&_srwInFlight);
+}
+
+// Routine Description:
+// - Hands a read-only API message off to the thread pool, so it can be serviced
+//   in parallel with other such messages while the IO thread reads the next one.
+// - The caller is responsible for only passing messages that ApiSorter::IsReadOnlyRequest accepts.
+// Arguments:
+// - msg - The message just read from the driver. It's copied.
+// Return Value:
+// - True if the message was handed off and will be completed asynchronously.
+//   False if the caller must service it inline.
+bool ReadOnlyApiWorkers::TrySubmit(const CONSOLE_API_MSG& msg) noexcept
+{
+    if (_runningDown.load())
+    {
+        return false;
+    }
+
+    try
+    {
+        // The copy is serviced from scratch: ServiceIoOperation resets its state and
+        // points the reply payload at the copy's own packet.
+        auto item = std::make_unique<WorkItem>(WorkItem{ this, msg });
+        if (!TrySubmitThreadpoolCallback(s_ServiceIoOperation, item.get(), nullptr))
+        {
+            LOG_LAST_ERROR();
+            return false;
+        }
+        item.release();
+        return true;
+    }
+    CATCH_LOG();
+
+    return false;
+}
+
+// Routine Description:
+// - Stops servicing read-only messages and waits for the workers that are
+//   currently servicing or completing one. Workers that didn't get that far
+//   yet will drop their message instead. The process is about to exit, so
+//   their clients will be disconnected anyway.
+// - This doesn't wait for workers that are still blocked on the console lock,
+//   so it's safe to call while holding the console lock.
+void ReadOnlyApiWorkers::Rundown() noexcept
+{
+    _runningDown.store(true);
+    // Never released. Nothing may be serviced concurrently after a rundown.
+    AcquireSRWLockExclusive(&_srwInFlight);
+}
+
+bool ReadOnlyApiWorkers::IsRunningDown() const noexcept
+{
+    return _runningDown.load();
+}
+
+// Routine Description:
+// - Thread pool callback servicing a single read-only API message.
+// Arguments:
+// - context - The WorkItem made by TrySubmit. Owned by this routine.
+void CALLBACK ReadOnlyApiWorkers::s_ServiceIoOperation(PTP_CALLBACK_INSTANCE /*instance*/, PVOID context) noexcept
+{
+    const std::unique_ptr<WorkItem> item{ static_cast<WorkItem*>(context) };
+    item->workers->_ServiceIoOperation(item->message);
+}
+
+// Routine Description:
+// - Services a read-only API message under a shared console lock and completes it.
+// Arguments:
+// - message - The message to service.
+void ReadOnlyApiWorkers::_ServiceIoOperation(CONSOLE_API_MSG& message) noexcept
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    PCONSOLE_API_MSG replyMsg = nullptr;
+    {
+        gci.LockConsoleShared();
+        auto unlock = wil::scope_exit([&] { gci.UnlockConsoleShared(); });
+
+        // A rundown may have begun while we waited for the console lock.
+        // We only count as in flight once we've checked that it hasn't.
+        AcquireSRWLockShared(&_srwInFlight);
+        if (_runningDown.load())
+        {
+            ReleaseSRWLockShared(&_srwInFlight);
+            return;
+        }
+
+        IoSorter::ServiceIoOperation(&message, &replyMsg);
+    }
+
+    // Read-only APIs never pend, but be defensive about it rather than leaking the message.
+    if (replyMsg != nullptr)
+    {
+        LOG_IF_FAILED(replyMsg->ReleaseMessageBuffers());
+        LOG_IF_FAILED(replyMsg->_pDeviceComm->CompleteIo(&replyMsg->Complete));
+    }
+
+    ReleaseSRWLockShared(&_srwInFlight);
+}
@@ -0,0 +1,43 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- ReadOnlyApiWorkers.hpp
+
+Abstract:
+- Services read-only API messages on the thread pool under a shared console
+  lock, so that queries don't queue up behind each other on the IO thread.
+- Keeps track of the workers it submitted, so that a rundown can make sure
+  none of them touches the console state or the driver after it started.
+--*/
+
+#pragma once
+
+#include "../server/ApiMessage.h"
+
+namespace Microsoft::Console
+{
+    class ReadOnlyApiWorkers final
+    {
+    public:
+        ReadOnlyApiWorkers() noexcept;
+
+        ReadOnlyApiWorkers(const ReadOnlyApiWorkers&) = delete;
+        ReadOnlyApiWorkers& operator=(const ReadOnlyApiWorkers&) = delete;
+
+        bool TrySubmit(const CONSOLE_API_MSG& msg) noexcept;
+        void Rundown() noexcept;
+        bool IsRunningDown() const noexcept;
+
+    private:
+        static void CALLBACK s_ServiceIoOperation(PTP_CALLBACK_INSTANCE instance, PVOID context) noexcept;
+
+        void _ServiceIoOperation(CONSOLE_API_MSG& message) noexcept;
+
+        // Held shared by every worker from the moment it decided to service its
+        // message until that message was completed. Rundown() takes it exclusively.
+        SRWLOCK _srwInFlight;
+        std::atomic<bool> _runningDown;
+    };
+}
@@ -0,0 +1,241 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "WriteCoalescer.hpp"
+
+#include "_stream.h"
+#include "handle.h"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+WriteCoalescer::WriteCoalescer() noexcept :
+    _pending{},
+    _screenInfo{ nullptr },
+    _requiresVtQuirk{ false },
+    _hasPending{ false },
+    _flushStatus{ STATUS_SUCCESS },
+    _hFlushTimer{ nullptr },
+    _flushTimerArmed{ false }
+{
+}
+
+WriteCoalescer::~WriteCoalescer()
+{
+    if (_hFlushTimer != nullptr)
+    {
+        // Wait for a callback that may be in flight. It never blocks on the console lock, so this can't deadlock.
+        LOG_IF_WIN32_BOOL_FALSE(DeleteTimerQueueTimer(nullptr, _hFlushTimer, INVALID_HANDLE_VALUE));
+    }
+}
+
+// Routine Description:
+// - Holds back the given text instead of writing it right away, if it's eligible.
+// - NOTE: console lock must be held when calling this routine.
+// Arguments:
+// - screenInfo - the screen buffer the text is written to
+// - text - the text to write
+// - requiresVtQuirk - whether the write needs the legacy VT attribute quirk applied
+// Return Value:
+// - true if the text was taken and will be written later. false if the caller has to write it itself.
+bool WriteCoalescer::TryAppend(SCREEN_INFORMATION& screenInfo,
+                               const std::wstring_view text,
+                               const bool requiresVtQuirk) noexcept
+{
+    // While output is paused, writes have to be turned into waits by DoWriteConsole.
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (text.empty() || text.size() > MaxCoalescedWriteLength ||
+        WI_IsAnyFlagSet(gci.Flags, CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING) ||
+        WI_IsFlagClear(screenInfo.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING) ||
+        WI_IsFlagClear(screenInfo.OutputMode, ENABLE_PROCESSED_OUTPUT))
+    {
+        return false;
+    }
+
+    // Only runs of writes that could have been issued as a single one can be combined.
+    if (HasPending() && (_screenInfo != &screenInfo || _requiresVtQuirk != requiresVtQuirk))
+    {
+        Flush();
+    }
+
+    try
+    {
+        _pending.append(text);
+    }
+    catch (...)
+    {
+        LOG_CAUGHT_EXCEPTION();
+        return false;
+    }
+
+    if (!HasPending())
+    {
+        _screenInfo = &screenInfo;
+        _requiresVtQuirk = requiresVtQuirk;
+        _hasPending.store(true, std::memory_order_release);
+        _ArmFlushTimer();
+    }
+
+    // Without a timer nothing would process the text later, so we do it now.
+    if (_pending.size() >= FlushThreshold || !_flushTimerArmed)
+    {
+        Flush();
+    }
+
+    return true;
+}
+
+// Routine Description:
+// - Writes out any held back text, unless output is paused. In that case the text
+//   stays held back until UnblockWriteConsole resumes output and flushes it.
+// - Must be called before anything other than another write observes or changes the console state.
+void WriteCoalescer::Flush() noexcept
+{
+    if (!HasPending())
+    {
+        return;
+    }
+
+    LockConsole();
+    auto Unlock = wil::scope_exit([&] { UnlockConsole(); });
+
+    // Someone else may have flushed while we were waiting for the lock.
+    if (!HasPending())
+    {
+        return;
+    }
+
+    // There's no point in ticking until output is resumed.
+    _DisarmFlushTimer();
+
+    const auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    if (WI_IsAnyFlagSet(gci.Flags, CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING))
+    {
+        return;
+    }
+
+    // Swap the text out first, so that the buffer can be reused without
+    // being confused for new pending text, should the write re-enter us.
+    std::wstring text;
+    text.swap(_pending);
+    auto& screenInfo = *_screenInfo;
+    _screenInfo = nullptr;
+    _hasPending.store(false, std::memory_order_release);
+
+    size_t cbText = text.size() * sizeof(wchar_t);
+    const auto status = DoWriteConsoleImmediate(text.data(), &cbText, screenInfo, _requiresVtQuirk);
+    if (!NT_SUCCESS(status) && NT_SUCCESS(_flushStatus))
+    {
+        _flushStatus = status;
+    }
+
+    if (_pending.empty())
+    {
+        text.clear();
+        _pending.swap(text);
+    }
+}
+
+// Routine Description:
+// - Writes out any held back text before the given request is serviced, unless
+//   it's another write, which will either be appended or flush by itself.
+// Arguments:
+// - msg - the request that is about to be serviced
+void WriteCoalescer::FlushBefore(const CONSOLE_API_MSG& msg) noexcept
+{
+    if (!s_IsWriteRequest(msg))
+    {
+        Flush();
+    }
+}
+
+// Routine Description:
+// - Returns true if there is held back text that hasn't been written yet.
+bool WriteCoalescer::HasPending() const noexcept
+{
+    return _hasPending.load(std::memory_order_acquire);
+}
+
+// Routine Description:
+// - Returns the failure of a held back write that hasn't been reported yet and forgets it.
+// - NOTE: console lock must be held when calling this routine.
+// Return Value:
+// - STATUS_SUCCESS if all held back writes that were processed so far succeeded.
+//   Otherwise the status of the first one that failed.
+NTSTATUS WriteCoalescer::TakeFlushStatus() noexcept
+{
+    return std::exchange(_flushStatus, STATUS_SUCCESS);
+}
+
+// Routine Description:
+// - Determines whether the given request is a WriteConsole call.
+// - NOTE: raw writes are only given their API number by IoSorter when they're serviced,
+//   so they have to be identified by their IO function instead.
+// Arguments:
+// - msg - the request as it was read from the driver
+// Return Value:
+// - true if the request writes to the output buffer.
+bool WriteCoalescer::s_IsWriteRequest(const CONSOLE_API_MSG& msg) noexcept
+{
+    return msg.Descriptor.Function == CONSOLE_IO_RAW_WRITE ||
+           (msg.Descriptor.Function == CONSOLE_IO_USER_DEFINED && msg.msgHeader.ApiNumber == API_NUMBER_WRITECONSOLE);
+}
+
+void CALLBACK WriteCoalescer::s_FlushTimerRoutine(_In_ PVOID lpParam, _In_ BOOLEAN /*TimerOrWaitFired*/)
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    // Like the cursor blink timer, we must not block on the console lock here: the
+    // destructor waits for us while its caller may be holding it. The timer is
+    // periodic, so a tick that can't get the lock is simply retried on the next one.
+    if (gci.TryLockConsole())
+    {
+        static_cast<WriteCoalescer*>(lpParam)->Flush();
+        gci.UnlockConsole();
+    }
+}
+
+// Routine Description:
+// - Makes the flush timer tick every FlushDelay, creating it the first time around.
+// Return Value:
+// - true if the timer is ticking. TryAppend flushes right away if it isn't.
+bool WriteCoalescer::_ArmFlushTimer() noexcept
+{
+    if (_hFlushTimer == nullptr)
+    {
+        if (!CreateTimerQueueTimer(&_hFlushTimer, nullptr, s_FlushTimerRoutine, this, FlushDelay, FlushDelay, WT_EXECUTEDEFAULT))
+        {
+            LOG_LAST_ERROR();
+            _hFlushTimer = nullptr;
+            return false;
+        }
+        _flushTimerArmed = true;
+    }
+    else if (!_flushTimerArmed)
+    {
+        _flushTimerArmed = ChangeTimerQueueTimer(nullptr, _hFlushTimer, FlushDelay, FlushDelay) != FALSE;
+        LOG_LAST_ERROR_IF(!_flushTimerArmed);
+    }
+    return _flushTimerArmed;
+}
+
+// Routine Description:
+// - Stops the flush timer from ticking without deleting it, so that the next batch can reuse it.
+// - May be called from within the timer callback.
+void WriteCoalescer::_DisarmFlushTimer() noexcept
+{
+    if (_flushTimerArmed)
+    {
+        // Timer queue timers can't be paused. Instead we push the next tick out as far as
+        // possible (about 49 days). Should it ever come, it finds nothing to flush.
+        // The timer stays periodic, since expired one-shot timers can't be changed anymore.
+        LOG_IF_WIN32_BOOL_FALSE(ChangeTimerQueueTimer(nullptr, _hFlushTimer, INFINITE, INFINITE));
+        _flushTimerArmed = false;
+    }
+}
@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- WriteCoalescer.hpp
+
+Abstract:
+- Holds back small WriteConsole calls in VT mode so that runs of them are
+  pushed through the state machine in one go. Programs that print one
+  character at a time otherwise pay for a full parse, buffer update and
+  invalidation per character.
+- Held back text is processed when it grows past a threshold, shortly after
+  the first of it arrived, or whenever anything but another write needs to
+  observe the console (see FlushBefore()).
+- Held back text is never processed while output is paused (suspended,
+  selecting or scrollbar tracking). It goes out ahead of the resumed writes.
+- A held back write has already reported success to its client. If processing
+  it fails later on, the failure is reported to the next write instead.
+--*/
+
+#pragma once
+
+#include "../server/ApiMessage.h"
+
+class SCREEN_INFORMATION;
+
+namespace Microsoft::Console
+{
+    class WriteCoalescer final
+    {
+    public:
+        // Only writes of up to this many characters are held back.
+        static constexpr size_t MaxCoalescedWriteLength = 128;
+        // Held back text is processed once this many characters have accumulated...
+        static constexpr size_t FlushThreshold = 4096;
+        // ...or at the latest this many milliseconds after the first of them was held back.
+        static constexpr DWORD FlushDelay = 5;
+
+        WriteCoalescer() noexcept;
+        ~WriteCoalescer();
+
+        WriteCoalescer(const WriteCoalescer&) = delete;
+        WriteCoalescer& operator=(const WriteCoalescer&) = delete;
+
+        bool TryAppend(SCREEN_INFORMATION& screenInfo,
+                       const std::wstring_view text,
+                       const bool requiresVtQuirk) noexcept;
+        void Flush() noexcept;
+        void FlushBefore(const CONSOLE_API_MSG& msg) noexcept;
+        bool HasPending() const noexcept;
+        [[nodiscard]] NTSTATUS TakeFlushStatus() noexcept;
+
+        static bool s_IsWriteRequest(const CONSOLE_API_MSG& msg) noexcept;
+
+    private:
+        static void CALLBACK s_FlushTimerRoutine(_In_ PVOID lpParam, _In_ BOOLEAN TimerOrWaitFired);
+
+        bool _ArmFlushTimer() noexcept;
+        void _DisarmFlushTimer() noexcept;
+
+        std::wstring _pending;
+        SCREEN_INFORMATION* _screenInfo; // non-ownership pointer
+        bool _requiresVtQuirk;
+        // Read without holding the console lock by the IO thread, to decide whether it can skip flushing.
+        std::atomic<bool> _hasPending;
+        // The first failure of a held back write that hasn't been reported yet.
+        NTSTATUS _flushStatus;
+        // Created on first use and then re-armed for every batch. It's periodic,
+        // so that a tick that can't get the lock is retried.
+        HANDLE _hFlushTimer;
+        bool _flushTimerArmed;
+    };
+}
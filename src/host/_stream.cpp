@@ -1023,6 +1023,38 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
         return CONSOLE_STATUS_WAIT;
     }
 
+    // Anything held back by WriteConsoleWImplHelper so far has to go out ahead of this write.
+    // If that fails, this write fails with it, as the held back ones already reported success.
+    auto& coalescer = ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer();
+    coalescer.Flush();
+    if (const auto flushStatus = coalescer.TakeFlushStatus(); !NT_SUCCESS(flushStatus))
+    {
+        *pcbBuffer = 0;
+        return flushStatus;
+    }
+
+    return DoWriteConsoleImmediate(pwchBuffer, pcbBuffer, screenInfo, requiresVtQuirk);
+}
+
+// Routine Description:
+// - Inserts the given text into the given screen buffer right away, bypassing the
+//   checks for paused output and the write coalescer.
+// Note:
+// - Console lock must be held when calling this routine
+// - String has been translated to unicode at this point.
+// Arguments:
+// - pwchBuffer - wide character text to be inserted into buffer
+// - pcbBuffer - byte count of pwchBuffer on the way in, number of bytes consumed on the way out.
+// - screenInfo - Screen Information class to write the text into at the current cursor position
+// - requiresVtQuirk - whether the legacy VT attribute quirk applies to this text
+// Return Value:
+// - STATUS_SUCCESS if OK.
+// - Or a suitable NTSTATUS format error code for memory/string/math failures.
+[[nodiscard]] NTSTATUS DoWriteConsoleImmediate(_In_reads_bytes_(*pcbBuffer) PWCHAR pwchBuffer,
+                                               _Inout_ size_t* const pcbBuffer,
+                                               SCREEN_INFORMATION& screenInfo,
+                                               bool requiresVtQuirk)
+{
     auto restoreVtQuirk{
         wil::scope_exit([&]() { screenInfo.ResetIgnoreLegacyEquivalentVTAttributes(); })
     };
@@ -1074,6 +1106,19 @@ constexpr unsigned int LOCAL_BUFFER_SIZE = 100;
         read = 0;
         waiter.reset();
 
+        // Small writes are held back and processed together with the ones that follow.
+        // Held back writes report success right away, so if one of them failed
+        // since the last write, the failure is reported to this one instead.
+        auto& coalescer = ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer();
+        RETURN_IF_NTSTATUS_FAILED(coalescer.TakeFlushStatus());
+        if (coalescer.TryAppend(context, buffer, requiresVtQuirk))
+        {
+            // TryAppend may have processed our text right away.
+            RETURN_IF_NTSTATUS_FAILED(coalescer.TakeFlushStatus());
+            read = buffer.size();
+            return S_OK;
+        }
+
         // Convert characters to bytes to give to DoWriteConsole.
         size_t cbTextBufferLength;
         RETURN_IF_FAILED(SizeTMult(buffer.size(), sizeof(wchar_t), &cbTextBufferLength));
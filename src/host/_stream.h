@@ -95,3 +95,10 @@ Note:
                                       SCREEN_INFORMATION& screenInfo,
                                       bool requiresVtQuirk,
                                       std::unique_ptr<WriteData>& waiter);
+
+// NOTE: console lock must be held when calling this routine
+// Writes right away, without checking for paused output or holding the text back for coalescing.
+[[nodiscard]] NTSTATUS DoWriteConsoleImmediate(_In_reads_bytes_(*pcbBuffer) PWCHAR pwchBuffer,
+                                               _Inout_ size_t* const pcbBuffer,
+                                               SCREEN_INFORMATION& screenInfo,
+                                               bool requiresVtQuirk);
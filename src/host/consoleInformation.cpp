@@ -15,6 +15,11 @@ using Microsoft::Console::Interactivity::ServiceLocator;
 using Microsoft::Console::Render::BlinkingState;
 using Microsoft::Console::VirtualTerminal::VtIo;
 
+// Read-only API workers hold _srwConsoleLock shared instead of entering _csConsoleLock.
+// This counts how deep the current thread is into such a shared hold, so that the
+// LockConsole()/UnlockConsole() pairs further down the call chain are satisfied by it.
+static thread_local ULONG s_sharedLockDepth = 0;
+
 CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     // ProcessHandleList initializes itself
     pInputBuffer(nullptr),
@@ -40,11 +45,13 @@ CONSOLE_INFORMATION::CONSOLE_INFORMATION() :
     ConsoleIme{},
     _vtIo(),
     _blinker{},
+    _writeCoalescer{},
     renderData{}
 {
     ZeroMemory((void*)&CPInfo, sizeof(CPInfo));
     ZeroMemory((void*)&OutputCPInfo, sizeof(OutputCPInfo));
     InitializeCriticalSection(&_csConsoleLock);
+    InitializeSRWLock(&_srwConsoleLock);
 }
 
 CONSOLE_INFORMATION::~CONSOLE_INFORMATION()
@@ -56,27 +63,102 @@ bool CONSOLE_INFORMATION::IsConsoleLocked() const
 {
     // The critical section structure's OwningThread field contains the ThreadId despite having the HANDLE type.
     // This requires us to hard cast the ID to compare.
-    return _csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId();
+    return IsConsoleLockedShared() || _csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId();
+}
+
+// Routine Description:
+// - Returns true if the current thread holds the console lock for reading only.
+bool CONSOLE_INFORMATION::IsConsoleLockedShared() const noexcept
+{
+    return s_sharedLockDepth > 0;
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::LockConsole()
 {
+    if (IsConsoleLockedShared())
+    {
+        ++s_sharedLockDepth;
+        return;
+    }
+
     EnterCriticalSection(&_csConsoleLock);
+
+    // Only the outermost acquisition needs to wait for the shared holders to drain.
+    if (_csConsoleLock.RecursionCount == 1)
+    {
+        AcquireSRWLockExclusive(&_srwConsoleLock);
+    }
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 bool CONSOLE_INFORMATION::TryLockConsole()
 {
-    return !!TryEnterCriticalSection(&_csConsoleLock);
+    if (IsConsoleLockedShared())
+    {
+        ++s_sharedLockDepth;
+        return true;
+    }
+
+    if (!TryEnterCriticalSection(&_csConsoleLock))
+    {
+        return false;
+    }
+
+    if (_csConsoleLock.RecursionCount == 1 && !TryAcquireSRWLockExclusive(&_srwConsoleLock))
+    {
+        LeaveCriticalSection(&_csConsoleLock);
+        return false;
+    }
+
+    return true;
 }
 
 #pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
 void CONSOLE_INFORMATION::UnlockConsole()
 {
+    if (IsConsoleLockedShared())
+    {
+        --s_sharedLockDepth;
+        return;
+    }
+
+    if (_csConsoleLock.RecursionCount == 1)
+    {
+        ReleaseSRWLockExclusive(&_srwConsoleLock);
+    }
+
     LeaveCriticalSection(&_csConsoleLock);
 }
 
+// Routine Description:
+// - Acquires the console lock for reading only. Any number of threads may hold it
+//   this way at once, but never while another thread holds it exclusively.
+// - Only read-only API routines may run under a shared hold. Their nested
+//   LockConsole()/UnlockConsole() calls are absorbed by it.
+#pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::LockConsoleShared()
+{
+    // A thread that already owns the lock exclusively would deadlock against itself.
+    FAIL_FAST_IF(_csConsoleLock.OwningThread == (HANDLE)GetCurrentThreadId());
+
+    if (s_sharedLockDepth++ == 0)
+    {
+        AcquireSRWLockShared(&_srwConsoleLock);
+    }
+}
+
+#pragma prefast(suppress : 26135, "Adding lock annotation spills into entire project. Future work.")
+void CONSOLE_INFORMATION::UnlockConsoleShared()
+{
+    FAIL_FAST_IF(s_sharedLockDepth == 0);
+
+    if (--s_sharedLockDepth == 0)
+    {
+        ReleaseSRWLockShared(&_srwConsoleLock);
+    }
+}
+
 ULONG CONSOLE_INFORMATION::GetCSRecursionCount()
 {
     return _csConsoleLock.RecursionCount;
@@ -384,6 +466,17 @@ Microsoft::Console::CursorBlinker& CONSOLE_INFORMATION::GetCursorBlinker() noexc
     return _blinker;
 }
 
+// Method Description:
+// - return a reference to the console's write coalescer.
+// Arguments:
+// - <none>
+// Return Value:
+// - a reference to the console's write coalescer.
+Microsoft::Console::WriteCoalescer& CONSOLE_INFORMATION::GetWriteCoalescer() noexcept
+{
+    return _writeCoalescer;
+}
+
 // Method Description:
 // - return a reference to the console's blinking state.
 // Arguments:
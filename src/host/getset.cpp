@@ -14,6 +14,7 @@
 #include "cmdline.h"
 
 #include "../types/inc/convert.hpp"
+#include "../types/inc/GlyphWidth.hpp"
 #include "../types/inc/viewport.hpp"
 
 #include "ApiRoutines.h"
@@ -2191,8 +2192,17 @@ void DoSrvPrivateMoveToBottom(SCREEN_INFORMATION& screenInfo)
             fillAttrs.SetStandardErase();
         }
 
-        const auto fillData = OutputCellIterator{ fillChar, fillAttrs, fillLength };
-        screenInfo.Write(fillData, startPosition, false);
+        // Narrow characters (which covers every VT erase) can be filled in bulk,
+        // a row at a time. Wide ones still need to be laid out cell by cell.
+        if (!IsGlyphFullWidth(fillChar))
+        {
+            screenInfo.GetTextBuffer().Fill(startPosition, fillLength, fillChar, fillAttrs);
+        }
+        else
+        {
+            const auto fillData = OutputCellIterator{ fillChar, fillAttrs, fillLength };
+            screenInfo.Write(fillData, startPosition, false);
+        }
 
         // Notify accessibility
         auto endPosition = startPosition;
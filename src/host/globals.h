@@ -21,6 +21,7 @@ Revision History:
 #include "server.h"
 #include "ConsoleArguments.hpp"
 #include "ApiRoutines.h"
+#include "ReadOnlyApiWorkers.hpp"
 
 #include "../renderer/inc/IRenderData.hpp"
 #include "../renderer/inc/IRenderEngine.hpp"
@@ -70,6 +71,8 @@ public:
 
     ApiRoutines api;
 
+    Microsoft::Console::ReadOnlyApiWorkers readOnlyApiWorkers;
+
     bool handoffTarget = false;
 
     std::optional<CLSID> handoffConsoleClsid;
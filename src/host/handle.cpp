@@ -19,7 +19,8 @@ void LockConsole()
 void UnlockConsole()
 {
     CONSOLE_INFORMATION& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
-    if (gci.GetCSRecursionCount() == 1)
+    // Control events are only processed when the last exclusive hold is released.
+    if (!gci.IsConsoleLockedShared() && gci.GetCSRecursionCount() == 1)
     {
         ProcessCtrlEvents();
     }
@@ -93,22 +93,22 @@ static void _CopyRectangle(SCREEN_INFORMATION& screenInfo,
     }
 
     // 2. We can move any other scenario in-place without copying. We just have to carefully
-    //    choose which direction we walk through filling up the target so it doesn't accidentally
-    //    erase the source material before it can be copied/moved to the new location.
+    //    choose which direction we walk through the rows so we don't accidentally erase the
+    //    source material before it can be moved to the new location. Each row segment is then
+    //    moved in bulk; the row takes care of segments overlapping within the same row.
     {
-        const auto target = Viewport::FromDimensions(targetOrigin, source.Dimensions());
-        const auto walkDirection = Viewport::DetermineWalkDirection(source, target);
+        auto& textBuffer = screenInfo.GetTextBuffer();
+        const auto height = source.Height();
+        const auto walkUpwards = targetOrigin.Y > source.Top();
 
-        auto sourcePos = source.GetWalkOrigin(walkDirection);
-        auto targetPos = target.GetWalkOrigin(walkDirection);
-
-        do
+        for (auto i = 0; i < height; i++)
         {
-            const auto data = OutputCell(*screenInfo.GetCellDataAt(sourcePos));
-            screenInfo.Write(OutputCellIterator({ &data, 1 }), targetPos);
+            const auto offset = gsl::narrow_cast<SHORT>(walkUpwards ? height - 1 - i : i);
+            const auto& sourceRow = textBuffer.GetRowByOffset(source.Top() + offset);
+            auto& targetRow = textBuffer.GetRowByOffset(targetOrigin.Y + offset);
 
-            source.WalkInBounds(sourcePos, walkDirection);
-        } while (target.WalkInBounds(targetPos, walkDirection));
+            targetRow.CopySegment(sourceRow, source.Left(), targetOrigin.X, source.Width());
+        }
     }
 }
 
@@ -283,8 +283,13 @@ static void _ScrollScreen(SCREEN_INFORMATION& screenInfo, const Viewport& source
     // Get the render target and send it commands.
     // It will figure out whether or not we're active and where the messages need to go.
     auto& render = screenInfo.GetRenderTarget();
-    // Redraw anything in the target area
-    render.TriggerRedraw(target);
+    // Redraw anything in the target area. ROW::CopySegment blanks the other half of wide
+    // glyphs that the target's left and right edges cut through, so include those columns.
+    const auto bufferSize = screenInfo.GetBufferSize();
+    auto redraw = target.ToInclusive();
+    redraw.Left = std::max(bufferSize.Left(), gsl::narrow_cast<SHORT>(redraw.Left - 1));
+    redraw.Right = std::min(bufferSize.RightInclusive(), gsl::narrow_cast<SHORT>(redraw.Right + 1));
+    render.TriggerRedraw(Viewport::FromInclusive(redraw));
     // Also redraw anything that was filled.
     render.TriggerRedraw(fill);
 }
@@ -23,6 +23,7 @@ Revision History:
 #include "conimeinfo.h"
 #include "VtIo.hpp"
 #include "CursorBlinker.hpp"
+#include "WriteCoalescer.hpp"
 
 #include "../server/ProcessList.h"
 #include "../server/WaitQueue.h"
@@ -110,6 +111,10 @@ public:
     bool IsConsoleLocked() const;
     ULONG GetCSRecursionCount();
 
+    void LockConsoleShared();
+    void UnlockConsoleShared();
+    bool IsConsoleLockedShared() const noexcept;
+
     Microsoft::Console::VirtualTerminal::VtIo* GetVtIo();
 
     SCREEN_INFORMATION& GetActiveOutputBuffer() override;
@@ -143,6 +148,7 @@ public:
     friend class SCREEN_INFORMATION;
     friend class CommonState;
     Microsoft::Console::CursorBlinker& GetCursorBlinker() noexcept;
+    Microsoft::Console::WriteCoalescer& GetWriteCoalescer() noexcept;
     Microsoft::Console::Render::BlinkingState& GetBlinkingState() const noexcept;
 
     CHAR_INFO AsCharInfo(const OutputCellView& cell) const noexcept;
@@ -151,6 +157,7 @@ public:
 
 private:
     CRITICAL_SECTION _csConsoleLock; // serialize input and output using this
+    SRWLOCK _srwConsoleLock; // held exclusively along with _csConsoleLock, or shared by read-only API workers
     std::wstring _Title;
     std::wstring _Prefix; // Eg Select, Mark - things that we manually prepend to the title.
     std::wstring _TitleAndPrefix;
@@ -161,6 +168,7 @@ private:
 
     Microsoft::Console::VirtualTerminal::VtIo _vtIo;
     Microsoft::Console::CursorBlinker _blinker;
+    Microsoft::Console::WriteCoalescer _writeCoalescer;
     mutable Microsoft::Console::Render::BlinkingState _blinkingState;
 };
 
@@ -16,6 +16,7 @@
 
 #include "../server/Entrypoints.h"
 #include "../server/IoSorter.h"
+#include "../server/ApiSorter.h"
 
 #include "../interactivity/inc/ServiceLocator.hpp"
 #include "../interactivity/base/ApiDetector.hpp"
@@ -811,6 +812,31 @@ PWSTR TranslateConsoleTitle(_In_ PCWSTR pwszConsoleTitle, const BOOL fUnexpand,
     return Status;
 }
 
+// Routine Description:
+// - Hands read-only API messages off to the thread pool, so they can be serviced in parallel
+//   with each other while the IO thread goes on to read the next request.
+// - Messages that may mutate console state are left for the IO thread to service in order.
+// Arguments:
+// - msg - The message just read from the driver.
+// Return Value:
+// - True if the message was handed off and will be completed asynchronously.
+//   False if the caller must service it inline.
+static bool _TryServiceIoOperationConcurrently(const CONSOLE_API_MSG& msg) noexcept
+{
+    if (msg.Descriptor.Function != CONSOLE_IO_USER_DEFINED || !ApiSorter::IsReadOnlyRequest(&msg))
+    {
+        return false;
+    }
+
+    // Held back writes need the exclusive lock to be flushed, which is only done inline.
+    if (ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer().HasPending())
+    {
+        return false;
+    }
+
+    return ServiceLocator::LocateGlobals().readOnlyApiWorkers.TrySubmit(msg);
+}
+
 // Routine Description:
 // - This routine is the main one in the console server IO thread.
 // - It reads IO requests submitted by clients through the driver, services and completes them in a loop.
@@ -860,6 +886,16 @@ DWORD WINAPI ConsoleIoThread(LPVOID lpParameter)
             continue;
         }
 
+        if (_TryServiceIoOperationConcurrently(ReceiveMsg))
+        {
+            ReplyMsg = nullptr;
+            continue;
+        }
+
+        // Small writes may have been held back to be processed together.
+        // Everything but another write has to observe them first.
+        globals.getConsoleInformation().GetWriteCoalescer().FlushBefore(ReceiveMsg);
+
         IoSorter::ServiceIoOperation(&ReceiveMsg, &ReplyMsg);
     }
 
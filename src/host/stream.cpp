@@ -808,6 +808,8 @@ void UnblockWriteConsole(const DWORD dwReason)
     if (WI_AreAllFlagsClear(gci.Flags, (CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING)))
     {
         // There is no longer any reason to suspend output, so unblock it.
+        // Writes held back before output was paused go out ahead of the ones that had to wait.
+        gci.GetWriteCoalescer().Flush();
         gci.OutputQueue.NotifyWaiters(true);
     }
 }
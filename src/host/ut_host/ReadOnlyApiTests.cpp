@@ -0,0 +1,165 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "globals.h"
+#include "ReadOnlyApiWorkers.hpp"
+
+#include "../server/ApiSorter.h"
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class ReadOnlyApiTests
+{
+    TEST_CLASS(ReadOnlyApiTests);
+
+    TEST_METHOD(ClassifiesReadOnlyRequests);
+    TEST_METHOD(SharedHoldersDontExcludeEachOther);
+    TEST_METHOD(SharedHoldersExcludeExclusiveLock);
+    TEST_METHOD(NestedLocksAreAbsorbedBySharedHold);
+    TEST_METHOD(RundownStopsSubmissions);
+
+private:
+    static bool _IsReadOnly(const ULONG apiNumber)
+    {
+        CONSOLE_API_MSG msg{};
+        msg.msgHeader.ApiNumber = apiNumber;
+        return ApiSorter::IsReadOnlyRequest(&msg);
+    }
+
+    // Runs the given function on another thread and returns what it returned.
+    template<typename T>
+    static bool _OnOtherThread(T func)
+    {
+        bool result = false;
+        std::thread{ [&]() { result = func(); } }.join();
+        return result;
+    }
+};
+
+void ReadOnlyApiTests::ClassifiesReadOnlyRequests()
+{
+    Log::Comment(L"Queries are read-only.");
+    VERIFY_IS_TRUE(_IsReadOnly(0x01000001)); // GetConsoleMode
+    VERIFY_IS_TRUE(_IsReadOnly(0x02000005)); // GetConsoleCursorInfo
+    VERIFY_IS_TRUE(_IsReadOnly(0x02000007)); // GetConsoleScreenBufferInfo
+
+    Log::Comment(L"Setters and calls that can pend are not.");
+    VERIFY_IS_FALSE(_IsReadOnly(0x01000002)); // SetConsoleMode
+    VERIFY_IS_FALSE(_IsReadOnly(0x02000006)); // SetConsoleCursorInfo
+    VERIFY_IS_FALSE(_IsReadOnly(API_NUMBER_GETCONSOLEINPUT));
+    VERIFY_IS_FALSE(_IsReadOnly(API_NUMBER_READCONSOLE));
+    VERIFY_IS_FALSE(_IsReadOnly(API_NUMBER_WRITECONSOLE));
+
+    Log::Comment(L"GetConsoleWindow may create the pseudo window, so it's not read-only.");
+    VERIFY_IS_FALSE(_IsReadOnly(0x0300001F));
+
+    Log::Comment(L"Malformed API numbers are never read-only.");
+    VERIFY_IS_FALSE(_IsReadOnly(0x00000000));
+    VERIFY_IS_FALSE(_IsReadOnly(0x04000000));
+    VERIFY_IS_FALSE(_IsReadOnly(0x01FFFFFF));
+}
+
+void ReadOnlyApiTests::SharedHoldersDontExcludeEachOther()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    gci.LockConsoleShared();
+    auto unlock = wil::scope_exit([&] { gci.UnlockConsoleShared(); });
+
+    // Deadlocks if a second reader has to wait for the first.
+    const auto acquired = _OnOtherThread([&]() {
+        gci.LockConsoleShared();
+        const auto locked = gci.IsConsoleLocked();
+        gci.UnlockConsoleShared();
+        return locked;
+    });
+    VERIFY_IS_TRUE(acquired);
+}
+
+void ReadOnlyApiTests::SharedHoldersExcludeExclusiveLock()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    const auto tryLockElsewhere = [&]() {
+        return _OnOtherThread([&]() {
+            if (gci.TryLockConsole())
+            {
+                gci.UnlockConsole();
+                return true;
+            }
+            return false;
+        });
+    };
+
+    gci.LockConsoleShared();
+    VERIFY_IS_FALSE(tryLockElsewhere(), L"Writers must wait for readers.");
+    gci.UnlockConsoleShared();
+
+    VERIFY_IS_TRUE(tryLockElsewhere(), L"Writers get the lock once the readers are gone.");
+
+    Log::Comment(L"And readers must wait for writers.");
+    std::atomic<bool> acquired{ false };
+    gci.LockConsole();
+    std::thread reader{ [&]() {
+        gci.LockConsoleShared();
+        acquired.store(true);
+        gci.UnlockConsoleShared();
+    } };
+    Sleep(100);
+    VERIFY_IS_FALSE(acquired.load());
+    gci.UnlockConsole();
+    reader.join();
+    VERIFY_IS_TRUE(acquired.load());
+}
+
+void ReadOnlyApiTests::NestedLocksAreAbsorbedBySharedHold()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+    gci.LockConsoleShared();
+    VERIFY_IS_TRUE(gci.IsConsoleLockedShared());
+    VERIFY_IS_TRUE(gci.IsConsoleLocked());
+
+    Log::Comment(L"API routines lock the console themselves. That must not block under a shared hold.");
+    gci.LockConsole();
+    VERIFY_IS_TRUE(gci.TryLockConsole());
+    gci.UnlockConsole();
+    gci.UnlockConsole();
+    VERIFY_IS_TRUE(gci.IsConsoleLockedShared());
+
+    gci.UnlockConsoleShared();
+    VERIFY_IS_FALSE(gci.IsConsoleLockedShared());
+    VERIFY_IS_FALSE(gci.IsConsoleLocked());
+
+    Log::Comment(L"Once released, the exclusive lock is available again.");
+    VERIFY_IS_TRUE(_OnOtherThread([&]() {
+        if (gci.TryLockConsole())
+        {
+            gci.UnlockConsole();
+            return true;
+        }
+        return false;
+    }));
+}
+
+void ReadOnlyApiTests::RundownStopsSubmissions()
+{
+    ReadOnlyApiWorkers workers;
+    VERIFY_IS_FALSE(workers.IsRunningDown());
+
+    // Nothing is in flight, so this must not block.
+    workers.Rundown();
+    VERIFY_IS_TRUE(workers.IsRunningDown());
+
+    CONSOLE_API_MSG msg{};
+    msg.msgHeader.ApiNumber = 0x01000001; // GetConsoleMode
+    VERIFY_IS_FALSE(workers.TrySubmit(msg), L"Nothing may be serviced concurrently after a rundown.");
+}
@@ -168,6 +168,7 @@ class ScreenBufferTests
     TEST_METHOD(ScrollOperations);
     TEST_METHOD(InsertChars);
     TEST_METHOD(DeleteChars);
+    TEST_METHOD(DeleteCharsSplittingWideGlyph);
 
     TEST_METHOD(EraseScrollbackTests);
     TEST_METHOD(EraseTests);
@@ -213,6 +214,7 @@ class ScreenBufferTests
     TEST_METHOD(TestAddHyperlink);
     TEST_METHOD(TestAddHyperlinkCustomId);
     TEST_METHOD(TestAddHyperlinkCustomIdDifferentUri);
+    TEST_METHOD(TestHyperlinkSurvivesErasingItsText);
 
     TEST_METHOD(UpdateVirtualBottomWhenCursorMovesBelowIt);
     TEST_METHOD(RetainHorizontalOffsetWhenMovingToBottom);
@@ -3747,6 +3749,41 @@ void ScreenBufferTests::DeleteChars()
                    L"A whole line of spaces was inserted from the right, erasing the line.");
 }
 
+void ScreenBufferTests::DeleteCharsSplittingWideGlyph()
+{
+    auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer().GetActiveBuffer();
+    auto& stateMachine = si.GetStateMachine();
+    WI_SetFlag(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING);
+
+    Log::Comment(L"Write three wide glyphs at the start of a line, then delete a single "
+                 L"character from the middle of the first one. The rest of the line moves "
+                 L"left as whole glyphs and the orphaned leading half is blanked.");
+
+    const auto line = SHORT{ 10 };
+    stateMachine.ProcessString(L"\x1b[11;1H\x1b[K"
+                               L"\xff21\xff22\xff23");
+    stateMachine.ProcessString(L"\x1b[11;2H\x1b[P");
+
+    auto iter = si.GetTextBuffer().GetCellDataAt({ 0, line });
+    VERIFY_ARE_EQUAL(L" ", iter->Chars());
+    VERIFY_IS_TRUE(iter->DbcsAttr().IsSingle());
+    iter++;
+    VERIFY_ARE_EQUAL(L"\xff22", iter->Chars());
+    VERIFY_IS_TRUE(iter->DbcsAttr().IsLeading());
+    iter++;
+    VERIFY_ARE_EQUAL(L"\xff22", iter->Chars());
+    VERIFY_IS_TRUE(iter->DbcsAttr().IsTrailing());
+    iter++;
+    VERIFY_ARE_EQUAL(L"\xff23", iter->Chars());
+    VERIFY_IS_TRUE(iter->DbcsAttr().IsLeading());
+    iter++;
+    VERIFY_ARE_EQUAL(L"\xff23", iter->Chars());
+    VERIFY_IS_TRUE(iter->DbcsAttr().IsTrailing());
+    iter++;
+    VERIFY_ARE_EQUAL(L" ", iter->Chars());
+}
+
 void ScreenBufferTests::EraseScrollbackTests()
 {
     auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
@@ -5974,6 +6011,34 @@ void ScreenBufferTests::TestAddHyperlinkCustomIdDifferentUri()
     VERIFY_ARE_NOT_EQUAL(oldAttributes.GetHyperlinkId(), tbi.GetCurrentAttributes().GetHyperlinkId());
 }
 
+void ScreenBufferTests::TestHyperlinkSurvivesErasingItsText()
+{
+    auto& g = ServiceLocator::LocateGlobals();
+    auto& gci = g.getConsoleInformation();
+    auto& si = gci.GetActiveOutputBuffer();
+    auto& tbi = si.GetTextBuffer();
+    auto& stateMachine = si.GetStateMachine();
+
+    // Open a hyperlink and write some text with it
+    stateMachine.ProcessString(L"\x1b]8;;test.url\x1b\\abc");
+    const auto id = tbi.GetCurrentAttributes().GetHyperlinkId();
+
+    // Erasing the only line it was used on must not forget it while it's still open
+    stateMachine.ProcessString(L"\r\x1b[2K");
+    VERIFY_ARE_EQUAL(id, tbi.GetCurrentAttributes().GetHyperlinkId());
+    VERIFY_ARE_EQUAL(tbi.GetHyperlinkUriFromId(id), L"test.url");
+
+    // Text written afterwards is still part of the hyperlink
+    stateMachine.ProcessString(L"def");
+    VERIFY_ARE_EQUAL(id, tbi.GetCellDataAt({ 0, tbi.GetCursor().GetPosition().Y })->TextAttr().GetHyperlinkId());
+    VERIFY_ARE_EQUAL(tbi.GetHyperlinkUriFromId(id), L"test.url");
+
+    // Closing it leaves it alive for as long as that text is there
+    stateMachine.ProcessString(L"\x1b]8;;\x1b\\");
+    VERIFY_IS_FALSE(tbi.GetCurrentAttributes().IsHyperlink());
+    VERIFY_ARE_EQUAL(tbi.GetHyperlinkUriFromId(id), L"test.url");
+}
+
 void ScreenBufferTests::UpdateVirtualBottomWhenCursorMovesBelowIt()
 {
     auto& g = ServiceLocator::LocateGlobals();
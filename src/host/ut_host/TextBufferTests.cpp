@@ -10,6 +10,7 @@
 #include "globals.h"
 #include "../buffer/out/textBuffer.hpp"
 #include "../buffer/out/CharRow.hpp"
+#include "../buffer/out/ClipboardExporter.hpp"
 
 #include "input.h"
 #include "_stream.h"
@@ -156,6 +157,13 @@ class TextBufferTests
 
     TEST_METHOD(HyperlinkTrim);
     TEST_METHOD(NoHyperlinkTrim);
+    TEST_METHOD(HyperlinkRefCounts);
+
+    TEST_METHOD(FillWrapsAndCollapsesRuns);
+    TEST_METHOD(RowsAreMaterializedOnFirstWrite);
+
+    TEST_METHOD(SnapshotsShareUnchangedRows);
+    TEST_METHOD(ClipboardExporterMatchesGetText);
 };
 
 void TextBufferTests::TestBufferCreate()
@@ -1935,14 +1943,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeRowRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage().size(), L"There should be one item in the storage.");
 
     // Perform resize to trim off the row of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X, bufferSize.Y - 1 };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_ARE_EQUAL(0u, _buffer->GetUnicodeStorage().size(), L"The storage should now be empty.");
 }
 
 // This tests that columns removed from the buffer while resizing traditionally will also drop the high unicode
@@ -1970,14 +1978,14 @@ void TextBufferTests::ResizeTraditionalHighUnicodeColumnRemoval()
     const auto readBackText = *readBack;
     VERIFY_ARE_EQUAL(String(emoji), String(readBackText.data(), gsl::narrow<int>(readBackText.size())));
 
-    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage()._map.size(), L"There should be one item in the map.");
+    VERIFY_ARE_EQUAL(1u, _buffer->GetUnicodeStorage().size(), L"There should be one item in the storage.");
 
     // Perform resize to trim off the column of the buffer that included the emoji
     COORD trimmedBufferSize{ bufferSize.X - 1, bufferSize.Y };
 
     VERIFY_NT_SUCCESS(_buffer->ResizeTraditional(trimmedBufferSize));
 
-    VERIFY_IS_TRUE(_buffer->GetUnicodeStorage()._map.empty(), L"The map should now be empty.");
+    VERIFY_ARE_EQUAL(0u, _buffer->GetUnicodeStorage().size(), L"The storage should now be empty.");
 }
 
 void TextBufferTests::TestBurrito()
@@ -2616,14 +2624,17 @@ void TextBufferTests::HyperlinkTrim()
     const auto finalCustomId = fmt::format(L"{}%{}", customId, std::hash<std::wstring_view>{}(url));
     const auto finalOtherCustomId = fmt::format(L"{}%{}", otherCustomId, std::hash<std::wstring_view>{}(otherUrl));
 
+    const auto& uris = _buffer->GetHyperlinkTable().GetUris();
+    const auto& customIds = _buffer->GetHyperlinkTable().GetCustomIds();
+
     // The hyperlink reference that was only in the first row should be deleted from the map
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap.find(id), _buffer->_hyperlinkMap.end());
+    VERIFY_ARE_EQUAL(uris.find(id), uris.end());
     // Since there was a custom id, that should be deleted as well
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap.find(finalCustomId), _buffer->_hyperlinkCustomIdMap.end());
+    VERIFY_ARE_EQUAL(customIds.find(finalCustomId), customIds.end());
 
     // The other hyperlink reference should not be deleted
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkMap[otherId], otherUrl);
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalOtherCustomId], otherId);
+    VERIFY_ARE_EQUAL(uris.at(otherId), otherUrl);
+    VERIFY_ARE_EQUAL(customIds.at(finalOtherCustomId), otherId);
 }
 
 // This tests that when we increment the circular buffer, non-obsolete hyperlink references
@@ -2658,5 +2669,210 @@ void TextBufferTests::NoHyperlinkTrim()
 
     // The hyperlink reference should not be deleted from the map since it is still present in the buffer
     VERIFY_ARE_EQUAL(_buffer->GetHyperlinkUriFromId(id), url);
-    VERIFY_ARE_EQUAL(_buffer->_hyperlinkCustomIdMap[finalCustomId], id);
+    VERIFY_ARE_EQUAL(_buffer->GetHyperlinkTable().GetCustomIds().at(finalCustomId), id);
+}
+
+// This tests that a hyperlink is counted once per row that uses it,
+// and that it's removed as soon as the last row using it is overwritten.
+void TextBufferTests::HyperlinkRefCounts()
+{
+    const COORD bufferSize{ 80, 10 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const auto& hyperlinks = _buffer->GetHyperlinkTable();
+
+    const auto url = L"test.url";
+    const auto id = _buffer->GetHyperlinkId(url, L"");
+    _buffer->AddHyperlinkToMap(url, id);
+    TextAttribute linkAttr{ 0x7f };
+    linkAttr.SetHyperlinkId(id);
+
+    Log::Comment(L"Two runs in the same row only count once.");
+    auto& row = _buffer->GetRowByOffset(2).GetAttrRow();
+    VERIFY_IS_TRUE(row.SetAttrToEnd(10, linkAttr));
+    VERIFY_IS_TRUE(row.SetAttrToEnd(20, attr));
+    VERIFY_IS_TRUE(row.SetAttrToEnd(30, linkAttr));
+    VERIFY_ARE_EQUAL(1u, hyperlinks.GetRefCount(id));
+
+    Log::Comment(L"Each row using the hyperlink holds a reference.");
+    auto& otherRow = _buffer->GetRowByOffset(7).GetAttrRow();
+    VERIFY_IS_TRUE(otherRow.SetAttrToEnd(0, linkAttr));
+    VERIFY_ARE_EQUAL(2u, hyperlinks.GetRefCount(id));
+
+    Log::Comment(L"Overwriting one of the rows keeps the hyperlink alive.");
+    VERIFY_IS_TRUE(row.SetAttrToEnd(0, attr));
+    VERIFY_ARE_EQUAL(1u, hyperlinks.GetRefCount(id));
+    VERIFY_ARE_EQUAL(url, _buffer->GetHyperlinkUriFromId(id));
+
+    Log::Comment(L"While the hyperlink is still being written with, losing the last row keeps it.");
+    _buffer->SetCurrentAttributes(linkAttr);
+    VERIFY_IS_TRUE(otherRow.SetAttrToEnd(0, attr));
+    VERIFY_ARE_EQUAL(0u, hyperlinks.GetRefCount(id));
+    VERIFY_ARE_EQUAL(url, _buffer->GetHyperlinkUriFromId(id));
+
+    Log::Comment(L"Once it's closed, it's removed without any scrolling.");
+    _buffer->SetCurrentAttributes(attr);
+    VERIFY_ARE_EQUAL(hyperlinks.GetUris().end(), hyperlinks.GetUris().find(id));
+
+    Log::Comment(L"A hyperlink that isn't current is removed as soon as its last row lets go.");
+    const auto otherId = _buffer->GetHyperlinkId(url, L"");
+    _buffer->AddHyperlinkToMap(url, otherId);
+    TextAttribute otherLinkAttr{ 0x7f };
+    otherLinkAttr.SetHyperlinkId(otherId);
+    VERIFY_IS_TRUE(row.SetAttrToEnd(0, otherLinkAttr));
+    VERIFY_IS_TRUE(row.SetAttrToEnd(0, attr));
+    VERIFY_ARE_EQUAL(hyperlinks.GetUris().end(), hyperlinks.GetUris().find(otherId));
+}
+
+// This tests that a linear fill wraps across rows, leaves the cells around it alone,
+// and leaves just one attribute run behind in each row that it covers entirely.
+void TextBufferTests::FillWrapsAndCollapsesRuns()
+{
+    const COORD bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    // Give every row a few different attribute runs to start with.
+    for (SHORT y = 0; y < bufferSize.Y; y++)
+    {
+        const auto text = L"ABCDEFGHIJ";
+        _buffer->Write(OutputCellIterator{ text, TextAttribute{ 0x1e } }, { 0, y }, false);
+        _buffer->GetRowByOffset(y).GetAttrRow().SetAttrToEnd(5, TextAttribute{ 0x2f });
+    }
+
+    // Fill from the middle of row 1 to the middle of row 3.
+    const TextAttribute fillAttr{ 0x4c };
+    _buffer->Fill({ 7, 1 }, 3 + 10 + 4, L'x', fillAttr);
+
+    VERIFY_ARE_EQUAL(L"ABCDEFGHIJ", _buffer->GetRowByOffset(0).GetText());
+    VERIFY_ARE_EQUAL(L"ABCDEFGxxx", _buffer->GetRowByOffset(1).GetText());
+    VERIFY_ARE_EQUAL(L"xxxxxxxxxx", _buffer->GetRowByOffset(2).GetText());
+    VERIFY_ARE_EQUAL(L"xxxxEFGHIJ", _buffer->GetRowByOffset(3).GetText());
+    VERIFY_ARE_EQUAL(L"ABCDEFGHIJ", _buffer->GetRowByOffset(4).GetText());
+
+    VERIFY_ARE_EQUAL(1u, _buffer->GetRowByOffset(2).GetAttrRow().GetNumberOfRuns());
+    VERIFY_ARE_EQUAL(fillAttr, _buffer->GetRowByOffset(2).GetAttrRow().GetAttrByColumn(0));
+    VERIFY_ARE_EQUAL(fillAttr, _buffer->GetRowByOffset(1).GetAttrRow().GetAttrByColumn(7));
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x2f }, _buffer->GetRowByOffset(1).GetAttrRow().GetAttrByColumn(6));
+    VERIFY_ARE_EQUAL(fillAttr, _buffer->GetRowByOffset(3).GetAttrRow().GetAttrByColumn(3));
+    VERIFY_ARE_EQUAL(TextAttribute{ 0x1e }, _buffer->GetRowByOffset(3).GetAttrRow().GetAttrByColumn(4));
+}
+
+// This tests that rows don't allocate their cells until they're written to,
+// while still reading back as blank, and that resetting a row drops them again.
+void TextBufferTests::RowsAreMaterializedOnFirstWrite()
+{
+    const COORD bufferSize{ 80, 1000 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    for (SHORT y = 0; y < bufferSize.Y; y++)
+    {
+        VERIFY_IS_FALSE(_buffer->GetRowByOffset(y).GetCharRow().IsMaterialized());
+    }
+
+    const auto& blankRow = std::as_const(*_buffer).GetRowByOffset(500);
+    VERIFY_ARE_EQUAL(std::wstring(bufferSize.X, L' '), blankRow.GetText());
+    VERIFY_ARE_EQUAL(static_cast<size_t>(bufferSize.X), blankRow.GetCharRow().MeasureLeft());
+    VERIFY_ARE_EQUAL(0u, blankRow.GetCharRow().MeasureRight());
+    VERIFY_IS_TRUE(blankRow.GetCharRow().DbcsAttrAt(10).IsSingle());
+
+    const auto& blankCharRow = blankRow.GetCharRow();
+    VERIFY_ARE_EQUAL(static_cast<ptrdiff_t>(bufferSize.X), blankCharRow.cend() - blankCharRow.cbegin());
+    for (const auto& cell : blankCharRow)
+    {
+        VERIFY_IS_TRUE(cell == CharRowCell{});
+    }
+    VERIFY_IS_FALSE(blankRow.GetCharRow().IsMaterialized());
+
+    _buffer->Write(OutputCellIterator{ L"Hello" }, { 3, 500 });
+    VERIFY_IS_TRUE(_buffer->GetRowByOffset(500).GetCharRow().IsMaterialized());
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(499).GetCharRow().IsMaterialized());
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(501).GetCharRow().IsMaterialized());
+    VERIFY_ARE_EQUAL(8u, blankRow.GetCharRow().MeasureRight());
+
+    _buffer->GetRowByOffset(500).Reset(attr);
+    VERIFY_IS_FALSE(_buffer->GetRowByOffset(500).GetCharRow().IsMaterialized());
+    VERIFY_ARE_EQUAL(std::wstring(bufferSize.X, L' '), blankRow.GetText());
+}
+
+// This tests that a snapshot keeps the contents the buffer had when it was taken,
+// and that a later snapshot only copies the rows that were written to in between.
+void TextBufferTests::SnapshotsShareUnchangedRows()
+{
+    const COORD bufferSize{ 10, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    _buffer->Write(OutputCellIterator{ L"first" }, { 0, 0 });
+    _buffer->Write(OutputCellIterator{ L"second" }, { 0, 1 });
+
+    const auto first = _buffer->TakeSnapshot(0, 4);
+    VERIFY_ARE_EQUAL(5u, first->size());
+    VERIFY_ARE_EQUAL(L"first     ", first->GetRow(0).GetText());
+    VERIFY_ARE_EQUAL(L"second    ", first->GetRow(1).GetText());
+    // Rows are only ever shared with an earlier snapshot, even if they look alike.
+    VERIFY_ARE_EQUAL(0u, first->GetSharedRowCount());
+
+    _buffer->Write(OutputCellIterator{ L"changed" }, { 0, 1 });
+
+    const auto second = _buffer->TakeSnapshot(0, 4, first.get());
+    VERIFY_ARE_EQUAL(L"first     ", second->GetRow(0).GetText());
+    VERIFY_ARE_EQUAL(L"changed   ", second->GetRow(1).GetText());
+    VERIFY_ARE_EQUAL(L"second    ", first->GetRow(1).GetText());
+    VERIFY_ARE_EQUAL(&first->GetRow(0), &second->GetRow(0));
+    VERIFY_ARE_EQUAL(4u, second->GetSharedRowCount());
+
+    // Snapshots of another buffer never share rows with this one.
+    auto otherBuffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+    const auto other = otherBuffer->TakeSnapshot(0, 4, second.get());
+    VERIFY_ARE_EQUAL(L"          ", other->GetRow(0).GetText());
+    VERIFY_ARE_NOT_EQUAL(&second->GetRow(2), &other->GetRow(0));
+    VERIFY_ARE_EQUAL(0u, other->GetSharedRowCount());
+}
+
+// This tests that streaming the selection into the clipboard formats produces
+// exactly what the cell-by-cell GetText/GenHTML/GenRTF path produces.
+void TextBufferTests::ClipboardExporterMatchesGetText()
+{
+    const COORD bufferSize{ 12, 5 };
+    const UINT cursorSize = 12;
+    const TextAttribute attr{ 0x7f };
+    auto _buffer = std::make_unique<TextBuffer>(bufferSize, attr, cursorSize, _renderTarget);
+
+    _buffer->Write(OutputCellIterator{ L"a<b>&c", TextAttribute{ 0x1e } }, { 0, 0 });
+    _buffer->Write(OutputCellIterator{ L"{\\}", TextAttribute{ 0x2c } }, { 6, 0 });
+    _buffer->Write(OutputCellIterator{ L"\xFF21\xFF22 x  ", TextAttribute{ 0x4a } }, { 1, 1 });
+    _buffer->Write(OutputCellIterator{ L"wrapped", TextAttribute{ 0x1e } }, { 5, 3 });
+    _buffer->GetRowByOffset(3).SetWrapForced(true);
+
+    const auto getAttributeColors = [](const TextAttribute& textAttr) {
+        const auto legacy = textAttr.GetLegacyAttributes();
+        return std::pair<COLORREF, COLORREF>{ RGB(legacy & 0x0f, 0, 0), RGB(0, (legacy >> 4) & 0x0f, 0) };
+    };
+
+    for (const auto singleLine : { false, true })
+    {
+        // The block selection starts on the trailing half of the first wide glyph
+        // and covers a wrapped row as well as rows that were never written.
+        const auto textRects = _buffer->GetTextRects({ 2, 0 }, { 8, 4 }, true, false);
+
+        const auto expected = _buffer->GetText(!singleLine, !singleLine, textRects, getAttributeColors);
+        std::wstring expectedText;
+        for (const auto& text : expected.text)
+        {
+            expectedText += text;
+        }
+
+        const ClipboardExporter exporter{ *_buffer, textRects, !singleLine, !singleLine };
+        VERIFY_ARE_EQUAL(expectedText, exporter.GetText());
+        VERIFY_ARE_EQUAL(TextBuffer::GenHTML(expected, 12, L"Consolas", RGB(1, 2, 3)),
+                         exporter.GetHTML(getAttributeColors, 12, L"Consolas", RGB(1, 2, 3)));
+        VERIFY_ARE_EQUAL(TextBuffer::GenRTF(expected, 12, L"Consolas", RGB(1, 2, 3)),
+                         exporter.GetRTF(getAttributeColors, 12, L"Consolas", RGB(1, 2, 3)));
+    }
 }
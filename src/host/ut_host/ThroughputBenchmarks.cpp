@@ -0,0 +1,76 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+#include "VtThroughputBenchmark.hpp"
+
+#include "globals.h"
+#include "screenInfo.hpp"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console::Interactivity;
+
+// Feeds VT output through the host's StateMachine and AdaptDispatch into
+// the active screen buffer. There's no renderer in the unit test binary,
+// so all of the time is spent parsing and updating the TextBuffer.
+// See VtThroughputBenchmark.hpp for how to run these.
+class ThroughputBenchmarks
+{
+    CommonState* m_state;
+
+    BEGIN_TEST_CLASS(ThroughputBenchmarks)
+        TEST_CLASS_PROPERTY(L"Ignore", L"true")
+    END_TEST_CLASS()
+
+    TEST_CLASS_SETUP(ClassSetup)
+    {
+        m_state = new CommonState();
+
+        m_state->InitEvents();
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalScreenBuffer(120, 30, 120, 9001);
+        m_state->PrepareGlobalInputBuffer();
+
+        return true;
+    }
+
+    TEST_CLASS_CLEANUP(ClassCleanup)
+    {
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+        m_state->CleanupGlobalInputBuffer();
+
+        delete m_state;
+
+        return true;
+    }
+
+    TEST_METHOD(WriteCorpus)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:corpus", L"{AsciiLog, CompilerOutput, CjkEmoji, TuiRedraw, Hyperlinks}")
+        END_TEST_METHOD_PROPERTIES();
+
+        String corpusName;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"corpus", corpusName));
+
+        const auto corpus = VtThroughputBenchmark::LoadCorpus(static_cast<const wchar_t*>(corpusName));
+
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& stateMachine = gci.GetActiveOutputBuffer().GetStateMachine();
+
+        const auto result = VtThroughputBenchmark::Measure(corpus, 8, [&](const std::wstring_view chunk) {
+            stateMachine.ProcessString(chunk);
+        });
+
+        VtThroughputBenchmark::Report(static_cast<const wchar_t*>(corpusName), result);
+    }
+};
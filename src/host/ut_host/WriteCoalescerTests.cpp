@@ -0,0 +1,166 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "CommonState.hpp"
+
+#include "ApiRoutines.h"
+#include "stream.h"
+#include "WriteCoalescer.hpp"
+
+#include "../interactivity/inc/ServiceLocator.hpp"
+
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+using namespace Microsoft::Console;
+using Microsoft::Console::Interactivity::ServiceLocator;
+
+class WriteCoalescerTests
+{
+    TEST_CLASS(WriteCoalescerTests);
+
+    std::unique_ptr<CommonState> m_state;
+    DWORD _originalOutputMode;
+    COORD _origin;
+
+    TEST_METHOD_SETUP(MethodSetup)
+    {
+        m_state = std::make_unique<CommonState>();
+
+        m_state->PrepareGlobalFont();
+        m_state->PrepareGlobalScreenBuffer();
+
+        // Only VT mode writes are held back.
+        auto& si = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer();
+        _originalOutputMode = si.OutputMode;
+        WI_SetAllFlags(si.OutputMode, ENABLE_VIRTUAL_TERMINAL_PROCESSING | ENABLE_PROCESSED_OUTPUT);
+        _origin = si.GetTextBuffer().GetCursor().GetPosition();
+
+        // Keeps the flush timer from writing out pending text behind our back.
+        ServiceLocator::LocateGlobals().getConsoleInformation().LockConsole();
+
+        return true;
+    }
+
+    TEST_METHOD_CLEANUP(MethodCleanup)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+
+        // Nothing may be left pending for a screen buffer that's about to be deleted.
+        WI_ClearAllFlags(gci.Flags, CONSOLE_SUSPENDED | CONSOLE_SELECTING | CONSOLE_SCROLLBAR_TRACKING);
+        gci.GetWriteCoalescer().Flush();
+        gci.GetActiveOutputBuffer().OutputMode = _originalOutputMode;
+        gci.UnlockConsole();
+
+        m_state->CleanupGlobalScreenBuffer();
+        m_state->CleanupGlobalFont();
+
+        m_state.reset(nullptr);
+
+        return true;
+    }
+
+    // Writes the given text through WriteConsoleW.
+    static void _Write(const std::wstring_view text)
+    {
+        auto& si = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer();
+        ApiRoutines routines;
+        size_t read = 0;
+        std::unique_ptr<IWaitRoutine> waiter;
+        VERIFY_SUCCEEDED(routines.WriteConsoleWImpl(si, text, read, false, waiter));
+        VERIFY_IS_NULL(waiter.get());
+        VERIFY_ARE_EQUAL(text.size(), read);
+    }
+
+    // Returns the given number of characters from where the cursor was when the test started.
+    std::wstring _ReadBack(const size_t length) const
+    {
+        const auto& tbi = ServiceLocator::LocateGlobals().getConsoleInformation().GetActiveOutputBuffer().GetTextBuffer();
+        return tbi.GetRowByOffset(_origin.Y).GetText().substr(_origin.X, length);
+    }
+
+    static CONSOLE_API_MSG _MakeMessage(const ULONG function, const ULONG apiNumber)
+    {
+        CONSOLE_API_MSG msg{};
+        msg.Descriptor.Function = function;
+        msg.msgHeader.ApiNumber = apiNumber;
+        return msg;
+    }
+
+    TEST_METHOD(SmallWritesAreWrittenTogether)
+    {
+        auto& coalescer = ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer();
+
+        _Write(L"ab");
+        _Write(L"cd");
+
+        Log::Comment(L"Neither write may have reached the buffer yet.");
+        VERIFY_IS_TRUE(coalescer.HasPending());
+        VERIFY_ARE_EQUAL(std::wstring(L"    "), _ReadBack(4));
+
+        coalescer.Flush();
+
+        VERIFY_IS_FALSE(coalescer.HasPending());
+        VERIFY_ARE_EQUAL(std::wstring(L"abcd"), _ReadBack(4));
+    }
+
+    TEST_METHOD(QueriesFlushPendingWrites)
+    {
+        BEGIN_TEST_METHOD_PROPERTIES()
+            TEST_METHOD_PROPERTY(L"Data:apiNumber", L"{0x02000007, 0x01000005}") // GetConsoleScreenBufferInfo, ReadConsole
+        END_TEST_METHOD_PROPERTIES();
+
+        ULONG apiNumber;
+        VERIFY_SUCCEEDED(TestData::TryGetValue(L"apiNumber", apiNumber));
+
+        auto& coalescer = ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer();
+
+        _Write(L"ab");
+        VERIFY_IS_TRUE(coalescer.HasPending());
+
+        coalescer.FlushBefore(_MakeMessage(CONSOLE_IO_USER_DEFINED, apiNumber));
+
+        VERIFY_IS_FALSE(coalescer.HasPending());
+        VERIFY_ARE_EQUAL(std::wstring(L"ab"), _ReadBack(2));
+    }
+
+    TEST_METHOD(WritesDontFlushPendingWrites)
+    {
+        auto& coalescer = ServiceLocator::LocateGlobals().getConsoleInformation().GetWriteCoalescer();
+
+        _Write(L"ab");
+
+        Log::Comment(L"Raw writes don't have their API number assigned yet when the IO thread looks at them.");
+        coalescer.FlushBefore(_MakeMessage(CONSOLE_IO_RAW_WRITE, 0));
+        VERIFY_IS_TRUE(coalescer.HasPending());
+
+        coalescer.FlushBefore(_MakeMessage(CONSOLE_IO_USER_DEFINED, API_NUMBER_WRITECONSOLE));
+        VERIFY_IS_TRUE(coalescer.HasPending());
+
+        VERIFY_ARE_EQUAL(std::wstring(L"  "), _ReadBack(2));
+    }
+
+    TEST_METHOD(PausedOutputKeepsWritesPending)
+    {
+        auto& gci = ServiceLocator::LocateGlobals().getConsoleInformation();
+        auto& coalescer = gci.GetWriteCoalescer();
+
+        _Write(L"ab");
+
+        Log::Comment(L"Starting a selection pauses output, even for text that arrived before it.");
+        WI_SetFlag(gci.Flags, CONSOLE_SELECTING);
+        coalescer.FlushBefore(_MakeMessage(CONSOLE_IO_USER_DEFINED, 0x02000007)); // GetConsoleScreenBufferInfo
+
+        VERIFY_IS_TRUE(coalescer.HasPending());
+        VERIFY_ARE_EQUAL(std::wstring(L"  "), _ReadBack(2));
+
+        Log::Comment(L"Ending it writes the text out.");
+        UnblockWriteConsole(CONSOLE_SELECTING);
+
+        VERIFY_IS_FALSE(coalescer.HasPending());
+        VERIFY_ARE_EQUAL(std::wstring(L"ab"), _ReadBack(2));
+    }
+};
@@ -0,0 +1,435 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- VtThroughputBenchmark.hpp
+
+Abstract:
+- Shared pieces of the output throughput benchmarks of the console host and
+  the Terminal: a set of VT corpora modelled after typical recorded sessions,
+  and a harness that feeds a corpus to a write function in the same chunks
+  that ConptyConnection hands to the Terminal. It reports MB/s (of UTF-8 input),
+  heap allocations per MB and the 99th percentile latency of a single chunk.
+- Allocations are counted with a CRT allocation hook that is only installed
+  while a corpus is being measured. The hook only exists in the debug CRT, so
+  release builds report MB/s and latency only.
+- The benchmarks are marked "Ignore", so that they only run when asked for:
+    te.exe <binary> /name:*ThroughputBenchmarks* /runIgnoredTests
+  Optional runtime parameters turn them into a regression gate:
+    /p:MinMBps=<n> /p:MaxAllocationsPerMB=<n> /p:MaxP99Microseconds=<n>
+  /p:CorpusFile=<path> benchmarks a recorded UTF-8 VT stream instead.
+- Header-only so it can be included by multiple test binaries.
+
+--*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <crtdbg.h>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <sstream>
+
+namespace VtThroughputBenchmark
+{
+    // Counts the heap allocations made while it's alive, on any thread. Every
+    // operator new (array, nothrow and aligned ones included) ends up in the
+    // CRT heap, so they're all counted, as are malloc and realloc.
+    class AllocationCounter
+    {
+    public:
+        // Whether allocations can be counted at all in this build.
+#ifdef _DEBUG
+        static constexpr bool Available = true;
+#else
+        static constexpr bool Available = false;
+#endif
+
+        AllocationCounter() noexcept
+        {
+            s_allocations.store(0, std::memory_order_relaxed);
+            s_previousHook = _CrtSetAllocHook(&s_Hook);
+        }
+
+        ~AllocationCounter()
+        {
+            _CrtSetAllocHook(s_previousHook);
+        }
+
+        AllocationCounter(const AllocationCounter&) = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        size_t Count() const noexcept
+        {
+            return s_allocations.load(std::memory_order_relaxed);
+        }
+
+    private:
+        // Called by the debug CRT for every heap operation. It must not allocate.
+        static int __cdecl s_Hook(int allocType, void* userData, size_t size, int blockType, long requestNumber, const unsigned char* fileName, int lineNumber) noexcept
+        {
+            // _CRT_BLOCKs are the CRT's own bookkeeping, not something we asked for.
+            if ((allocType == _HOOK_ALLOC || allocType == _HOOK_REALLOC) && blockType != _CRT_BLOCK)
+            {
+                s_allocations.fetch_add(1, std::memory_order_relaxed);
+            }
+            return s_previousHook ? s_previousHook(allocType, userData, size, blockType, requestNumber, fileName, lineNumber) : TRUE;
+        }
+
+        static inline std::atomic<size_t> s_allocations{ 0 };
+        static inline _CRT_ALLOC_HOOK s_previousHook{ nullptr };
+    };
+
+    // ConptyConnection decodes at most this many characters per pipe read.
+    static constexpr size_t ChunkSize = 4096;
+
+    // Each corpus is generated until it's at least this long.
+    static constexpr size_t CorpusLength = 1024 * 1024;
+
+    enum class Corpus
+    {
+        AsciiLog,
+        CompilerOutput,
+        CjkEmoji,
+        TuiRedraw,
+        Hyperlinks
+    };
+
+    struct Result
+    {
+        size_t bytes;
+        double megabytesPerSecond;
+        std::optional<double> allocationsPerMegabyte; // empty unless AllocationCounter::Available
+        double p99ChunkMicroseconds;
+    };
+
+    // Routine Description:
+    // - Returns the number of bytes the given text occupies in UTF-8,
+    //   which is what we actually read from the pipe.
+    inline size_t Utf8Length(const std::wstring_view text) noexcept
+    {
+        size_t length = 0;
+        for (const auto ch : text)
+        {
+            if (ch < 0x80)
+            {
+                length += 1;
+            }
+            else if (ch < 0x800 || (ch >= 0xD800 && ch <= 0xDFFF))
+            {
+                // Each half of a surrogate pair accounts for half of its 4 bytes.
+                length += 2;
+            }
+            else
+            {
+                length += 3;
+            }
+        }
+        return length;
+    }
+
+    // Plain log output, like a build server or a tail -f of a service log.
+    inline std::wstring MakeAsciiLog(std::mt19937& rng)
+    {
+        static constexpr std::wstring_view levels[]{ L"INFO ", L"DEBUG", L"WARN ", L"TRACE" };
+        std::wstring text;
+        text.reserve(CorpusLength + 256);
+        for (size_t line = 0; text.size() < CorpusLength; ++line)
+        {
+            text.append(fmt::format(L"2021-03-{:02}T{:02}:{:02}:{:02}.{:03}Z {} [worker-{}] request {} completed in {}ms\r\n",
+                                    1 + line / 86400 % 28,
+                                    line / 3600 % 24,
+                                    line / 60 % 60,
+                                    line % 60,
+                                    rng() % 1000,
+                                    levels[rng() % std::size(levels)],
+                                    rng() % 32,
+                                    line,
+                                    rng() % 5000));
+        }
+        return text;
+    }
+
+    // Colored compiler diagnostics interleaved with progress lines.
+    inline std::wstring MakeCompilerOutput(std::mt19937& rng)
+    {
+        std::wstring text;
+        text.reserve(CorpusLength + 256);
+        for (size_t line = 0; text.size() < CorpusLength; ++line)
+        {
+            const auto file = rng() % 400;
+            switch (rng() % 4)
+            {
+            case 0:
+                text.append(fmt::format(L"\x1b[1msrc\\module{}\\file{}.cpp({},{}): \x1b[31merror\x1b[39m C2065: \x1b[0m'identifier{}': undeclared identifier\r\n",
+                                        file / 20,
+                                        file,
+                                        rng() % 2000,
+                                        rng() % 120,
+                                        rng() % 100));
+                break;
+            case 1:
+                text.append(fmt::format(L"\x1b[1msrc\\module{}\\file{}.cpp({},{}): \x1b[33mwarning\x1b[39m C4244: \x1b[0m'argument': conversion from 'size_t' to 'int', possible loss of data\r\n",
+                                        file / 20,
+                                        file,
+                                        rng() % 2000,
+                                        rng() % 120));
+                break;
+            case 2:
+                text.append(fmt::format(L"\x1b[38;5;{}m[{:3}/{}]\x1b[m Building CXX object src/module{}/CMakeFiles/module.dir/file{}.cpp.obj\r\n",
+                                        28 + rng() % 200,
+                                        line % 1000,
+                                        1000,
+                                        file / 20,
+                                        file));
+                break;
+            default:
+                text.append(fmt::format(L"\x1b[38;2;{};{};{}m  note: \x1b[0msee declaration of 'Namespace::Class{}::Method{}'\r\n",
+                                        rng() % 256,
+                                        rng() % 256,
+                                        rng() % 256,
+                                        rng() % 50,
+                                        rng() % 20));
+                break;
+            }
+        }
+        return text;
+    }
+
+    // Wide CJK text mixed with emoji (surrogate pairs) and some ASCII.
+    inline std::wstring MakeCjkEmoji(std::mt19937& rng)
+    {
+        static constexpr std::wstring_view words[]{
+            L"終端機", L"出力", L"テスト", L"文字化け", L"한국어", L"텍스트", L"中文", L"字符",
+            L"\U0001F600", L"\U0001F680", L"\U0001F44D\U0001F3FD", L"❤️", L"ok", L"done", L"=", L"->"
+        };
+        std::wstring text;
+        text.reserve(CorpusLength + 256);
+        while (text.size() < CorpusLength)
+        {
+            const auto count = 4 + rng() % 24;
+            for (size_t i = 0; i < count; ++i)
+            {
+                text.append(words[rng() % std::size(words)]);
+                text.push_back(L' ');
+            }
+            text.append(L"\r\n");
+        }
+        return text;
+    }
+
+    // Full screen redraws of a 120x30 TUI application, like htop or vim.
+    inline std::wstring MakeTuiRedraw(std::mt19937& rng)
+    {
+        std::wstring text;
+        text.reserve(CorpusLength + 16384);
+        while (text.size() < CorpusLength)
+        {
+            text.append(L"\x1b[?25l\x1b[H");
+            text.append(L"\x1b[44;97m┌");
+            text.append(118, L'─');
+            text.append(L"┐\x1b[m");
+            for (auto row = 2; row < 30; ++row)
+            {
+                text.append(fmt::format(L"\x1b[{};1H\x1b[44;97m│\x1b[m", row));
+                auto column = 1;
+                while (column < 110)
+                {
+                    const auto width = 4 + rng() % 16;
+                    text.append(fmt::format(L"\x1b[{};{}m", 30 + rng() % 8, 40 + rng() % 8));
+                    text.append(width, static_cast<wchar_t>(L'a' + rng() % 26));
+                    column += width;
+                }
+                text.append(L"\x1b[m\x1b[K");
+                text.append(fmt::format(L"\x1b[{};120H\x1b[44;97m│\x1b[m", row));
+            }
+            text.append(fmt::format(L"\x1b[30;1H\x1b[7m CPU {:3}%  MEM {:3}%  Tasks {} \x1b[m\x1b[K", rng() % 100, rng() % 100, rng() % 500));
+            text.append(L"\x1b[?25h");
+        }
+        return text;
+    }
+
+    // OSC 8 hyperlinks on most lines, like `ls --hyperlink` or compiler output with links.
+    inline std::wstring MakeHyperlinks(std::mt19937& rng)
+    {
+        std::wstring text;
+        text.reserve(CorpusLength + 256);
+        for (size_t line = 0; text.size() < CorpusLength; ++line)
+        {
+            const auto count = 1 + rng() % 4;
+            for (size_t i = 0; i < count; ++i)
+            {
+                const auto target = rng() % 10000;
+                text.append(fmt::format(L"\x1b]8;id={};file://host/home/user/project/file{}.txt\x1b\\\x1b[34mfile{}.txt\x1b[39m\x1b]8;;\x1b\\  ",
+                                        target,
+                                        target,
+                                        target));
+            }
+            text.append(L"\r\n");
+        }
+        return text;
+    }
+
+    // Routine Description:
+    // - Generates the given corpus. The generators are seeded with a constant,
+    //   so every run benchmarks exactly the same text.
+    inline std::wstring MakeCorpus(const Corpus corpus)
+    {
+        std::mt19937 rng{ 0x5eed };
+        switch (corpus)
+        {
+        case Corpus::AsciiLog:
+            return MakeAsciiLog(rng);
+        case Corpus::CompilerOutput:
+            return MakeCompilerOutput(rng);
+        case Corpus::CjkEmoji:
+            return MakeCjkEmoji(rng);
+        case Corpus::TuiRedraw:
+            return MakeTuiRedraw(rng);
+        case Corpus::Hyperlinks:
+            return MakeHyperlinks(rng);
+        default:
+            THROW_HR(E_INVALIDARG);
+        }
+    }
+
+    // Routine Description:
+    // - Returns the corpus with the given name, or the contents of the file passed
+    //   in the "CorpusFile" runtime parameter, if any. Recorded streams are expected
+    //   to be the raw UTF-8 output of an application, e.g. as captured by `script`.
+    inline std::wstring LoadCorpus(const std::wstring_view name)
+    {
+        WEX::Common::String path;
+        if (SUCCEEDED(WEX::TestExecution::RuntimeParameters::TryGetValue(L"CorpusFile", path)) && !path.IsEmpty())
+        {
+            std::ifstream file{ static_cast<const wchar_t*>(path), std::ios::binary };
+            THROW_HR_IF(E_INVALIDARG, !file);
+            std::stringstream bytes;
+            bytes << file.rdbuf();
+
+            std::wstring text;
+            THROW_IF_FAILED(til::u8u16(bytes.str(), text));
+            return text;
+        }
+
+        static constexpr std::pair<std::wstring_view, Corpus> corpora[]{
+            { L"AsciiLog", Corpus::AsciiLog },
+            { L"CompilerOutput", Corpus::CompilerOutput },
+            { L"CjkEmoji", Corpus::CjkEmoji },
+            { L"TuiRedraw", Corpus::TuiRedraw },
+            { L"Hyperlinks", Corpus::Hyperlinks },
+        };
+        for (const auto& [corpusName, corpus] : corpora)
+        {
+            if (corpusName == name)
+            {
+                return MakeCorpus(corpus);
+            }
+        }
+        THROW_HR(E_INVALIDARG);
+    }
+
+    // Routine Description:
+    // - Feeds the corpus to write, iterations times, in chunks of up to ChunkSize
+    //   characters and measures how long that takes.
+    // - The first iteration is a warm-up and isn't measured, so that the
+    //   results don't include growing the buffers of the write target.
+    // Arguments:
+    // - corpus - the text to write
+    // - iterations - how often to write it
+    // - write - called with each chunk
+    // Return Value:
+    // - the measurements
+    template<typename T>
+    Result Measure(const std::wstring_view corpus, const size_t iterations, T&& write)
+    {
+        std::vector<std::wstring_view> chunks;
+        for (size_t offset = 0; offset < corpus.size();)
+        {
+            auto length = std::min(ChunkSize, corpus.size() - offset);
+            // til::u8u16 never splits a surrogate pair between two chunks.
+            if (offset + length < corpus.size() && IS_HIGH_SURROGATE(corpus[offset + length - 1]))
+            {
+                --length;
+            }
+            chunks.emplace_back(corpus.substr(offset, length));
+            offset += length;
+        }
+
+        for (const auto chunk : chunks)
+        {
+            write(chunk);
+        }
+
+        std::vector<double> latencies;
+        latencies.reserve(chunks.size() * iterations);
+
+        const AllocationCounter allocations;
+        const auto start = std::chrono::steady_clock::now();
+
+        for (size_t i = 0; i < iterations; ++i)
+        {
+            for (const auto chunk : chunks)
+            {
+                const auto chunkStart = std::chrono::steady_clock::now();
+                write(chunk);
+                const auto chunkEnd = std::chrono::steady_clock::now();
+                latencies.emplace_back(std::chrono::duration<double, std::micro>(chunkEnd - chunkStart).count());
+            }
+        }
+
+        const auto end = std::chrono::steady_clock::now();
+        const auto allocationCount = allocations.Count();
+
+        std::sort(latencies.begin(), latencies.end());
+        const auto p99Index = std::max<size_t>(1, (latencies.size() * 99 + 99) / 100) - 1;
+
+        Result result{};
+        result.bytes = Utf8Length(corpus) * iterations;
+        const auto megabytes = result.bytes / (1024.0 * 1024.0);
+        result.megabytesPerSecond = megabytes / std::chrono::duration<double>(end - start).count();
+        if constexpr (AllocationCounter::Available)
+        {
+            result.allocationsPerMegabyte = allocationCount / megabytes;
+        }
+        result.p99ChunkMicroseconds = latencies.empty() ? 0.0 : latencies.at(p99Index);
+        return result;
+    }
+
+    // Routine Description:
+    // - Logs the result and verifies it against the gates passed as runtime parameters, if any.
+    inline void Report(const std::wstring_view name, const Result& result)
+    {
+        using namespace WEX::Logging;
+        using namespace WEX::TestExecution;
+
+        const auto allocations = result.allocationsPerMegabyte ? fmt::format(L"{:.1f}", *result.allocationsPerMegabyte) : std::wstring{ L"(uncounted in release builds)" };
+        Log::Comment(NoThrowString().Format(L"%.*s: %zu bytes, %.2f MB/s, %s allocations/MB, p99 chunk latency %.1f us",
+                                            gsl::narrow_cast<int>(name.size()),
+                                            name.data(),
+                                            result.bytes,
+                                            result.megabytesPerSecond,
+                                            allocations.c_str(),
+                                            result.p99ChunkMicroseconds));
+
+        double gate = 0;
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MinMBps", gate)))
+        {
+            VERIFY_IS_GREATER_THAN_OR_EQUAL(result.megabytesPerSecond, gate);
+        }
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MaxAllocationsPerMB", gate)))
+        {
+            // Don't let the gate pass just because nothing was counted.
+            VERIFY_IS_TRUE(result.allocationsPerMegabyte.has_value(), L"MaxAllocationsPerMB requires a debug build");
+            VERIFY_IS_LESS_THAN_OR_EQUAL(*result.allocationsPerMegabyte, gate);
+        }
+        if (SUCCEEDED(RuntimeParameters::TryGetValue(L"MaxP99Microseconds", gate)))
+        {
+            VERIFY_IS_LESS_THAN_OR_EQUAL(result.p99ChunkMicroseconds, gate);
+        }
+    }
+}
@@ -45,6 +45,10 @@ void ServiceLocator::RundownAndExit(const HRESULT hr)
         s_globals.pRender->TriggerTeardown();
     }
 
+    // Read-only API calls are serviced on the thread pool. Make sure none of
+    // them is still touching the console state or the driver while we exit.
+    s_globals.readOnlyApiWorkers.Rundown();
+
     // A History Lesson from MSFT: 13576341:
     // We introduced RundownAndExit to give services that hold onto important handles
     // an opportunity to let those go when we decide to exit from the console for various reasons.
@@ -1346,4 +1346,98 @@ class UiaTextRangeTests
             VERIFY_SUCCEEDED(utr->ScrollIntoView(alignToTop));
         }
     }
+
+    TEST_METHOD(GetTextAcrossChunks)
+    {
+        const auto bufferSize{ _pTextBuffer->GetSize() };
+        const COORD origin{ bufferSize.Origin() };
+
+        // GetText() produces the text in chunks of rows.
+        // Make sure that a range spanning several of them is stitched together correctly.
+        const SHORT lastRow = 150;
+        _pTextBuffer->Write({ L"Hello" }, origin);
+        _pTextBuffer->Write({ L"World" }, { 0, lastRow });
+
+        std::wstring expected;
+        for (SHORT row = 0; row <= lastRow; ++row)
+        {
+            std::wstring rowText(bufferSize.Width(), L' ');
+            if (row == 0)
+            {
+                rowText.replace(0, 5, L"Hello");
+            }
+            else if (row == lastRow)
+            {
+                rowText.replace(0, 5, L"World");
+            }
+
+            if (row != 0)
+            {
+                expected += L"\r\n";
+            }
+            expected += rowText;
+        }
+
+        Microsoft::WRL::ComPtr<UiaTextRange> utr;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&utr, _pUiaData, &_dummyProvider, origin, COORD{ 0, lastRow + 1 }));
+
+        Log::Comment(L"The whole text");
+        wil::unique_bstr text;
+        THROW_IF_FAILED(utr->GetText(-1, &text));
+        VERIFY_ARE_EQUAL(std::wstring_view{ expected }, std::wstring_view{ text.get() });
+
+        Log::Comment(L"Only the first few characters");
+        THROW_IF_FAILED(utr->GetText(7, &text));
+        VERIFY_ARE_EQUAL(L"Hello  ", std::wstring_view{ text.get() });
+
+        Log::Comment(L"Nothing at all");
+        THROW_IF_FAILED(utr->GetText(0, &text));
+        VERIFY_ARE_EQUAL(L"", std::wstring_view{ text.get() });
+    }
+
+    TEST_METHOD(FindText)
+    {
+        const auto bufferSize{ _pTextBuffer->GetSize() };
+        const COORD origin{ bufferSize.Origin() };
+        const auto lastColumn{ bufferSize.RightInclusive() };
+
+        _pTextBuffer->Write({ L"needle" }, { 10, 5 });
+        _pTextBuffer->Write({ L"Needle" }, { 20, 150 });
+        _pTextBuffer->Write({ L"wrapped" }, { gsl::narrow<SHORT>(lastColumn - 2), 200 });
+
+        Microsoft::WRL::ComPtr<UiaTextRange> utr;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&utr, _pUiaData, &_dummyProvider, origin, bufferSize.EndExclusive()));
+
+        const auto verifyFound = [&](UiaTextRange& range, std::wstring_view query, BOOL backward, BOOL ignoreCase, COORD start, COORD end) {
+            Log::Comment(NoThrowString().Format(L"Looking for \"%s\" (backward: %d, ignoreCase: %d)", query.data(), backward, ignoreCase));
+
+            const wil::unique_bstr bstr{ SysAllocStringLen(query.data(), gsl::narrow<UINT>(query.size())) };
+            Microsoft::WRL::ComPtr<ITextRangeProvider> found;
+            THROW_IF_FAILED(range.FindText(bstr.get(), backward, ignoreCase, &found));
+            VERIFY_IS_NOT_NULL(found.Get());
+
+            const auto& foundRange = static_cast<UiaTextRange&>(*found.Get());
+            VERIFY_ARE_EQUAL(start, foundRange._start);
+            VERIFY_ARE_EQUAL(end, foundRange._end);
+        };
+
+        verifyFound(*utr.Get(), L"needle", FALSE, FALSE, { 10, 5 }, { 16, 5 });
+        verifyFound(*utr.Get(), L"needle", TRUE, FALSE, { 10, 5 }, { 16, 5 });
+        verifyFound(*utr.Get(), L"needle", TRUE, TRUE, { 20, 150 }, { 26, 150 });
+
+        Log::Comment(L"Text that wraps onto the next row is found too");
+        verifyFound(*utr.Get(), L"wrapped", FALSE, FALSE, { gsl::narrow<SHORT>(lastColumn - 2), 200 }, { 4, 201 });
+
+        Log::Comment(L"Searching again reuses the index, but still sees changed rows");
+        _pTextBuffer->Write({ L"needle" }, { 0, 2 });
+        verifyFound(*utr.Get(), L"needle", FALSE, FALSE, { 0, 2 }, { 6, 2 });
+
+        Log::Comment(L"Only the text within the range is searched");
+        Microsoft::WRL::ComPtr<UiaTextRange> partial;
+        THROW_IF_FAILED(Microsoft::WRL::MakeAndInitialize<UiaTextRange>(&partial, _pUiaData, &_dummyProvider, COORD{ 11, 5 }, COORD{ 0, 150 }));
+        const wil::unique_bstr needle{ SysAllocString(L"needle") };
+        Microsoft::WRL::ComPtr<ITextRangeProvider> found;
+        THROW_IF_FAILED(partial->FindText(needle.get(), FALSE, TRUE, &found));
+        VERIFY_IS_NULL(found.Get());
+    }
 };
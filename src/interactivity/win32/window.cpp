@@ -1291,15 +1291,55 @@ IRawElementProviderSimple* Window::_GetUiaProvider()
     if (nullptr == _pUiaProvider)
     {
         LOG_IF_FAILED(WRL::MakeAndInitialize<WindowUiaProvider>(&_pUiaProvider, this));
+
+        if (_pUiaProvider)
+        {
+            try
+            {
+                _uiaEvents = std::make_unique<UiaEventAggregator>([this](const UiaEventDelta& delta) { _RaiseUiaEvents(delta); },
+                                                                  []() { return !!UiaClientsAreListening(); });
+            }
+            CATCH_LOG();
+        }
     }
 
     return _pUiaProvider.Get();
 }
 
+// Routine Description:
+// - Raises the events for the changes that the aggregator merged.
+// - Runs on the aggregator's thread.
+// Arguments:
+// - delta - the merged changes
+void Window::_RaiseUiaEvents(const UiaEventDelta& delta)
+{
+    if (delta.textChanged)
+    {
+        LOG_IF_FAILED(_pUiaProvider->Signal(UIA_Text_TextChangedEventId));
+    }
+    if (delta.selectionChanged)
+    {
+        LOG_IF_FAILED(_pUiaProvider->Signal(UIA_Text_TextSelectionChangedEventId));
+    }
+}
+
 [[nodiscard]] HRESULT Window::SignalUia(_In_ EVENTID id)
 {
     if (_pUiaProvider != nullptr)
     {
+        // Text and selection changes are signaled for every write to the
+        // buffer. Let the aggregator merge them, instead of raising an event
+        // on the output path each time.
+        if (_uiaEvents && id == UIA_Text_TextChangedEventId)
+        {
+            _uiaEvents->NotifyTextChanged();
+            return S_OK;
+        }
+        if (_uiaEvents && id == UIA_Text_TextSelectionChangedEventId)
+        {
+            _uiaEvents->NotifySelectionChanged();
+            return S_OK;
+        }
         return _pUiaProvider->Signal(id);
     }
     return S_FALSE;
@@ -15,6 +15,7 @@ Author(s):
 #pragma once
 
 #include "../inc/IConsoleWindow.hpp"
+#include "../../types/UiaEventAggregator.hpp"
 
 namespace Microsoft::Console::Interactivity::Win32
 {
@@ -132,7 +133,12 @@ namespace Microsoft::Console::Interactivity::Win32
                                                const WPARAM wParam,
                                                const LPARAM lParam);
         IRawElementProviderSimple* _GetUiaProvider();
+        void _RaiseUiaEvents(const Microsoft::Console::Types::UiaEventDelta& delta);
         WRL::ComPtr<WindowUiaProvider> _pUiaProvider;
+        // Merges the text and selection changes of the output path and raises
+        // their events on its own thread. Like the provider it lives as long as
+        // the window. Declared after _pUiaProvider, so that it's destroyed first.
+        std::unique_ptr<Microsoft::Console::Types::UiaEventAggregator> _uiaEvents;
 
         // Dynamic Settings helpers
         [[nodiscard]] static LRESULT s_RegPersistWindowPos(_In_ PCWSTR const pwszTitle,
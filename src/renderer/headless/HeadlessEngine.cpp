@@ -0,0 +1,612 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+
+#include "HeadlessEngine.hpp"
+
+#include "../../types/inc/Viewport.hpp"
+
+#pragma hdrstop
+
+using namespace Microsoft::Console::Render;
+using namespace Microsoft::Console::Types;
+
+// FNV-1a, which is plenty for telling frames apart.
+static constexpr uint64_t s_hashOffsetBasis = 0xcbf29ce484222325;
+static constexpr uint64_t s_hashPrime = 0x100000001b3;
+
+// Routine Description:
+// - Forgets everything that was recorded, but keeps the storage around for the next frame.
+void HeadlessFrame::Clear() noexcept
+{
+    number = 0;
+    dirty.clear();
+    scroll = {};
+    backgroundPaints = 0;
+    text.clear();
+    clusters.clear();
+    lines.clear();
+    gridLines.clear();
+    selection.clear();
+    cursor.reset();
+    hash = s_hashOffsetBasis;
+}
+
+HeadlessEngine::HeadlessEngine() :
+    RenderEngineBase(),
+    _recording{ true },
+    _hashing{ false },
+    _isPainting{ false },
+    _invalidMap{},
+    _invalidScroll{},
+    _lineRendition{ LineRendition::SingleWidth },
+    _foreground{ 0 },
+    _background{ 0 },
+    _frameCount{ 0 },
+    _frame{}
+{
+}
+
+void HeadlessEngine::SetRecording(const bool enabled) noexcept
+{
+    _recording = enabled;
+}
+
+void HeadlessEngine::SetHashing(const bool enabled) noexcept
+{
+    _hashing = enabled;
+}
+
+// Routine Description:
+// - Returns what was painted during the last frame.
+// - The returned reference is only valid until the next frame starts painting.
+const HeadlessFrame& HeadlessEngine::GetLastFrame() const noexcept
+{
+    return _frame;
+}
+
+// Routine Description:
+// - Returns the number of frames that were painted so far.
+uint64_t HeadlessEngine::GetFrameCount() const noexcept
+{
+    return _frameCount;
+}
+
+template<typename T>
+void HeadlessEngine::_Hash(const T& value) noexcept
+{
+    static_assert(std::is_integral_v<T> || std::is_enum_v<T>, "only integral values can be hashed");
+
+    uint64_t bits;
+    if constexpr (std::is_enum_v<T>)
+    {
+        bits = static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(value));
+    }
+    else
+    {
+        bits = static_cast<uint64_t>(value);
+    }
+
+    for (size_t i = 0; i < sizeof(T); ++i)
+    {
+        _frame.hash = (_frame.hash ^ (bits & 0xff)) * s_hashPrime;
+        bits >>= 8;
+    }
+}
+
+void HeadlessEngine::_Hash(const std::wstring_view text) noexcept
+{
+    for (const auto ch : text)
+    {
+        _Hash(ch);
+    }
+}
+
+// Routine Description:
+// - Starts a new frame, unless there's nothing to paint.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or S_FALSE if nothing is invalid.
+[[nodiscard]] HRESULT HeadlessEngine::StartPaint() noexcept
+try
+{
+    RETURN_HR_IF(S_FALSE, !_invalidMap.any() && !_titleChanged);
+
+    _isPainting = true;
+    ++_frameCount;
+
+    _frame.Clear();
+    _frame.number = _frameCount;
+
+    if (_recording)
+    {
+        const auto runs = _invalidMap.runs();
+        _frame.dirty.assign(runs.begin(), runs.end());
+        _frame.scroll = _invalidScroll;
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Ends the current frame and resets the invalid area.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK, or E_INVALIDARG if we weren't painting.
+[[nodiscard]] HRESULT HeadlessEngine::EndPaint() noexcept
+{
+    RETURN_HR_IF(E_INVALIDARG, !_isPainting);
+
+    _isPainting = false;
+    _invalidMap.reset_all();
+    _invalidScroll = {};
+
+    return S_OK;
+}
+
+// Routine Description:
+// - There's nothing to present.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_FALSE since we do nothing.
+[[nodiscard]] HRESULT HeadlessEngine::Present() noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - This is unused by this renderer.
+// Arguments:
+// - pForcePaint - always filled with false.
+// Return Value:
+// - S_FALSE because this is unused.
+[[nodiscard]] HRESULT HeadlessEngine::PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
+
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Scrolling is recorded by InvalidateScroll already.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_FALSE since we do nothing.
+[[nodiscard]] HRESULT HeadlessEngine::ScrollFrame() noexcept
+{
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Invalidates a rectangle described in characters
+// Arguments:
+// - psrRegion - Character rectangle
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::Invalidate(const SMALL_RECT* const psrRegion) noexcept
+try
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, psrRegion);
+
+    const auto rc = til::rectangle{ Viewport::FromExclusive(*psrRegion).ToInclusive() } & til::rectangle{ _invalidMap.size() };
+    if (!rc.empty())
+    {
+        _invalidMap.set(rc);
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Invalidates the cells of the cursor
+// Arguments:
+// - psrRegion - the region covered by the cursor
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept
+{
+    return Invalidate(psrRegion);
+}
+
+// Routine Description:
+// - Invalidates a rectangle describing a pixel area on the display.
+//   Pixels are converted to cells using our made up font size.
+// Arguments:
+// - prcDirtyClient - pixel rectangle
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateSystem(const RECT* const prcDirtyClient) noexcept
+try
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, prcDirtyClient);
+
+    const auto rc = til::rectangle{ *prcDirtyClient }.scale_down(til::size{ _fontSize }) & til::rectangle{ _invalidMap.size() };
+    if (!rc.empty())
+    {
+        _invalidMap.set(rc);
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Invalidates a series of character rectangles
+// Arguments:
+// - rectangles - One or more rectangles describing character positions on the grid
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept
+{
+    for (const auto& rect : rectangles)
+    {
+        RETURN_IF_FAILED(Invalidate(&rect));
+    }
+    return S_OK;
+}
+
+// Routine Description:
+// - Scrolls the existing dirty region and invalidates the area that is uncovered.
+// Arguments:
+// - pcoordDelta - The number of characters to move and uncover.
+//               - -Y is up, Y is down, -X is left, X is right.
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateScroll(const COORD* const pcoordDelta) noexcept
+try
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pcoordDelta);
+
+    const til::point deltaCells{ *pcoordDelta };
+    if (deltaCells != til::point{ 0, 0 })
+    {
+        _invalidMap.translate(deltaCells, true);
+        _invalidScroll += deltaCells;
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Invalidates the entire viewport
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateAll() noexcept
+{
+    _invalidMap.set_all();
+    return S_OK;
+}
+
+// Routine Description:
+// - This currently has no effect in this renderer.
+// Arguments:
+// - pForcePaint - Always filled with false
+// Return Value:
+// - S_FALSE because we don't use this.
+[[nodiscard]] HRESULT HeadlessEngine::InvalidateCircling(_Out_ bool* const pForcePaint) noexcept
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pForcePaint);
+
+    *pForcePaint = false;
+    return S_FALSE;
+}
+
+// Routine Description:
+// - Remembers the line rendition of the lines that are painted next.
+// Arguments:
+// - lineRendition - The line rendition specifying the scaling transform.
+// - targetRow - <unused>
+// - viewportLeft - <unused>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PrepareLineTransform(const LineRendition lineRendition,
+                                                           const size_t /*targetRow*/,
+                                                           const size_t /*viewportLeft*/) noexcept
+{
+    _lineRendition = lineRendition;
+    return S_OK;
+}
+
+// Routine Description:
+// - Counts the times the background was painted.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PaintBackground() noexcept
+{
+    ++_frame.backgroundPaints;
+    if (_hashing)
+    {
+        _Hash(_background);
+    }
+    return S_OK;
+}
+
+// Routine Description:
+// - Records one line of text with the current brushes and line rendition.
+// Arguments:
+// - clusters - Iterable collection of cluster information (text and columns it should consume)
+// - coord - Character coordinate position in the cell grid
+// - fTrimLeft - Whether or not to trim off the left half of a double wide character
+// - lineWrapped - Whether the line wraps into the next one
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PaintBufferLine(gsl::span<const Cluster> const clusters,
+                                                      COORD const coord,
+                                                      bool const fTrimLeft,
+                                                      const bool lineWrapped) noexcept
+try
+{
+    if (_recording)
+    {
+        HeadlessFrame::Line line{};
+        line.origin = coord;
+        line.lineRendition = _lineRendition;
+        line.foreground = _foreground;
+        line.background = _background;
+        line.trimLeft = fTrimLeft;
+        line.lineWrapped = lineWrapped;
+        line.textOffset = _frame.text.size();
+        line.clusterOffset = _frame.clusters.size();
+
+        for (const auto& cluster : clusters)
+        {
+            const auto text = cluster.GetText();
+            _frame.text.append(text);
+            _frame.clusters.push_back({ gsl::narrow_cast<uint16_t>(text.size()), gsl::narrow_cast<uint16_t>(cluster.GetColumns()) });
+        }
+
+        line.textLength = _frame.text.size() - line.textOffset;
+        line.clusterCount = _frame.clusters.size() - line.clusterOffset;
+        _frame.lines.push_back(line);
+    }
+
+    if (_hashing)
+    {
+        _Hash(coord.X);
+        _Hash(coord.Y);
+        _Hash(_lineRendition);
+        _Hash(_foreground);
+        _Hash(_background);
+        _Hash(fTrimLeft);
+        for (const auto& cluster : clusters)
+        {
+            _Hash(cluster.GetText());
+            _Hash(cluster.GetColumns());
+        }
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Records the grid lines painted for a run of cells.
+// Arguments:
+// - lines - Enum defining which edges of the rectangle to draw
+// - color - The color to use for drawing the edges.
+// - cchLine - How many characters we should draw the grid lines along (left to right in a row)
+// - coordTarget - The starting X/Y position of the first character to draw on.
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PaintBufferGridLines(GridLines const lines,
+                                                           COLORREF const color,
+                                                           size_t const cchLine,
+                                                           COORD const coordTarget) noexcept
+try
+{
+    if (_recording)
+    {
+        _frame.gridLines.push_back({ lines, color, cchLine, coordTarget });
+    }
+
+    if (_hashing)
+    {
+        _Hash(lines);
+        _Hash(color);
+        _Hash(cchLine);
+        _Hash(coordTarget.X);
+        _Hash(coordTarget.Y);
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Records a selected rectangle.
+// Arguments:
+// - rect - Rectangle to invert or highlight to make the selection area
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PaintSelection(const SMALL_RECT rect) noexcept
+try
+{
+    if (_recording)
+    {
+        _frame.selection.push_back(rect);
+    }
+
+    if (_hashing)
+    {
+        _Hash(rect.Left);
+        _Hash(rect.Top);
+        _Hash(rect.Right);
+        _Hash(rect.Bottom);
+    }
+
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Records the cursor.
+// Arguments:
+// - options - Parameters that affect the way that the cursor is drawn
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::PaintCursor(const CursorOptions& options) noexcept
+{
+    if (_recording)
+    {
+        _frame.cursor = options;
+    }
+
+    if (_hashing)
+    {
+        _Hash(options.coordCursor.X);
+        _Hash(options.coordCursor.Y);
+        _Hash(options.cursorType);
+        _Hash(options.fIsDoubleWidth);
+        _Hash(options.isOn);
+    }
+
+    return S_OK;
+}
+
+// Routine Description:
+// - Remembers the colors of the text that is painted next.
+// Arguments:
+// - textAttributes - Text attributes to use for the brush color
+// - pData - The interface to console data structures required for rendering
+// - isSettingDefaultBrushes - <unused>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                           const gsl::not_null<IRenderData*> pData,
+                                                           const bool /*isSettingDefaultBrushes*/) noexcept
+{
+    std::tie(_foreground, _background) = pData->GetAttributeColors(textAttributes);
+    return S_OK;
+}
+
+// Routine Description:
+// - Reports our made up font size back to the caller.
+// Arguments:
+// - fiFontInfoDesired - The font that was asked for
+// - fiFontInfo - Filled with the font we "selected"
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::UpdateFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo) noexcept
+try
+{
+    fiFontInfo.SetFromEngine(fiFontInfoDesired.GetFaceName(),
+                             fiFontInfoDesired.GetFamily(),
+                             fiFontInfoDesired.GetWeight(),
+                             false,
+                             _fontSize,
+                             _fontSize);
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - This is unused by this renderer.
+// Arguments:
+// - iDpi - <unused>
+// Return Value:
+// - S_FALSE
+[[nodiscard]] HRESULT HeadlessEngine::UpdateDpi(int const /*iDpi*/) noexcept
+{
+    return S_FALSE;
+}
+
+// Method Description:
+// - Resizes the invalid area to the size of the viewport. If it changes,
+//   the whole viewport needs to be painted again.
+// Arguments:
+// - srNewViewport - The bounds of the new viewport.
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::UpdateViewport(const SMALL_RECT srNewViewport) noexcept
+try
+{
+    const til::size size{ Viewport::FromInclusive(srNewViewport).Dimensions() };
+    if (_invalidMap.resize(size))
+    {
+        _invalidMap.set_all();
+    }
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Reports our made up font size back to the caller.
+// Arguments:
+// - fiFontInfoDesired - The font that was asked for
+// - fiFontInfo - Filled with the font we would select
+// - iDpi - <unused>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::GetProposedFont(const FontInfoDesired& fiFontInfoDesired,
+                                                      FontInfo& fiFontInfo,
+                                                      int const /*iDpi*/) noexcept
+{
+    return UpdateFont(fiFontInfoDesired, fiFontInfo);
+}
+
+// Routine Description:
+// - Gets the area that we currently believe is dirty within the character cell grid
+// Arguments:
+// - area - Rectangle describing dirty area in characters.
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::GetDirtyArea(gsl::span<const til::rectangle>& area) noexcept
+try
+{
+    area = _invalidMap.runs();
+    return S_OK;
+}
+CATCH_RETURN()
+
+// Routine Description:
+// - Gets our made up font size
+// Arguments:
+// - pFontSize - Filled with the font size.
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::GetFontSize(_Out_ COORD* const pFontSize) noexcept
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pFontSize);
+
+    *pFontSize = _fontSize;
+    return S_OK;
+}
+
+// Routine Description:
+// - There's no font to measure glyphs with, so nothing is wide by font.
+// Arguments:
+// - glyph - <unused>
+// - pResult - Always filled with false
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::IsGlyphWideByFont(const std::wstring_view /*glyph*/, _Out_ bool* const pResult) noexcept
+{
+    RETURN_HR_IF_NULL(E_INVALIDARG, pResult);
+
+    *pResult = false;
+    return S_OK;
+}
+
+// Method Description:
+// - There's no window to put the title on.
+// Arguments:
+// - newTitle - <unused>
+// Return Value:
+// - S_OK
+[[nodiscard]] HRESULT HeadlessEngine::_DoUpdateTitle(_In_ const std::wstring_view /*newTitle*/) noexcept
+{
+    return S_OK;
+}
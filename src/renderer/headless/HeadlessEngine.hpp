@@ -0,0 +1,158 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- HeadlessEngine.hpp
+
+Abstract:
+- This is the definition of a render engine that doesn't draw anywhere.
+  It records what the Renderer asks it to paint into an in-memory frame model
+  (and optionally hashes it), so that Renderer::PaintFrame can be tested and
+  profiled on machines without a window, a GPU or a pipe to write to.
+
+--*/
+
+#pragma once
+
+#include "../inc/RenderEngineBase.hpp"
+
+namespace Microsoft::Console::Render
+{
+    // Everything the Renderer painted during one frame.
+    // All storage is reused from frame to frame, so that recording
+    // doesn't allocate once the first few frames have been painted.
+    struct HeadlessFrame
+    {
+        struct ClusterRecord
+        {
+            uint16_t textLength;
+            uint16_t columns;
+        };
+
+        struct Line
+        {
+            COORD origin;
+            LineRendition lineRendition;
+            COLORREF foreground;
+            COLORREF background;
+            bool trimLeft;
+            bool lineWrapped;
+            // Ranges into HeadlessFrame::text and HeadlessFrame::clusters.
+            size_t textOffset;
+            size_t textLength;
+            size_t clusterOffset;
+            size_t clusterCount;
+        };
+
+        struct GridLine
+        {
+            IRenderEngine::GridLines lines;
+            COLORREF color;
+            size_t cchLine;
+            COORD target;
+        };
+
+        uint64_t number{};
+        std::vector<til::rectangle> dirty;
+        til::point scroll;
+        size_t backgroundPaints{};
+        std::wstring text;
+        std::vector<ClusterRecord> clusters;
+        std::vector<Line> lines;
+        std::vector<GridLine> gridLines;
+        std::vector<SMALL_RECT> selection;
+        std::optional<CursorOptions> cursor;
+        // A hash of everything painted during the frame. Only valid if hashing is enabled.
+        uint64_t hash{};
+
+        std::wstring_view GetText(const Line& line) const noexcept
+        {
+            return std::wstring_view{ text }.substr(line.textOffset, line.textLength);
+        }
+
+        void Clear() noexcept;
+    };
+
+    class HeadlessEngine final : public RenderEngineBase
+    {
+    public:
+        HeadlessEngine();
+
+        // Recording is on by default. With it turned off, only the frame
+        // counter and (if enabled) the hash are updated.
+        void SetRecording(const bool enabled) noexcept;
+        void SetHashing(const bool enabled) noexcept;
+
+        const HeadlessFrame& GetLastFrame() const noexcept;
+        uint64_t GetFrameCount() const noexcept;
+
+        // IRenderEngine Members
+        [[nodiscard]] HRESULT StartPaint() noexcept override;
+        [[nodiscard]] HRESULT EndPaint() noexcept override;
+        [[nodiscard]] HRESULT Present() noexcept override;
+
+        [[nodiscard]] HRESULT PrepareForTeardown(_Out_ bool* const pForcePaint) noexcept override;
+
+        [[nodiscard]] HRESULT ScrollFrame() noexcept override;
+
+        [[nodiscard]] HRESULT Invalidate(const SMALL_RECT* const psrRegion) noexcept override;
+        [[nodiscard]] HRESULT InvalidateCursor(const SMALL_RECT* const psrRegion) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSystem(const RECT* const prcDirtyClient) noexcept override;
+        [[nodiscard]] HRESULT InvalidateSelection(const std::vector<SMALL_RECT>& rectangles) noexcept override;
+        [[nodiscard]] HRESULT InvalidateScroll(const COORD* const pcoordDelta) noexcept override;
+        [[nodiscard]] HRESULT InvalidateAll() noexcept override;
+        [[nodiscard]] HRESULT InvalidateCircling(_Out_ bool* const pForcePaint) noexcept override;
+
+        [[nodiscard]] HRESULT PrepareLineTransform(const LineRendition lineRendition,
+                                                   const size_t targetRow,
+                                                   const size_t viewportLeft) noexcept override;
+
+        [[nodiscard]] HRESULT PaintBackground() noexcept override;
+        [[nodiscard]] HRESULT PaintBufferLine(gsl::span<const Cluster> const clusters,
+                                              COORD const coord,
+                                              bool const fTrimLeft,
+                                              const bool lineWrapped) noexcept override;
+        [[nodiscard]] HRESULT PaintBufferGridLines(GridLines const lines, COLORREF const color, size_t const cchLine, COORD const coordTarget) noexcept override;
+        [[nodiscard]] HRESULT PaintSelection(const SMALL_RECT rect) noexcept override;
+
+        [[nodiscard]] HRESULT PaintCursor(const CursorOptions& options) noexcept override;
+
+        [[nodiscard]] HRESULT UpdateDrawingBrushes(const TextAttribute& textAttributes,
+                                                   const gsl::not_null<IRenderData*> pData,
+                                                   const bool isSettingDefaultBrushes) noexcept override;
+        [[nodiscard]] HRESULT UpdateFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo) noexcept override;
+        [[nodiscard]] HRESULT UpdateDpi(int const iDpi) noexcept override;
+        [[nodiscard]] HRESULT UpdateViewport(const SMALL_RECT srNewViewport) noexcept override;
+
+        [[nodiscard]] HRESULT GetProposedFont(const FontInfoDesired& fiFontInfoDesired, FontInfo& fiFontInfo, int const iDpi) noexcept override;
+
+        [[nodiscard]] HRESULT GetDirtyArea(gsl::span<const til::rectangle>& area) noexcept override;
+        [[nodiscard]] HRESULT GetFontSize(_Out_ COORD* const pFontSize) noexcept override;
+        [[nodiscard]] HRESULT IsGlyphWideByFont(const std::wstring_view glyph, _Out_ bool* const pResult) noexcept override;
+
+    protected:
+        [[nodiscard]] HRESULT _DoUpdateTitle(const std::wstring_view newTitle) noexcept override;
+
+    private:
+        static constexpr COORD _fontSize{ 8, 16 };
+
+        template<typename T>
+        void _Hash(const T& value) noexcept;
+        void _Hash(const std::wstring_view text) noexcept;
+
+        bool _recording;
+        bool _hashing;
+        bool _isPainting;
+
+        til::bitmap _invalidMap;
+        til::point _invalidScroll;
+
+        LineRendition _lineRendition;
+        COLORREF _foreground;
+        COLORREF _background;
+
+        uint64_t _frameCount;
+        HeadlessFrame _frame;
+    };
+}
@@ -11,20 +11,27 @@
 
 #define CONSOLE_API_STRUCT(Routine, Struct, TraceName) \
     {                                                  \
-        Routine, sizeof(Struct), TraceName             \
+        Routine, sizeof(Struct), TraceName, false      \
     }
 #define CONSOLE_API_NO_PARAMETER(Routine, TraceName) \
     {                                                \
-        Routine, 0, TraceName                        \
+        Routine, 0, TraceName, false                 \
     }
 
-#define CONSOLE_API_DEPRECATED(Struct)                                    \
-    {                                                                     \
-        ApiDispatchers::ServerDeprecatedApi, sizeof(Struct), "Deprecated" \
+// Queries only read console state and never pend, so they may be serviced
+// concurrently with each other while holding the console lock shared.
+#define CONSOLE_API_QUERY(Routine, Struct, TraceName) \
+    {                                                 \
+        Routine, sizeof(Struct), TraceName, true      \
     }
-#define CONSOLE_API_DEPRECATED_NO_PARAM()                    \
-    {                                                        \
-        ApiDispatchers::ServerDeprecatedApi, 0, "Deprecated" \
+
+#define CONSOLE_API_DEPRECATED(Struct)                                           \
+    {                                                                            \
+        ApiDispatchers::ServerDeprecatedApi, sizeof(Struct), "Deprecated", false \
+    }
+#define CONSOLE_API_DEPRECATED_NO_PARAM()                           \
+    {                                                               \
+        ApiDispatchers::ServerDeprecatedApi, 0, "Deprecated", false \
     }
 
 typedef struct _CONSOLE_API_DESCRIPTOR
@@ -32,6 +39,7 @@ typedef struct _CONSOLE_API_DESCRIPTOR
     PCONSOLE_API_ROUTINE Routine;
     ULONG RequiredSize;
     PCSTR TraceName;
+    bool ReadOnly;
 } CONSOLE_API_DESCRIPTOR, *PCONSOLE_API_DESCRIPTOR;
 
 typedef struct _CONSOLE_API_LAYER_DESCRIPTOR
@@ -41,15 +49,15 @@ typedef struct _CONSOLE_API_LAYER_DESCRIPTOR
 } CONSOLE_API_LAYER_DESCRIPTOR, *PCONSOLE_API_LAYER_DESCRIPTOR;
 
 const CONSOLE_API_DESCRIPTOR ConsoleApiLayer1[] = {
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleCP, CONSOLE_GETCP_MSG, "GetConsoleCP"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleMode, CONSOLE_MODE_MSG, "GetConsoleMode"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleCP, CONSOLE_GETCP_MSG, "GetConsoleCP"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleMode, CONSOLE_MODE_MSG, "GetConsoleMode"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleMode, CONSOLE_MODE_MSG, "SetConsoleMode"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetNumberOfInputEvents, CONSOLE_GETNUMBEROFINPUTEVENTS_MSG, "GetNumberOfConsoleInputEvents"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetNumberOfInputEvents, CONSOLE_GETNUMBEROFINPUTEVENTS_MSG, "GetNumberOfConsoleInputEvents"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleInput, CONSOLE_GETCONSOLEINPUT_MSG, "GetConsoleInput"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerReadConsole, CONSOLE_READCONSOLE_MSG, "ReadConsole"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerWriteConsole, CONSOLE_WRITECONSOLE_MSG, "WriteConsole"),
     CONSOLE_API_DEPRECATED_NO_PARAM(), // ApiDispatchers::ServerConsoleNotifyLastClose
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleLangId, CONSOLE_LANGID_MSG, "GetConsoleLangId"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleLangId, CONSOLE_LANGID_MSG, "GetConsoleLangId"),
     CONSOLE_API_DEPRECATED(CONSOLE_MAPBITMAP_MSG),
 };
 
@@ -59,31 +67,31 @@ const CONSOLE_API_DESCRIPTOR ConsoleApiLayer2[] = {
     CONSOLE_API_NO_PARAMETER(ApiDispatchers::ServerSetConsoleActiveScreenBuffer, "SetConsoleActiveScreenBuffer"),
     CONSOLE_API_NO_PARAMETER(ApiDispatchers::ServerFlushConsoleInputBuffer, "FlushConsoleInputBuffer"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleCP, CONSOLE_SETCP_MSG, "SetConsoleCP"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleCursorInfo, CONSOLE_GETCURSORINFO_MSG, "GetConsoleCursorInfo"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleCursorInfo, CONSOLE_GETCURSORINFO_MSG, "GetConsoleCursorInfo"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleCursorInfo, CONSOLE_SETCURSORINFO_MSG, "SetConsoleCursorInfo"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleScreenBufferInfo, CONSOLE_SCREENBUFFERINFO_MSG, "GetConsoleScreenBufferInfo"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleScreenBufferInfo, CONSOLE_SCREENBUFFERINFO_MSG, "GetConsoleScreenBufferInfo"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleScreenBufferInfo, CONSOLE_SCREENBUFFERINFO_MSG, "SetConsoleScreenBufferInfo"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleScreenBufferSize, CONSOLE_SETSCREENBUFFERSIZE_MSG, "SetConsoleScreenBufferSize"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleCursorPosition, CONSOLE_SETCURSORPOSITION_MSG, "SetConsoleCursorPosition"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetLargestConsoleWindowSize, CONSOLE_GETLARGESTWINDOWSIZE_MSG, "GetLargestConsoleWindowSize"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetLargestConsoleWindowSize, CONSOLE_GETLARGESTWINDOWSIZE_MSG, "GetLargestConsoleWindowSize"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerScrollConsoleScreenBuffer, CONSOLE_SCROLLSCREENBUFFER_MSG, "ScrollConsoleScreenBuffer"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleTextAttribute, CONSOLE_SETTEXTATTRIBUTE_MSG, "SetConsoleTextAttribute"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleWindowInfo, CONSOLE_SETWINDOWINFO_MSG, "SetConsoleWindowInfo"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerReadConsoleOutputString, CONSOLE_READCONSOLEOUTPUTSTRING_MSG, "ReadConsoleOutputString"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerReadConsoleOutputString, CONSOLE_READCONSOLEOUTPUTSTRING_MSG, "ReadConsoleOutputString"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerWriteConsoleInput, CONSOLE_WRITECONSOLEINPUT_MSG, "WriteConsoleInput"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerWriteConsoleOutput, CONSOLE_WRITECONSOLEOUTPUT_MSG, "WriteConsoleOutput"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerWriteConsoleOutputString, CONSOLE_WRITECONSOLEOUTPUTSTRING_MSG, "WriteConsoleOutputString"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerReadConsoleOutput, CONSOLE_READCONSOLEOUTPUT_MSG, "ReadConsoleOutput"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleTitle, CONSOLE_GETTITLE_MSG, "GetConsoleTitle"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerReadConsoleOutput, CONSOLE_READCONSOLEOUTPUT_MSG, "ReadConsoleOutput"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleTitle, CONSOLE_GETTITLE_MSG, "GetConsoleTitle"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleTitle, CONSOLE_SETTITLE_MSG, "SetConsoleTitle"),
 };
 
 const CONSOLE_API_DESCRIPTOR ConsoleApiLayer3[] = {
     CONSOLE_API_DEPRECATED(CONSOLE_GETNUMBEROFFONTS_MSG),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleMouseInfo, CONSOLE_GETMOUSEINFO_MSG, "GetNumberOfConsoleMouseButtons"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleMouseInfo, CONSOLE_GETMOUSEINFO_MSG, "GetNumberOfConsoleMouseButtons"),
     CONSOLE_API_DEPRECATED(CONSOLE_GETFONTINFO_MSG),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleFontSize, CONSOLE_GETFONTSIZE_MSG, "GetConsoleFontSize"),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleCurrentFont, CONSOLE_CURRENTFONT_MSG, "GetCurrentConsoleFont"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleFontSize, CONSOLE_GETFONTSIZE_MSG, "GetConsoleFontSize"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleCurrentFont, CONSOLE_CURRENTFONT_MSG, "GetCurrentConsoleFont"),
     CONSOLE_API_DEPRECATED(CONSOLE_SETFONT_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_SETICON_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_INVALIDATERECT_MSG),
@@ -96,7 +104,7 @@ const CONSOLE_API_DESCRIPTOR ConsoleApiLayer3[] = {
     CONSOLE_API_DEPRECATED(CONSOLE_REGISTERVDM_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_GETHARDWARESTATE_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_SETHARDWARESTATE_MSG),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleDisplayMode, CONSOLE_GETDISPLAYMODE_MSG, "GetConsoleDisplayMode"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleDisplayMode, CONSOLE_GETDISPLAYMODE_MSG, "GetConsoleDisplayMode"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerAddConsoleAlias, CONSOLE_ADDALIAS_MSG, "AddConsoleAlias"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleAlias, CONSOLE_GETALIAS_MSG, "GetConsoleAlias"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleAliasesLength, CONSOLE_GETALIASESLENGTH_MSG, "GetConsoleAliasesLength"),
@@ -110,6 +118,7 @@ const CONSOLE_API_DESCRIPTOR ConsoleApiLayer3[] = {
     CONSOLE_API_DEPRECATED(CONSOLE_SETKEYSHORTCUTS_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_SETMENUCLOSE_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_GETKEYBOARDLAYOUTNAME_MSG),
+    // Not a query: this lazily creates the pseudo window in ConPTY mode.
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleWindow, CONSOLE_GETCONSOLEWINDOW_MSG, "GetConsoleWindow"),
     CONSOLE_API_DEPRECATED(CONSOLE_CHAR_TYPE_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_LOCAL_EUDC_MSG),
@@ -119,7 +128,7 @@ const CONSOLE_API_DESCRIPTOR ConsoleApiLayer3[] = {
     CONSOLE_API_DEPRECATED(CONSOLE_SETOS2OEMFORMAT_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_NLS_MODE_MSG),
     CONSOLE_API_DEPRECATED(CONSOLE_NLS_MODE_MSG),
-    CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleSelectionInfo, CONSOLE_GETSELECTIONINFO_MSG, "GetConsoleSelectionInfo"),
+    CONSOLE_API_QUERY(ApiDispatchers::ServerGetConsoleSelectionInfo, CONSOLE_GETSELECTIONINFO_MSG, "GetConsoleSelectionInfo"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleProcessList, CONSOLE_GETCONSOLEPROCESSLIST_MSG, "GetConsoleProcessList"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerGetConsoleHistory, CONSOLE_HISTORY_MSG, "GetConsoleHistory"),
     CONSOLE_API_STRUCT(ApiDispatchers::ServerSetConsoleHistory, CONSOLE_HISTORY_MSG, "SetConsoleHistory"),
@@ -132,6 +141,26 @@ const CONSOLE_API_LAYER_DESCRIPTOR ConsoleApiLayerTable[] = {
     { ConsoleApiLayer3, RTL_NUMBER_OF(ConsoleApiLayer3) },
 };
 
+// Routine Description:
+// - Determines whether a user IO only reads console state and can therefore be serviced
+//   concurrently with other such IOs under a shared console lock.
+// Arguments:
+// - Message - Supplies the message representing the user IO.
+// Return Value:
+// - True if the message refers to a valid read-only API. False otherwise, including for malformed API numbers.
+bool ApiSorter::IsReadOnlyRequest(const CONSOLE_API_MSG* const Message) noexcept
+{
+    ULONG const LayerNumber = (Message->msgHeader.ApiNumber >> 24) - 1;
+    ULONG const ApiNumber = Message->msgHeader.ApiNumber & 0xffffff;
+
+    if ((LayerNumber >= RTL_NUMBER_OF(ConsoleApiLayerTable)) || (ApiNumber >= ConsoleApiLayerTable[LayerNumber].Count))
+    {
+        return false;
+    }
+
+    return ConsoleApiLayerTable[LayerNumber].Descriptor[ApiNumber].ReadOnly;
+}
+
 // Routine Description:
 // - This routine validates a user IO and dispatches it to the appropriate worker routine.
 // Arguments:
@@ -41,4 +41,12 @@ public:
     // Return Value:
     // - A pointer to the reply message, if this message is to be completed inline; nullptr if this message will pend now and complete later.
     static PCONSOLE_API_MSG ConsoleDispatchRequest(_Inout_ PCONSOLE_API_MSG Message);
+
+    // Routine Description:
+    // - Determines whether a user IO only reads console state and never pends.
+    // Arguments:
+    // - Message - Supplies the message representing the user IO.
+    // Return Value:
+    // - True if the message may be dispatched concurrently under a shared console lock.
+    static bool IsReadOnlyRequest(const CONSOLE_API_MSG* const Message) noexcept;
 };
@@ -1531,8 +1531,7 @@ bool AdaptDispatch::HorizontalTabSet()
         const auto width = csbiex.dwSize.X;
         const auto column = csbiex.dwCursorPosition.X;
 
-        _InitTabStopsForWidth(width);
-        _tabStopColumns.at(column) = true;
+        _tabStops.Set(column, width);
     }
     return success;
 }
@@ -1555,20 +1554,16 @@ bool AdaptDispatch::ForwardTab(const size_t numTabs)
     {
         const auto width = csbiex.dwSize.X;
         const auto row = csbiex.dwCursorPosition.Y;
-        auto column = csbiex.dwCursorPosition.X;
+        size_t column = csbiex.dwCursorPosition.X;
         auto tabsPerformed = 0u;
 
-        _InitTabStopsForWidth(width);
-        while (column + 1 < width && tabsPerformed < numTabs)
+        while (column + 1 < gsl::narrow_cast<size_t>(width) && tabsPerformed < numTabs)
         {
-            column++;
-            if (til::at(_tabStopColumns, column))
-            {
-                tabsPerformed++;
-            }
+            column = _tabStops.Next(column, width);
+            tabsPerformed++;
         }
 
-        success = _pConApi->SetConsoleCursorPosition({ column, row });
+        success = _pConApi->SetConsoleCursorPosition({ gsl::narrow_cast<SHORT>(column), row });
     }
     return success;
 }
@@ -1589,20 +1584,16 @@ bool AdaptDispatch::BackwardsTab(const size_t numTabs)
     {
         const auto width = csbiex.dwSize.X;
         const auto row = csbiex.dwCursorPosition.Y;
-        auto column = csbiex.dwCursorPosition.X;
+        size_t column = csbiex.dwCursorPosition.X;
         auto tabsPerformed = 0u;
 
-        _InitTabStopsForWidth(width);
         while (column > 0 && tabsPerformed < numTabs)
         {
-            column--;
-            if (til::at(_tabStopColumns, column))
-            {
-                tabsPerformed++;
-            }
+            column = _tabStops.Previous(column, width);
+            tabsPerformed++;
         }
 
-        success = _pConApi->SetConsoleCursorPosition({ column, row });
+        success = _pConApi->SetConsoleCursorPosition({ gsl::narrow_cast<SHORT>(column), row });
     }
     return success;
 }
@@ -1649,64 +1640,33 @@ bool AdaptDispatch::_ClearSingleTabStop()
         const auto width = csbiex.dwSize.X;
         const auto column = csbiex.dwCursorPosition.X;
 
-        _InitTabStopsForWidth(width);
-        _tabStopColumns.at(column) = false;
+        _tabStops.Clear(column, width);
     }
     return success;
 }
 
 // Routine Description:
-// - Clears all tab stops and resets the _initDefaultTabStops flag to indicate
-//    that they shouldn't be reinitialized at the default positions.
+// - Clears all tab stops. They won't be reinitialized at the default positions
+//    when the screen buffer grows.
 // Arguments:
 // - <none>
 // Return value:
 // - True if handled successfully. False otherwise.
 bool AdaptDispatch::_ClearAllTabStops() noexcept
 {
-    _tabStopColumns.clear();
-    _initDefaultTabStops = false;
+    _tabStops.ClearAll();
     return true;
 }
 
 // Routine Description:
-// - Clears all tab stops and sets the _initDefaultTabStops flag to indicate
-//    that the default positions should be reinitialized when needed.
+// - Returns to the default tab stops, one every 8 columns.
 // Arguments:
 // - <none>
 // Return value:
 // - <none>
 void AdaptDispatch::_ResetTabStops() noexcept
 {
-    _tabStopColumns.clear();
-    _initDefaultTabStops = true;
-}
-
-// Routine Description:
-// - Resizes the _tabStopColumns table so it's large enough to support the
-//    current screen width, initializing tab stops every 8 columns in the
-//    newly allocated space, iff the _initDefaultTabStops flag is set.
-// Arguments:
-// - width - the width of the screen buffer that we need to accomodate
-// Return value:
-// - <none>
-void AdaptDispatch::_InitTabStopsForWidth(const size_t width)
-{
-    const auto initialWidth = _tabStopColumns.size();
-    if (width > initialWidth)
-    {
-        _tabStopColumns.resize(width);
-        if (_initDefaultTabStops)
-        {
-            for (auto column = 8u; column < _tabStopColumns.size(); column += 8)
-            {
-                if (column >= initialWidth)
-                {
-                    til::at(_tabStopColumns, column) = true;
-                }
-            }
-        }
-    }
+    _tabStops.Reset();
 }
 
 //Routine Description:
@@ -19,6 +19,7 @@ Author(s):
 #include "conGetSet.hpp"
 #include "adaptDefaults.hpp"
 #include "terminalOutput.hpp"
+#include "tabStops.hpp"
 #include "..\..\types\inc\sgrStack.hpp"
 
 namespace Microsoft::Console::VirtualTerminal
@@ -177,12 +178,10 @@ namespace Microsoft::Console::VirtualTerminal
         bool _ClearSingleTabStop();
         bool _ClearAllTabStops() noexcept;
         void _ResetTabStops() noexcept;
-        void _InitTabStopsForWidth(const size_t width);
 
         bool _ShouldPassThroughInputModeChange() const;
 
-        std::vector<bool> _tabStopColumns;
-        bool _initDefaultTabStops = true;
+        TabStops _tabStops;
 
         std::unique_ptr<ConGetSet> _pConApi;
         std::unique_ptr<AdaptDefaults> _pDefaults;
@@ -0,0 +1,230 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "tabStops.hpp"
+
+using namespace Microsoft::Console::VirtualTerminal;
+
+TabStops::TabStops() noexcept :
+    _isDefault{ true },
+    _fillDefaults{ true },
+    _columns{},
+    _width{ 0 }
+{
+}
+
+// Routine Description:
+// - Sets a tab stop in the given column.
+// Arguments:
+// - column - the column to set the tab stop in
+// - width - the width of the screen buffer
+// Return value:
+// - <none>
+void TabStops::Set(const size_t column, const size_t width)
+{
+    // Setting one of the default tab stops doesn't change anything.
+    if (_isDefault && IsSet(column))
+    {
+        return;
+    }
+
+    _Materialize(width);
+    til::at(_columns, column / WordBits) |= word_type{ 1 } << (column % WordBits);
+}
+
+// Routine Description:
+// - Clears the tab stop in the given column, if there is one.
+// Arguments:
+// - column - the column to clear the tab stop in
+// - width - the width of the screen buffer
+// Return value:
+// - <none>
+void TabStops::Clear(const size_t column, const size_t width)
+{
+    if (_isDefault && !IsSet(column))
+    {
+        return;
+    }
+
+    _Materialize(width);
+    til::at(_columns, column / WordBits) &= ~(word_type{ 1 } << (column % WordBits));
+}
+
+// Routine Description:
+// - Clears all tab stops. They won't be reinitialized at the default
+//    positions when the screen buffer grows.
+void TabStops::ClearAll() noexcept
+{
+    _isDefault = false;
+    _fillDefaults = false;
+    _columns.clear();
+    _width = 0;
+}
+
+// Routine Description:
+// - Returns to the default tab stops, one every 8 columns.
+void TabStops::Reset() noexcept
+{
+    _isDefault = true;
+    _fillDefaults = true;
+    _columns.clear();
+    _width = 0;
+}
+
+// Routine Description:
+// - Checks whether there's a tab stop in the given column.
+// Arguments:
+// - column - the column to check
+// Return value:
+// - True if the column has a tab stop.
+bool TabStops::IsSet(const size_t column) const noexcept
+{
+    if (_isDefault)
+    {
+        return column != 0 && column % DefaultInterval == 0;
+    }
+    return column < _width && (til::at(_columns, column / WordBits) >> (column % WordBits)) & 1;
+}
+
+// Routine Description:
+// - Finds the first tab stop to the right of the given column.
+// Arguments:
+// - column - the column to start from
+// - width - the width of the screen buffer
+// Return value:
+// - The column of the tab stop, or the last column if there are no more tab stops.
+size_t TabStops::Next(const size_t column, const size_t width)
+{
+    const auto lastColumn = width - 1;
+    if (column >= lastColumn)
+    {
+        return column;
+    }
+
+    if (_isDefault)
+    {
+        return std::min((column / DefaultInterval + 1) * DefaultInterval, lastColumn);
+    }
+
+    _Grow(width);
+    return _FindFirst(column + 1, lastColumn).value_or(lastColumn);
+}
+
+// Routine Description:
+// - Finds the first tab stop to the left of the given column.
+// Arguments:
+// - column - the column to start from
+// - width - the width of the screen buffer
+// Return value:
+// - The column of the tab stop, or the first column if there are no more tab stops.
+size_t TabStops::Previous(const size_t column, const size_t width)
+{
+    if (column == 0)
+    {
+        return 0;
+    }
+
+    if (_isDefault)
+    {
+        return (column - 1) / DefaultInterval * DefaultInterval;
+    }
+
+    _Grow(width);
+    return _FindLast(0, std::min(column, _width) - 1).value_or(0);
+}
+
+// Routine Description:
+// - Switches from the computed default tab stops to the bitmap.
+// Arguments:
+// - width - the width of the screen buffer that we need to accommodate
+void TabStops::_Materialize(const size_t width)
+{
+    if (_isDefault)
+    {
+        // _fillDefaults is always set in the default state,
+        // so growing from nothing yields the default tab stops.
+        _isDefault = false;
+        _columns.clear();
+        _width = 0;
+    }
+    _Grow(width);
+}
+
+// Routine Description:
+// - Makes the bitmap large enough to hold the given width, initializing tab
+//    stops every 8 columns in the newly allocated space, iff _fillDefaults is set.
+// Arguments:
+// - width - the width of the screen buffer that we need to accommodate
+void TabStops::_Grow(const size_t width)
+{
+    if (width <= _width)
+    {
+        return;
+    }
+
+    _columns.resize((width + WordBits - 1) / WordBits, 0);
+    if (_fillDefaults)
+    {
+        const auto firstStop = std::max((_width + DefaultInterval - 1) / DefaultInterval, size_t{ 1 }) * DefaultInterval;
+        for (auto column = firstStop; column < width; column += DefaultInterval)
+        {
+            til::at(_columns, column / WordBits) |= word_type{ 1 } << (column % WordBits);
+        }
+    }
+    _width = width;
+}
+
+// Routine Description:
+// - Finds the lowest column with a tab stop in the given range.
+// Arguments:
+// - first - the first column of the range
+// - last - the last column of the range (inclusive). Must be less than _width.
+// Return value:
+// - The column of the tab stop, if there is one.
+std::optional<size_t> TabStops::_FindFirst(const size_t first, const size_t last) const noexcept
+{
+    for (auto index = first / WordBits; index <= last / WordBits; ++index)
+    {
+        auto word = til::at(_columns, index);
+        if (index == first / WordBits)
+        {
+            word &= ~word_type{ 0 } << (first % WordBits);
+        }
+
+        unsigned long bit;
+        if (_BitScanForward(&bit, word))
+        {
+            const auto column = index * WordBits + bit;
+            return column <= last ? std::optional{ column } : std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+
+// Routine Description:
+// - Finds the highest column with a tab stop in the given range.
+// Arguments:
+// - first - the first column of the range
+// - last - the last column of the range (inclusive). Must be less than _width.
+// Return value:
+// - The column of the tab stop, if there is one.
+std::optional<size_t> TabStops::_FindLast(const size_t first, const size_t last) const noexcept
+{
+    for (auto index = last / WordBits + 1; index-- > first / WordBits;)
+    {
+        auto word = til::at(_columns, index);
+        if (index == last / WordBits)
+        {
+            word &= ~word_type{ 0 } >> (WordBits - 1 - last % WordBits);
+        }
+
+        unsigned long bit;
+        if (_BitScanReverse(&bit, word))
+        {
+            const auto column = index * WordBits + bit;
+            return column >= first ? std::optional{ column } : std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
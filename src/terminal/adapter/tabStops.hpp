@@ -0,0 +1,53 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- tabStops.hpp
+
+Abstract:
+- Keeps track of the horizontal tab stops set through HTS and TBC, and finds
+    the next or previous one for HT, CHT and CBT.
+- As long as the tab stops haven't been changed from the default of one every
+    8 columns, they're computed rather than stored. Once they are changed, they
+    are kept in a bitmap with one bit per column, which can be searched a word
+    at a time.
+--*/
+#pragma once
+
+namespace Microsoft::Console::VirtualTerminal
+{
+    class TabStops final
+    {
+    public:
+        static constexpr size_t DefaultInterval = 8;
+
+        TabStops() noexcept;
+
+        void Set(const size_t column, const size_t width);
+        void Clear(const size_t column, const size_t width);
+        void ClearAll() noexcept;
+        void Reset() noexcept;
+
+        bool IsSet(const size_t column) const noexcept;
+
+        size_t Next(const size_t column, const size_t width);
+        size_t Previous(const size_t column, const size_t width);
+
+    private:
+        using word_type = uint32_t;
+        static constexpr size_t WordBits = sizeof(word_type) * CHAR_BIT;
+
+        void _Materialize(const size_t width);
+        void _Grow(const size_t width);
+        std::optional<size_t> _FindFirst(const size_t first, const size_t last) const noexcept;
+        std::optional<size_t> _FindLast(const size_t first, const size_t last) const noexcept;
+
+        // Set while the tab stops are still the default ones. _columns is empty in that case.
+        bool _isDefault;
+        // Whether columns that come into view when the buffer grows get default tab stops.
+        bool _fillDefaults;
+        std::vector<word_type> _columns;
+        size_t _width;
+    };
+}
@@ -651,4 +651,59 @@ public:
         mouseInput->EnableAlternateScroll(true);
         VERIFY_IS_FALSE(mouseInput->HandleMouse({ 0, 0 }, WM_MOUSEWHEEL, noModifierKeys, WHEEL_DELTA, {}));
     }
+
+    TEST_METHOD(MotionCoalescingTests)
+    {
+        Log::Comment(L"Starting test...");
+        std::vector<std::wstring> sent;
+        TerminalInput mouseInput{ [&](std::deque<std::unique_ptr<IInputEvent>>& events) {
+            std::wstring sequence;
+            for (const auto& event : events)
+            {
+                sequence.push_back(static_cast<const KeyEvent*>(event.get())->GetCharData());
+            }
+            sent.push_back(sequence);
+        } };
+        const short noModifierKeys = 0;
+        const TerminalInput::MouseButtonState leftButtonDown{ true, false, false };
+
+        mouseInput.EnableAnyEventTracking(true);
+        mouseInput.SetSGRExtendedMode(true);
+        mouseInput.EnableMotionCoalescing(true);
+
+        Log::Comment(L"Motion is held back until it's flushed, and only the latest position is reported");
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 1, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 2, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 3, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_ARE_EQUAL(0u, sent.size());
+        VERIFY_IS_TRUE(mouseInput.FlushPendingMouseMotion());
+        VERIFY_ARE_EQUAL(1u, sent.size());
+        VERIFY_ARE_EQUAL(L"\x1b[<35;4;2m", sent.at(0));
+        VERIFY_IS_FALSE(mouseInput.FlushPendingMouseMotion());
+        VERIFY_ARE_EQUAL(1u, sent.size());
+
+        Log::Comment(L"A button press sends the pending motion first");
+        sent.clear();
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 4, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 4, 1 }, WM_LBUTTONDOWN, noModifierKeys, 0, leftButtonDown));
+        VERIFY_ARE_EQUAL(2u, sent.size());
+        VERIFY_ARE_EQUAL(L"\x1b[<35;5;2m", sent.at(0));
+        VERIFY_ARE_EQUAL(L"\x1b[<0;5;2M", sent.at(1));
+
+        Log::Comment(L"A key press sends the pending motion first");
+        sent.clear();
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 5, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, leftButtonDown));
+        const KeyEvent key{ true, 1, static_cast<WORD>('A'), 0, L'a', 0 };
+        VERIFY_IS_TRUE(mouseInput.HandleKey(&key));
+        VERIFY_ARE_EQUAL(2u, sent.size());
+        VERIFY_ARE_EQUAL(L"\x1b[<32;6;2M", sent.at(0));
+        VERIFY_ARE_EQUAL(L"a", sent.at(1));
+
+        Log::Comment(L"Changing the tracking mode drops the pending motion");
+        sent.clear();
+        VERIFY_IS_TRUE(mouseInput.HandleMouse({ 6, 1 }, WM_MOUSEMOVE, noModifierKeys, 0, {}));
+        mouseInput.EnableAnyEventTracking(true);
+        VERIFY_IS_FALSE(mouseInput.FlushPendingMouseMotion());
+        VERIFY_ARE_EQUAL(0u, sent.size());
+    }
 };
@@ -5,6 +5,7 @@
 #include "../precomp.h"
 #include <windows.h>
 #include <wextestclass.h>
+#include <chrono>
 #include "../../inc/consoletaeftemplates.hpp"
 
 #include "../../input/terminalInput.hpp"
@@ -46,6 +47,7 @@ public:
     TEST_METHOD(TerminalInputNullKeyTests);
     TEST_METHOD(DifferentModifiersTest);
     TEST_METHOD(CtrlNumTest);
+    TEST_METHOD(KeyTranslationBenchmark);
 
     wchar_t GetModifierChar(const bool fShift, const bool fAlt, const bool fCtrl)
     {
@@ -739,3 +741,54 @@ void InputTest::CtrlNumTest()
     s_expectedInput = L"9";
     TestKey(pInput, uiKeystate, vkey);
 }
+
+void InputTest::KeyTranslationBenchmark()
+{
+    Log::Comment(L"Timing the translation of every virtual key with every combination of "
+                 L"Shift, Alt and Ctrl, in every combination of input modes.");
+
+    size_t sequencesWritten = 0;
+    TerminalInput input{ [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        sequencesWritten += inEvents.empty() ? 0 : 1;
+    } };
+
+    // No char data, so that only the key mappings can produce output.
+    std::vector<KeyEvent> keys;
+    for (WORD vkey = 1; vkey < 0x100; ++vkey)
+    {
+        for (unsigned int mask = 0; mask < 8; ++mask)
+        {
+            const DWORD modifiers = (WI_IsFlagSet(mask, 1) ? SHIFT_PRESSED : 0) |
+                                    (WI_IsFlagSet(mask, 2) ? LEFT_ALT_PRESSED : 0) |
+                                    (WI_IsFlagSet(mask, 4) ? LEFT_CTRL_PRESSED : 0);
+            keys.emplace_back(true, 1ui16, vkey, 0ui16, L'\0', modifiers);
+        }
+    }
+
+    constexpr size_t passes = 20;
+    size_t keysHandled = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < passes; ++pass)
+    {
+        for (unsigned int mode = 0; mode < 8; ++mode)
+        {
+            input.ChangeAnsiMode(WI_IsFlagClear(mode, 1));
+            input.ChangeCursorKeysMode(WI_IsFlagSet(mode, 2));
+            input.ChangeKeypadMode(WI_IsFlagSet(mode, 4));
+            for (const auto& key : keys)
+            {
+                input.HandleKey(&key);
+                ++keysHandled;
+            }
+        }
+    }
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    Log::Comment(NoThrowString().Format(L"%zu keys in %lld us, %lld ns per key, %zu sequences written",
+                                        keysHandled,
+                                        elapsed.count() / 1000,
+                                        elapsed.count() / gsl::narrow_cast<long long>(keysHandled),
+                                        sequencesWritten));
+
+    VERIFY_ARE_NOT_EQUAL(0u, sequencesWritten);
+}
@@ -0,0 +1,106 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include <wextestclass.h>
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../tabStops.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+namespace Microsoft
+{
+    namespace Console
+    {
+        namespace VirtualTerminal
+        {
+            class TabStopsTest;
+        };
+    };
+};
+using namespace Microsoft::Console::VirtualTerminal;
+
+class Microsoft::Console::VirtualTerminal::TabStopsTest
+{
+public:
+    TEST_CLASS(TabStopsTest);
+
+    TEST_METHOD(DefaultTabStops)
+    {
+        TabStops tabStops;
+        const size_t width = 80;
+
+        VERIFY_ARE_EQUAL(8u, tabStops.Next(0, width));
+        VERIFY_ARE_EQUAL(16u, tabStops.Next(8, width));
+        VERIFY_ARE_EQUAL(72u, tabStops.Next(70, width));
+        VERIFY_ARE_EQUAL(79u, tabStops.Next(72, width), L"Without a tab stop, we stop in the last column.");
+        VERIFY_ARE_EQUAL(79u, tabStops.Next(79, width));
+
+        VERIFY_ARE_EQUAL(72u, tabStops.Previous(79, width));
+        VERIFY_ARE_EQUAL(8u, tabStops.Previous(16, width));
+        VERIFY_ARE_EQUAL(0u, tabStops.Previous(8, width), L"Without a tab stop, we stop in the first column.");
+        VERIFY_ARE_EQUAL(0u, tabStops.Previous(0, width));
+    }
+
+    TEST_METHOD(SetAndClearTabStops)
+    {
+        TabStops tabStops;
+        const size_t width = 200;
+
+        tabStops.Set(3, width);
+        tabStops.Set(100, width);
+        tabStops.Clear(8, width);
+
+        VERIFY_ARE_EQUAL(3u, tabStops.Next(0, width));
+        VERIFY_ARE_EQUAL(16u, tabStops.Next(3, width));
+        VERIFY_ARE_EQUAL(100u, tabStops.Next(96, width));
+        VERIFY_ARE_EQUAL(104u, tabStops.Next(100, width));
+
+        VERIFY_ARE_EQUAL(3u, tabStops.Previous(16, width));
+        VERIFY_ARE_EQUAL(96u, tabStops.Previous(100, width));
+        VERIFY_ARE_EQUAL(100u, tabStops.Previous(104, width));
+    }
+
+    TEST_METHOD(TabStopsAcrossWords)
+    {
+        TabStops tabStops;
+        const size_t width = 300;
+        tabStops.ClearAll();
+
+        tabStops.Set(31, width);
+        tabStops.Set(32, width);
+        tabStops.Set(250, width);
+
+        VERIFY_ARE_EQUAL(31u, tabStops.Next(0, width));
+        VERIFY_ARE_EQUAL(32u, tabStops.Next(31, width));
+        VERIFY_ARE_EQUAL(250u, tabStops.Next(32, width));
+        VERIFY_ARE_EQUAL(299u, tabStops.Next(250, width));
+
+        VERIFY_ARE_EQUAL(250u, tabStops.Previous(299, width));
+        VERIFY_ARE_EQUAL(32u, tabStops.Previous(250, width));
+        VERIFY_ARE_EQUAL(31u, tabStops.Previous(32, width));
+        VERIFY_ARE_EQUAL(0u, tabStops.Previous(31, width));
+    }
+
+    TEST_METHOD(GrowingFillsDefaultsUnlessCleared)
+    {
+        TabStops tabStops;
+        tabStops.Set(3, 20);
+
+        Log::Comment(L"Columns that come into view get the default tab stops.");
+        VERIFY_ARE_EQUAL(24u, tabStops.Next(16, 40));
+
+        Log::Comment(L"After clearing all tab stops, they don't.");
+        tabStops.ClearAll();
+        tabStops.Set(3, 20);
+        VERIFY_ARE_EQUAL(39u, tabStops.Next(3, 40));
+
+        Log::Comment(L"Resetting brings the defaults back.");
+        tabStops.Reset();
+        VERIFY_ARE_EQUAL(8u, tabStops.Next(3, 40));
+        VERIFY_ARE_EQUAL(32u, tabStops.Next(24, 40));
+    }
+};
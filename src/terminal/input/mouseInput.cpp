@@ -288,6 +288,24 @@ bool TerminalInput::IsTrackingMouseInput() const noexcept
     return (_mouseInputState.trackingMode != TrackingMode::None);
 }
 
+// Routine Description:
+// - Sends the motion report held back by motion coalescing, if there is one.
+// Parameters:
+// - <none>
+// Return value:
+// - true if a motion report was sent.
+bool TerminalInput::FlushPendingMouseMotion()
+{
+    if (_mouseInputState.pendingMotion.empty())
+    {
+        return false;
+    }
+
+    _SendInputSequence(_mouseInputState.pendingMotion);
+    _mouseInputState.pendingMotion.clear();
+    return true;
+}
+
 // Routine Description:
 // - Attempt to handle the given mouse coordinates and windows button as a VT-style mouse event.
 //     If the event should be transmitted in the selected mouse mode, then we'll try and
@@ -306,6 +324,12 @@ bool TerminalInput::HandleMouse(const COORD position,
                                 const short delta,
                                 const MouseButtonState state)
 {
+    // Buttons and the wheel must not overtake motion that happened before them.
+    if (!_isHoverMsg(button))
+    {
+        FlushPendingMouseMotion();
+    }
+
     if (Utils::Sign(delta) != Utils::Sign(_mouseInputState.accumulatedDelta))
     {
         // This works for wheel and non-wheel events and transitioning between wheel/non-wheel.
@@ -408,7 +432,16 @@ bool TerminalInput::HandleMouse(const COORD position,
 
                 if (success)
                 {
-                    _SendInputSequence(sequence);
+                    if (isHover && _mouseInputState.coalesceMotion)
+                    {
+                        // Replace whatever motion is still pending, so that
+                        // only the latest position is reported.
+                        _mouseInputState.pendingMotion = std::move(sequence);
+                    }
+                    else
+                    {
+                        _SendInputSequence(sequence);
+                    }
                     success = true;
                 }
                 if (_mouseInputState.trackingMode == TrackingMode::ButtonEvent || _mouseInputState.trackingMode == TrackingMode::AnyEvent)
@@ -19,6 +19,7 @@ using namespace Microsoft::Console::VirtualTerminal;
 void TerminalInput::SetUtf8ExtendedMode(const bool enable) noexcept
 {
     _mouseInputState.extendedMode = enable ? ExtendedMode::Utf8 : ExtendedMode::None;
+    _mouseInputState.pendingMotion.clear(); // It was encoded for the previous mode.
 }
 
 // Routine Description:
@@ -33,6 +34,7 @@ void TerminalInput::SetUtf8ExtendedMode(const bool enable) noexcept
 void TerminalInput::SetSGRExtendedMode(const bool enable) noexcept
 {
     _mouseInputState.extendedMode = enable ? ExtendedMode::Sgr : ExtendedMode::None;
+    _mouseInputState.pendingMotion.clear(); // It was encoded for the previous mode.
 }
 
 // Routine Description:
@@ -47,6 +49,7 @@ void TerminalInput::EnableDefaultTracking(const bool enable) noexcept
     _mouseInputState.trackingMode = enable ? TrackingMode::Default : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
+    _mouseInputState.pendingMotion.clear(); // It was encoded for the previous mode.
 }
 
 // Routine Description:
@@ -63,6 +66,7 @@ void TerminalInput::EnableButtonEventTracking(const bool enable) noexcept
     _mouseInputState.trackingMode = enable ? TrackingMode::ButtonEvent : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
+    _mouseInputState.pendingMotion.clear(); // It was encoded for the previous mode.
 }
 
 // Routine Description:
@@ -79,6 +83,7 @@ void TerminalInput::EnableAnyEventTracking(const bool enable) noexcept
     _mouseInputState.trackingMode = enable ? TrackingMode::AnyEvent : TrackingMode::None;
     _mouseInputState.lastPos = { -1, -1 }; // Clear out the last saved mouse position & button.
     _mouseInputState.lastButton = 0;
+    _mouseInputState.pendingMotion.clear(); // It was encoded for the previous mode.
 }
 
 // Routine Description:
@@ -92,6 +97,21 @@ void TerminalInput::EnableAlternateScroll(const bool enable) noexcept
     _mouseInputState.alternateScroll = enable;
 }
 
+// Routine Description:
+// - Either enables or disables coalescing of mouse motion reports. While enabled,
+//      HandleMouse holds on to the latest motion report instead of sending it,
+//      until either FlushPendingMouseMotion is called or any other mouse or key
+//      event is handled. The owner is expected to flush once per frame, so that
+//      a fast mouse produces at most one motion report per frame.
+// Parameters:
+// - enable - either enable or disable.
+// Return value:
+// <none>
+void TerminalInput::EnableMotionCoalescing(const bool enable) noexcept
+{
+    _mouseInputState.coalesceMotion = enable;
+}
+
 // Routine Description:
 // - Notify the MouseInput handler that the screen buffer has been swapped to the alternate buffer
 // Parameters:
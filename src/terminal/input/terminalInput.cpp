@@ -245,6 +245,159 @@ static constexpr std::array<TermKeyMap, 14> s_simpleModifiedKeyMapping{
     // TermKeyMap{ VK_ESCAPE, ALT_PRESSED, L""}, This is another Windows system shortcut for switching windows.
 };
 
+// The tables above are only the source of truth. At compile time they're
+// expanded into dense tables indexed by virtual key, so that translating a
+// keypress is a single indexed load instead of a linear search followed by
+// patching the modifier parameter into a copy of the sequence.
+struct KeySequence
+{
+    // Offset and length of a prebuilt sequence in KeySequenceTables::text.
+    // A length of 0 means that there's no mapping for the key.
+    uint16_t offset{ 0 };
+    uint16_t length{ 0 };
+};
+
+// Virtual key codes are a single byte.
+static constexpr size_t s_keyCount = 256;
+// Shift = 1, Alt = 2 and Ctrl = 4. The xterm modifier parameter is the mask + 1.
+static constexpr size_t s_modifierMaskCount = 8;
+// The ANSI modes are indexed with cursor keys application mode = 1 and
+// keypad application mode = 2. VT52 mode ignores both.
+static constexpr size_t s_inputModeCount = 5;
+static constexpr size_t s_vt52InputMode = 4;
+
+template<size_t N>
+static constexpr size_t _sequenceLength(const std::array<TermKeyMap, N>& keyMapping) noexcept
+{
+    size_t length = 0;
+    for (const auto& map : keyMapping)
+    {
+        length += map.sequence.size();
+    }
+    return length;
+}
+
+// Each unmodified mapping is stored once, each entry in s_modifierKeyMapping
+// is stored once per non-zero modifier mask.
+static constexpr size_t s_keySequenceTextLength = _sequenceLength(s_cursorKeysNormalMapping) +
+                                                  _sequenceLength(s_cursorKeysApplicationMapping) +
+                                                  _sequenceLength(s_cursorKeysVt52Mapping) +
+                                                  _sequenceLength(s_keypadNumericMapping) +
+                                                  _sequenceLength(s_keypadApplicationMapping) +
+                                                  _sequenceLength(s_keypadVt52Mapping) +
+                                                  _sequenceLength(s_modifierKeyMapping) * (s_modifierMaskCount - 1) +
+                                                  _sequenceLength(s_simpleModifiedKeyMapping);
+
+static_assert(s_keySequenceTextLength <= std::numeric_limits<uint16_t>::max());
+
+using KeySequenceRow = std::array<KeySequence, s_keyCount>;
+
+struct KeySequenceTables
+{
+    std::array<wchar_t, s_keySequenceTextLength> text{};
+    size_t textLength{ 0 };
+
+    // Sequences for keys pressed with Shift, Alt and/or Ctrl, indexed by modifier mask.
+    std::array<KeySequenceRow, s_modifierMaskCount> modified{};
+    // Sequences sent regardless of the modifier state, indexed by input mode.
+    std::array<KeySequenceRow, s_inputModeCount> unmodified{};
+
+    constexpr KeySequence Append(const std::wstring_view sequence) noexcept
+    {
+        const KeySequence result{ static_cast<uint16_t>(textLength), static_cast<uint16_t>(sequence.size()) };
+        for (const auto wch : sequence)
+        {
+            text[textLength++] = wch;
+        }
+        return result;
+    }
+
+    // Earlier entries win, matching the first-match order of the source tables.
+    template<size_t N>
+    constexpr KeySequenceRow AppendMapping(const std::array<TermKeyMap, N>& keyMapping) noexcept
+    {
+        KeySequenceRow row{};
+        for (const auto& map : keyMapping)
+        {
+            const auto sequence = Append(map.sequence);
+            if (row[map.vkey].length == 0)
+            {
+                row[map.vkey] = sequence;
+            }
+        }
+        return row;
+    }
+};
+
+static constexpr size_t _modifierMask(const bool shift, const bool alt, const bool ctrl) noexcept
+{
+    return (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
+}
+
+static constexpr bool _isCursorKey(const size_t vkey) noexcept
+{
+    // Same as KeyEvent::IsCursorKey: true iff vk in [End, Home, Left, Up, Right, Down]
+    return vkey >= VK_END && vkey <= VK_DOWN;
+}
+
+static constexpr KeySequenceTables _buildKeySequenceTables() noexcept
+{
+    KeySequenceTables tables{};
+
+    // Cursor keys and the remaining keys switch between application and
+    // normal mode independently, so each input mode takes the cursor keys
+    // from one table and everything else from another.
+    const auto cursorNormal = tables.AppendMapping(s_cursorKeysNormalMapping);
+    const auto cursorApplication = tables.AppendMapping(s_cursorKeysApplicationMapping);
+    const auto cursorVt52 = tables.AppendMapping(s_cursorKeysVt52Mapping);
+    const auto keypadNumeric = tables.AppendMapping(s_keypadNumericMapping);
+    const auto keypadApplication = tables.AppendMapping(s_keypadApplicationMapping);
+    const auto keypadVt52 = tables.AppendMapping(s_keypadVt52Mapping);
+
+    for (size_t vkey = 0; vkey < s_keyCount; ++vkey)
+    {
+        const auto cursorKey = _isCursorKey(vkey);
+        tables.unmodified[0][vkey] = cursorKey ? cursorNormal[vkey] : keypadNumeric[vkey];
+        tables.unmodified[1][vkey] = cursorKey ? cursorApplication[vkey] : keypadNumeric[vkey];
+        tables.unmodified[2][vkey] = cursorKey ? cursorNormal[vkey] : keypadApplication[vkey];
+        tables.unmodified[3][vkey] = cursorKey ? cursorApplication[vkey] : keypadApplication[vkey];
+        tables.unmodified[s_vt52InputMode][vkey] = cursorKey ? cursorVt52[vkey] : keypadVt52[vkey];
+    }
+
+    // The 'm' in each of these is replaced with the xterm modifier parameter.
+    for (size_t mask = 1; mask < s_modifierMaskCount; ++mask)
+    {
+        for (const auto& map : s_modifierKeyMapping)
+        {
+            auto sequence = tables.Append(map.sequence);
+            tables.text[sequence.offset + sequence.length - 2] = static_cast<wchar_t>(L'1' + mask);
+            if (tables.modified[mask][map.vkey].length == 0)
+            {
+                tables.modified[mask][map.vkey] = sequence;
+            }
+        }
+    }
+
+    // These only apply to one exact combination of modifiers, and only if
+    // the key didn't already have a sequence from the table above.
+    for (const auto& map : s_simpleModifiedKeyMapping)
+    {
+        const auto sequence = tables.Append(map.sequence);
+        const auto mask = _modifierMask(WI_IsFlagSet(map.modifiers, SHIFT_PRESSED),
+                                        WI_IsAnyFlagSet(map.modifiers, ALT_PRESSED),
+                                        WI_IsAnyFlagSet(map.modifiers, CTRL_PRESSED));
+        if (tables.modified[mask][map.vkey].length == 0)
+        {
+            tables.modified[mask][map.vkey] = sequence;
+        }
+    }
+
+    return tables;
+}
+
+static constexpr auto s_keySequences = _buildKeySequenceTables();
+static_assert(s_keySequences.textLength == s_keySequenceTextLength);
+
 const wchar_t* const CTRL_SLASH_SEQUENCE = L"\x1f";
 const wchar_t* const CTRL_QUESTIONMARK_SEQUENCE = L"\x7F";
 const wchar_t* const CTRL_ALT_SLASH_SEQUENCE = L"\x1b\x1f";
@@ -274,231 +427,150 @@ void TerminalInput::ForceDisableWin32InputMode(const bool win32InputMode) noexce
     _forceDisableWin32InputMode = win32InputMode;
 }
 
-static const gsl::span<const TermKeyMap> _getKeyMapping(const KeyEvent& keyEvent,
-                                                        const bool ansiMode,
-                                                        const bool cursorApplicationMode,
-                                                        const bool keypadApplicationMode) noexcept
+static constexpr std::wstring_view _getSequence(const KeySequence sequence) noexcept
 {
-    if (ansiMode)
-    {
-        if (keyEvent.IsCursorKey())
-        {
-            if (cursorApplicationMode)
-            {
-                return { s_cursorKeysApplicationMapping.data(), s_cursorKeysApplicationMapping.size() };
-            }
-            else
-            {
-                return { s_cursorKeysNormalMapping.data(), s_cursorKeysNormalMapping.size() };
-            }
-        }
-        else
-        {
-            if (keypadApplicationMode)
-            {
-                return { s_keypadApplicationMapping.data(), s_keypadApplicationMapping.size() };
-            }
-            else
-            {
-                return { s_keypadNumericMapping.data(), s_keypadNumericMapping.size() };
-            }
-        }
-    }
-    else
+    return { s_keySequences.text.data() + sequence.offset, sequence.length };
+}
+
+// Routine Description:
+// - Looks up the sequence for a key pressed together with Shift, Alt and/or
+//      Ctrl, with the modifier parameter already filled in where needed.
+// Arguments:
+// - keyEvent - Key event to translate
+// Return Value:
+// - The sequence to send, or an empty view if there is no fixed sequence.
+static std::wstring_view _getModifiedSequence(const KeyEvent& keyEvent) noexcept
+{
+    const size_t vkey = keyEvent.GetVirtualKeyCode();
+    if (vkey >= s_keyCount)
     {
-        if (keyEvent.IsCursorKey())
-        {
-            return { s_cursorKeysVt52Mapping.data(), s_cursorKeysVt52Mapping.size() };
-        }
-        else
-        {
-            return { s_keypadVt52Mapping.data(), s_keypadVt52Mapping.size() };
-        }
+        return {};
     }
+
+    const auto mask = _modifierMask(keyEvent.IsShiftPressed(), keyEvent.IsAltPressed(), keyEvent.IsCtrlPressed());
+    return _getSequence(til::at(til::at(s_keySequences.modified, mask), vkey));
 }
 
 // Routine Description:
-// - Searches the keyMapping for a entry corresponding to this key event, and returns it.
+// - Looks up the sequence for a key, regardless of the modifier state.
 // Arguments:
 // - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
+// - ansiMode - false if we're in VT52 mode
+// - cursorApplicationMode - whether the cursor keys are in application mode
+// - keypadApplicationMode - whether the keypad is in application mode
 // Return Value:
-// - Has value if there was a match to a key translation.
-static std::optional<const TermKeyMap> _searchKeyMapping(const KeyEvent& keyEvent,
-                                                         gsl::span<const TermKeyMap> keyMapping) noexcept
+// - The sequence to send, or an empty view if the key isn't mapped.
+static std::wstring_view _getUnmodifiedSequence(const KeyEvent& keyEvent,
+                                                const bool ansiMode,
+                                                const bool cursorApplicationMode,
+                                                const bool keypadApplicationMode) noexcept
 {
-    for (auto& map : keyMapping)
+    const size_t vkey = keyEvent.GetVirtualKeyCode();
+    if (vkey >= s_keyCount)
     {
-        if (map.vkey == keyEvent.GetVirtualKeyCode())
-        {
-            // If the mapping has no modifiers set, then it doesn't really care
-            //      what the modifiers are on the key. The caller will likely do
-            //      something with them.
-            // However, if there are modifiers set, then we only want to match
-            //      if the key's modifiers are the same as the modifiers in the
-            //      mapping.
-            bool modifiersMatch = WI_AreAllFlagsClear(map.modifiers, MOD_PRESSED);
-            if (!modifiersMatch)
-            {
-                // The modifier mapping expects certain modifier keys to be
-                //      pressed. Check those as well.
-                modifiersMatch =
-                    (WI_IsFlagSet(map.modifiers, SHIFT_PRESSED) == keyEvent.IsShiftPressed()) &&
-                    (WI_IsAnyFlagSet(map.modifiers, ALT_PRESSED) == keyEvent.IsAltPressed()) &&
-                    (WI_IsAnyFlagSet(map.modifiers, CTRL_PRESSED) == keyEvent.IsCtrlPressed());
-            }
-
-            if (modifiersMatch)
-            {
-                return map;
-            }
-        }
+        return {};
     }
-    return std::nullopt;
+
+    const size_t mode = ansiMode ? (cursorApplicationMode ? 1 : 0) + (keypadApplicationMode ? 2 : 0) : s_vt52InputMode;
+    return _getSequence(til::at(til::at(s_keySequences.unmodified, mode), vkey));
 }
 
 typedef std::function<void(const std::wstring_view)> InputSender;
 
 // Routine Description:
-// - Searches the s_modifierKeyMapping for a entry corresponding to this key event.
-//      Changes the second to last byte to correspond to the currently pressed modifier keys
-//      before sending to the input.
+// - Looks up the sequence for a key pressed with modifiers and sends it to the input.
 // Arguments:
 // - keyEvent - Key event to translate
 // - sender - Function to use to dispatch translated event
 // Return Value:
-// - True if there was a match to a key translation, and we successfully modified and sent it to the input
+// - True if there was a match to a key translation, and we successfully sent it to the input
 static bool _searchWithModifier(const KeyEvent& keyEvent, InputSender sender)
 {
     bool success = false;
 
-    const auto match = _searchKeyMapping(keyEvent,
-                                         { s_modifierKeyMapping.data(), s_modifierKeyMapping.size() });
-    if (match)
+    const auto sequence = _getModifiedSequence(keyEvent);
+    if (!sequence.empty())
     {
-        const auto& v = match.value();
-        if (!v.sequence.empty())
-        {
-            std::wstring modified{ v.sequence }; // Make a copy so we can modify it.
-            const bool shift = keyEvent.IsShiftPressed();
-            const bool alt = keyEvent.IsAltPressed();
-            const bool ctrl = keyEvent.IsCtrlPressed();
-            modified.at(modified.size() - 2) = L'1' + (shift ? 1 : 0) + (alt ? 2 : 0) + (ctrl ? 4 : 0);
-            sender(modified);
-            success = true;
-        }
+        sender(sequence);
+        success = true;
     }
     else
     {
-        // We didn't find the key in the map of modified keys that need editing,
-        //      maybe it's in the other map of modified keys with sequences that
-        //      don't need editing before sending.
-        const auto match2 = _searchKeyMapping(keyEvent,
-                                              { s_simpleModifiedKeyMapping.data(), s_simpleModifiedKeyMapping.size() });
-        if (match2)
+        // If there was no fixed sequence, there's one last check:
+        // * C-/ is supposed to be ^_ (the C0 character US)
+        // * C-? is supposed to be DEL
+        // * C-M-/ is supposed to be ^[^_
+        // * C-M-? is supposed to be ^[^?
+        //
+        // But this whole scenario is tricky. '/' is not the same VKEY on
+        // all keyboards. On USASCII keyboards, '/' and '?' share the _same_
+        // key. So we have to figure out the vkey at runtime, and we have to
+        // determine if the key that was pressed was '?' with some
+        // modifiers, or '/' with some modifiers.
+        //
+        // These translations are not in s_simpleModifiedKeyMapping, because
+        // the aforementioned fact that they aren't the same VKEY on all
+        // keyboards.
+        //
+        // See GH#3079 for details.
+        // Also see https://github.com/microsoft/terminal/pull/4947#issuecomment-600382856
+
+        // VkKeyScan will give us both the Vkey of the key needed for this
+        // character, and the modifiers the user might need to press to get
+        // this character.
+        const auto slashKeyScan = VkKeyScan(L'/'); // On USASCII: 0x00bf
+        const auto questionMarkKeyScan = VkKeyScan(L'?'); //On USASCII: 0x01bf
+
+        const auto slashVkey = LOBYTE(slashKeyScan);
+        const auto questionMarkVkey = LOBYTE(questionMarkKeyScan);
+
+        const auto ctrl = keyEvent.IsCtrlPressed();
+        const auto alt = keyEvent.IsAltPressed();
+        const bool shift = keyEvent.IsShiftPressed();
+
+        // From the KeyEvent we're translating, synthesize the equivalent VkKeyScan result
+        const auto vkey = keyEvent.GetVirtualKeyCode();
+        const short keyScanFromEvent = vkey |
+                                       (shift ? 0x100 : 0) |
+                                       (ctrl ? 0x200 : 0) |
+                                       (alt ? 0x400 : 0);
+
+        // Make sure the VKEY is an _exact_ match, and that the modifier
+        // bits also match. This handles the hypothetical case we get a
+        // keyscan back that's ctrl+alt+some_random_VK, and some_random_VK
+        // has bits that are a superset of the bits set for question mark.
+        const bool wasQuestionMark = vkey == questionMarkVkey && WI_AreAllFlagsSet(keyScanFromEvent, questionMarkKeyScan);
+        const bool wasSlash = vkey == slashVkey && WI_AreAllFlagsSet(keyScanFromEvent, slashKeyScan);
+
+        // If the key pressed was exactly the ? key, then try to send the
+        // appropriate sequence for a modified '?'. Otherwise, check if this
+        // was a modified '/' keypress. These mappings don't need to be
+        // changed at all.
+        if ((ctrl && alt) && wasQuestionMark)
         {
-            // This mapping doesn't need to be changed at all.
-            sender(match2.value().sequence);
+            sender(CTRL_ALT_QUESTIONMARK_SEQUENCE);
             success = true;
         }
-        else
+        else if (ctrl && wasQuestionMark)
         {
-            // One last check:
-            // * C-/ is supposed to be ^_ (the C0 character US)
-            // * C-? is supposed to be DEL
-            // * C-M-/ is supposed to be ^[^_
-            // * C-M-? is supposed to be ^[^?
-            //
-            // But this whole scenario is tricky. '/' is not the same VKEY on
-            // all keyboards. On USASCII keyboards, '/' and '?' share the _same_
-            // key. So we have to figure out the vkey at runtime, and we have to
-            // determine if the key that was pressed was '?' with some
-            // modifiers, or '/' with some modifiers.
-            //
-            // These translations are not in s_simpleModifiedKeyMapping, because
-            // the aforementioned fact that they aren't the same VKEY on all
-            // keyboards.
-            //
-            // See GH#3079 for details.
-            // Also see https://github.com/microsoft/terminal/pull/4947#issuecomment-600382856
-
-            // VkKeyScan will give us both the Vkey of the key needed for this
-            // character, and the modifiers the user might need to press to get
-            // this character.
-            const auto slashKeyScan = VkKeyScan(L'/'); // On USASCII: 0x00bf
-            const auto questionMarkKeyScan = VkKeyScan(L'?'); //On USASCII: 0x01bf
-
-            const auto slashVkey = LOBYTE(slashKeyScan);
-            const auto questionMarkVkey = LOBYTE(questionMarkKeyScan);
-
-            const auto ctrl = keyEvent.IsCtrlPressed();
-            const auto alt = keyEvent.IsAltPressed();
-            const bool shift = keyEvent.IsShiftPressed();
-
-            // From the KeyEvent we're translating, synthesize the equivalent VkKeyScan result
-            const auto vkey = keyEvent.GetVirtualKeyCode();
-            const short keyScanFromEvent = vkey |
-                                           (shift ? 0x100 : 0) |
-                                           (ctrl ? 0x200 : 0) |
-                                           (alt ? 0x400 : 0);
-
-            // Make sure the VKEY is an _exact_ match, and that the modifier
-            // bits also match. This handles the hypothetical case we get a
-            // keyscan back that's ctrl+alt+some_random_VK, and some_random_VK
-            // has bits that are a superset of the bits set for question mark.
-            const bool wasQuestionMark = vkey == questionMarkVkey && WI_AreAllFlagsSet(keyScanFromEvent, questionMarkKeyScan);
-            const bool wasSlash = vkey == slashVkey && WI_AreAllFlagsSet(keyScanFromEvent, slashKeyScan);
-
-            // If the key pressed was exactly the ? key, then try to send the
-            // appropriate sequence for a modified '?'. Otherwise, check if this
-            // was a modified '/' keypress. These mappings don't need to be
-            // changed at all.
-            if ((ctrl && alt) && wasQuestionMark)
-            {
-                sender(CTRL_ALT_QUESTIONMARK_SEQUENCE);
-                success = true;
-            }
-            else if (ctrl && wasQuestionMark)
-            {
-                sender(CTRL_QUESTIONMARK_SEQUENCE);
-                success = true;
-            }
-            else if ((ctrl && alt) && wasSlash)
-            {
-                sender(CTRL_ALT_SLASH_SEQUENCE);
-                success = true;
-            }
-            else if (ctrl && wasSlash)
-            {
-                sender(CTRL_SLASH_SEQUENCE);
-                success = true;
-            }
+            sender(CTRL_QUESTIONMARK_SEQUENCE);
+            success = true;
+        }
+        else if ((ctrl && alt) && wasSlash)
+        {
+            sender(CTRL_ALT_SLASH_SEQUENCE);
+            success = true;
+        }
+        else if (ctrl && wasSlash)
+        {
+            sender(CTRL_SLASH_SEQUENCE);
+            success = true;
         }
     }
 
     return success;
 }
 
-// Routine Description:
-// - Searches the input array of mappings, and sends it to the input if a match was found.
-// Arguments:
-// - keyEvent - Key event to translate
-// - keyMapping - Array of key mappings to search
-// - sender - Function to use to dispatch translated event
-// Return Value:
-// - True if there was a match to a key translation, and we successfully sent it to the input
-static bool _translateDefaultMapping(const KeyEvent& keyEvent,
-                                     const gsl::span<const TermKeyMap> keyMapping,
-                                     InputSender sender)
-{
-    const auto match = _searchKeyMapping(keyEvent, keyMapping);
-    if (match)
-    {
-        sender(match->sequence);
-    }
-    return match.has_value();
-}
-
 // Routine Description:
 // - Sends the given input event to the shell.
 // - The caller should attempt to fill the char data in pInEvent if possible.
@@ -527,6 +599,9 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent)
 
     auto keyEvent = *static_cast<const KeyEvent* const>(pInEvent);
 
+    // Keys must not overtake mouse motion that happened before them.
+    FlushPendingMouseMotion();
+
     // GH#4999 - If we're in win32-input mode, skip straight to doing that.
     // Since this mode handles all types of key events, do nothing else.
     // Only do this if win32-input-mode support isn't manually disabled.
@@ -655,9 +730,10 @@ bool TerminalInput::HandleKey(const IInputEvent* const pInEvent)
     // Check any other key mappings (like those for the F1-F12 keys).
     // These mappings will kick in no matter which modifiers are pressed and as such
     // must be checked last, or otherwise we'd override more complex key combinations.
-    const auto mapping = _getKeyMapping(keyEvent, _ansiMode, _cursorApplicationMode, _keypadApplicationMode);
-    if (_translateDefaultMapping(keyEvent, mapping, senderFunc))
+    const auto sequence = _getUnmodifiedSequence(keyEvent, _ansiMode, _cursorApplicationMode, _keypadApplicationMode);
+    if (!sequence.empty())
     {
+        _SendInputSequence(sequence);
         return true;
     }
 
@@ -58,6 +58,7 @@ namespace Microsoft::Console::VirtualTerminal
                          const MouseButtonState state);
 
         bool IsTrackingMouseInput() const noexcept;
+        bool FlushPendingMouseMotion();
 #pragma endregion
 
 #pragma region MouseInputState Management
@@ -70,6 +71,7 @@ namespace Microsoft::Console::VirtualTerminal
         void EnableAnyEventTracking(const bool enable) noexcept;
 
         void EnableAlternateScroll(const bool enable) noexcept;
+        void EnableMotionCoalescing(const bool enable) noexcept;
         void UseAlternateScreenBuffer() noexcept;
         void UseMainScreenBuffer() noexcept;
 #pragma endregion
@@ -119,6 +121,10 @@ namespace Microsoft::Console::VirtualTerminal
             COORD lastPos{ -1, -1 };
             unsigned int lastButton{ 0 };
             int accumulatedDelta{ 0 };
+            // If enabled, motion reports are held back until the owner calls
+            // FlushPendingMouseMotion, and only the most recent one is sent.
+            bool coalesceMotion{ false };
+            std::wstring pendingMotion;
         };
 
         MouseInputState _mouseInputState;
@@ -52,6 +52,12 @@ namespace Microsoft::Console::VirtualTerminal
         virtual bool DispatchControlCharsFromEscape() const = 0;
         virtual bool DispatchIntermediatesFromEscape() const = 0;
 
+        // Bracket a whole ProcessString call. Engines may hold on to the
+        // output of individual actions in between and hand it off in one go,
+        // in which case EndBatch returns the result of that hand off.
+        virtual void BeginBatch() noexcept = 0;
+        [[nodiscard]] virtual HRESULT EndBatch() noexcept = 0;
+
     protected:
         IStateMachineEngine() = default;
     };
@@ -130,6 +130,7 @@ bool InputStateMachineEngine::_DoControlCharacter(const wchar_t wch, const bool
     {
         // This is Ctrl+C, which is handled specially by the host.
         const auto [keyDown, keyUp] = KeyEvent::MakePair(1, 'C', 0, UNICODE_ETX, LEFT_CTRL_PRESSED);
+        _FlushPendingInput();
         success = _pDispatch->WriteCtrlKey(keyDown) && _pDispatch->WriteCtrlKey(keyUp);
     }
     else if (wch >= '\x0' && wch < '\x20')
@@ -257,6 +258,7 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
     {
         return true;
     }
+    _FlushPendingInput();
     return _pDispatch->WriteString(string);
 }
 
@@ -269,6 +271,9 @@ bool InputStateMachineEngine::ActionPrintString(const std::wstring_view string)
 // - true iff we successfully dispatched the sequence.
 bool InputStateMachineEngine::ActionPassThroughString(const std::wstring_view string)
 {
+    // Anything we decoded before this sequence has to reach the client first.
+    _FlushPendingInput();
+
     if (_pDispatch->IsVtInputEnabled())
     {
         // Synthesize string into key events that we'll write to the buffer
@@ -435,6 +440,7 @@ bool InputStateMachineEngine::ActionCsiDispatch(const VTID id, const VTParameter
         // because that will take extra steps to make sure things like
         // Ctrl+C, Ctrl+Break are handled correctly.
         const auto key = _GenerateWin32Key(parameters);
+        _FlushPendingInput();
         success = _pDispatch->WriteCtrlKey(key);
         break;
     }
@@ -677,11 +683,8 @@ void InputStateMachineEngine::_GetSingleKeypress(const wchar_t wch,
 bool InputStateMachineEngine::_WriteSingleKey(const wchar_t wch, const short vkey, const DWORD modifierState)
 {
     // At most 8 records - 2 for each of shift,ctrl,alt up and down, and 2 for the actual key up and down.
-    std::vector<INPUT_RECORD> input;
-    _GenerateWrappedSequence(wch, vkey, modifierState, input);
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(input));
-
-    return _pDispatch->WriteInput(inputEvents);
+    _GenerateWrappedSequence(wch, vkey, modifierState, _pendingInput);
+    return _FlushUnlessBatching();
 }
 
 // Method Description:
@@ -719,9 +722,42 @@ bool InputStateMachineEngine::_WriteMouseEvent(const size_t column, const size_t
     rgInput.Event.MouseEvent.dwControlKeyState = controlKeyState;
     rgInput.Event.MouseEvent.dwEventFlags = eventFlags;
 
-    // pack and write input record
     // 1 record - the modifiers don't get their own events
-    std::deque<std::unique_ptr<IInputEvent>> inputEvents = IInputEvent::Create(gsl::make_span(&rgInput, 1));
+    _pendingInput.push_back(rgInput);
+    return _FlushUnlessBatching();
+}
+
+// Method Description:
+// - Writes the records decoded so far to the input callback, unless we're in
+//      the middle of a batch, in which case EndBatch will write them later.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote (or queued) the records.
+bool InputStateMachineEngine::_FlushUnlessBatching()
+{
+    return _batchDepth > 0 || _FlushPendingInput();
+}
+
+// Method Description:
+// - Writes all pending records to the input callback in a single call.
+//      Must be called before anything else is written to the input queue, so
+//      that the client sees input in the order it arrived.
+// Arguments:
+// - <none>
+// Return Value:
+// - true iff we successfully wrote the records, or there were none to write.
+bool InputStateMachineEngine::_FlushPendingInput()
+{
+    if (_pendingInput.empty())
+    {
+        return true;
+    }
+
+    auto inputEvents = IInputEvent::Create(gsl::make_span(_pendingInput));
+    // Clear before dispatching, in case the dispatch feeds more input back
+    // into us. clear() keeps the capacity around for the next batch.
+    _pendingInput.clear();
     return _pDispatch->WriteInput(inputEvents);
 }
 
@@ -1068,6 +1104,38 @@ bool InputStateMachineEngine::DispatchIntermediatesFromEscape() const noexcept
     return true;
 }
 
+// Routine Description:
+// - Called at the start of ProcessString. Until the matching EndBatch, decoded
+//      keys and mouse events are collected instead of written one at a time,
+//      so a burst of typing or a paste turns into a single WriteInput call.
+// Arguments:
+// - <none>
+// Return Value:
+// - <none>
+void InputStateMachineEngine::BeginBatch() noexcept
+{
+    ++_batchDepth;
+}
+
+// Routine Description:
+// - Called at the end of ProcessString. Once the outermost batch ends, writes
+//      everything collected during it to the input callback.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK if the records were written or the batch is still open,
+//      otherwise the failure from writing them.
+HRESULT InputStateMachineEngine::EndBatch() noexcept
+try
+{
+    if (_batchDepth > 0 && --_batchDepth == 0)
+    {
+        RETURN_HR_IF(E_FAIL, !_FlushPendingInput());
+    }
+    return S_OK;
+}
+CATCH_RETURN();
+
 // Method Description:
 // - Sets us up for vt input passthrough.
 //      We'll set a couple members, and if they aren't null, when we get a
@@ -161,6 +161,9 @@ namespace Microsoft::Console::VirtualTerminal
         bool DispatchControlCharsFromEscape() const noexcept override;
         bool DispatchIntermediatesFromEscape() const noexcept override;
 
+        void BeginBatch() noexcept override;
+        [[nodiscard]] HRESULT EndBatch() noexcept override;
+
         void SetFlushToInputQueueCallback(std::function<bool()> pfnFlushToInputQueue);
 
     private:
@@ -169,6 +172,12 @@ namespace Microsoft::Console::VirtualTerminal
         bool _lookingForDSR;
         DWORD _mouseButtonState = 0;
 
+        // Key and mouse records decoded during the current ProcessString call.
+        // They're handed to the dispatch in a single WriteInput call once the
+        // outermost batch ends. Reused across batches to avoid reallocating.
+        std::vector<INPUT_RECORD> _pendingInput;
+        size_t _batchDepth = 0;
+
         DWORD _GetCursorKeysModifierState(const VTParameters parameters, const VTID id) noexcept;
         DWORD _GetGenericKeysModifierState(const VTParameters parameters) noexcept;
         DWORD _GetSGRMouseModifierState(const size_t modifierParam) noexcept;
@@ -189,6 +198,9 @@ namespace Microsoft::Console::VirtualTerminal
 
         bool _WriteMouseEvent(const size_t column, const size_t line, const DWORD buttonState, const DWORD controlKeyState, const DWORD eventFlags);
 
+        bool _FlushUnlessBatching();
+        bool _FlushPendingInput();
+
         void _GenerateWrappedSequence(const wchar_t wch,
                                       const short vkey,
                                       const DWORD modifierState,
@@ -890,6 +890,25 @@ bool OutputStateMachineEngine::DispatchIntermediatesFromEscape() const noexcept
     return false;
 }
 
+// Routine Description:
+// - Called at the start of ProcessString. Output actions are always
+//      dispatched immediately, so there's nothing to do here.
+void OutputStateMachineEngine::BeginBatch() noexcept
+{
+}
+
+// Routine Description:
+// - Called at the end of ProcessString. Output actions are always
+//      dispatched immediately, so there's nothing to do here.
+// Arguments:
+// - <none>
+// Return Value:
+// - S_OK
+HRESULT OutputStateMachineEngine::EndBatch() noexcept
+{
+    return S_OK;
+}
+
 // Routine Description:
 // - OSC 4 ; c ; spec ST
 //      c: the index of the ansi color table
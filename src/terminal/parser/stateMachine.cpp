@@ -1884,6 +1884,11 @@ bool StateMachine::FlushToTerminal()
 // - <none>
 void StateMachine::ProcessString(const std::wstring_view string)
 {
+    // Let the engine hand off everything this string produces at once. If
+    // we're unwinding from an exception, that exception is the one to report.
+    _engine->BeginBatch();
+    auto endBatch = wil::scope_exit([&]() noexcept { LOG_IF_FAILED(_engine->EndBatch()); });
+
     size_t start = 0;
     size_t current = start;
 
@@ -2013,6 +2018,9 @@ void StateMachine::ProcessString(const std::wstring_view string)
             _cachedSequence = _cachedSequence.value_or(std::wstring{}) + std::wstring{ _run };
         }
     }
+
+    endBatch.release();
+    THROW_IF_FAILED(_engine->EndBatch());
 }
 
 // Routine Description:
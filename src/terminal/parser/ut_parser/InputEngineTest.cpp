@@ -264,6 +264,7 @@ class Microsoft::Console::VirtualTerminal::InputEngineTest
     TEST_METHOD(CSICursorBackTabTest);
     TEST_METHOD(EnhancedKeysTest);
     TEST_METHOD(SS3CursorKeyTest);
+    TEST_METHOD(BatchedKeysTest);
     TEST_METHOD(AltBackspaceTest);
     TEST_METHOD(AltCtrlDTest);
     TEST_METHOD(AltIntermediateTest);
@@ -890,6 +891,58 @@ void InputEngineTest::SS3CursorKeyTest()
     VerifyExpectedInputDrained();
 }
 
+void InputEngineTest::BatchedKeysTest()
+{
+    size_t writeInputCalls = 0;
+    auto pfn = [&](std::deque<std::unique_ptr<IInputEvent>>& inEvents) {
+        ++writeInputCalls;
+        testState.TestInputStringCallback(inEvents);
+    };
+    auto dispatch = std::make_unique<TestInteractDispatch>(pfn, &testState);
+    auto inputEngine = std::make_unique<InputStateMachineEngine>(std::move(dispatch));
+    auto _stateMachine = std::make_unique<StateMachine>(std::move(inputEngine));
+    VERIFY_IS_NOT_NULL(_stateMachine);
+    testState._stateMachine = _stateMachine.get();
+
+    Log::Comment(L"Keys decoded from a single string should be written in a single call, in order.");
+
+    for (const auto vkey : { VK_UP, VK_DOWN, VK_RIGHT, VK_LEFT })
+    {
+        INPUT_RECORD inputRec;
+        inputRec.EventType = KEY_EVENT;
+        inputRec.Event.KeyEvent.bKeyDown = TRUE;
+        inputRec.Event.KeyEvent.dwControlKeyState = 0;
+        inputRec.Event.KeyEvent.wRepeatCount = 1;
+        inputRec.Event.KeyEvent.wVirtualKeyCode = static_cast<WORD>(vkey);
+        inputRec.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(vkey, MAPVK_VK_TO_VSC));
+        inputRec.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(MapVirtualKeyW(vkey, MAPVK_VK_TO_CHAR));
+        testState.vExpectedInput.push_back(inputRec);
+    }
+    const std::wstring seq = L"\x1bOA\x1bOB\x1bOC\x1bOD";
+
+    _stateMachine->ProcessString(seq);
+    VERIFY_ARE_EQUAL(1u, writeInputCalls);
+    VerifyExpectedInputDrained();
+
+    Log::Comment(L"Characters fed in one at a time should still be written immediately.");
+
+    INPUT_RECORD inputRec;
+    inputRec.EventType = KEY_EVENT;
+    inputRec.Event.KeyEvent.bKeyDown = TRUE;
+    inputRec.Event.KeyEvent.dwControlKeyState = 0;
+    inputRec.Event.KeyEvent.wRepeatCount = 1;
+    inputRec.Event.KeyEvent.wVirtualKeyCode = VK_UP;
+    inputRec.Event.KeyEvent.wVirtualScanCode = static_cast<WORD>(MapVirtualKeyW(VK_UP, MAPVK_VK_TO_VSC));
+    inputRec.Event.KeyEvent.uChar.UnicodeChar = static_cast<wchar_t>(MapVirtualKeyW(VK_UP, MAPVK_VK_TO_CHAR));
+    testState.vExpectedInput.push_back(inputRec);
+
+    _stateMachine->ProcessCharacter(AsciiChars::ESC);
+    _stateMachine->ProcessCharacter(L'O');
+    _stateMachine->ProcessCharacter(L'A');
+    VERIFY_ARE_EQUAL(2u, writeInputCalls);
+    VerifyExpectedInputDrained();
+}
+
 void InputEngineTest::AltBackspaceTest()
 {
     auto pfn = std::bind(&TestState::TestInputCallback, &testState, std::placeholders::_1);
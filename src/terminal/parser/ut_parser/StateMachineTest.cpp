@@ -77,6 +77,9 @@ public:
     bool DispatchControlCharsFromEscape() const override { return false; };
     bool DispatchIntermediatesFromEscape() const override { return false; };
 
+    void BeginBatch() noexcept override{};
+    HRESULT EndBatch() noexcept override { return S_OK; };
+
     // ActionCsiDispatch is the only method that's actually implemented.
     bool ActionCsiDispatch(const VTID /*id*/, const VTParameters parameters) override
     {
@@ -45,23 +45,29 @@ CATCH_RETURN();
 
 [[nodiscard]] HRESULT ScreenInfoUiaProviderBase::Signal(_In_ EVENTID eventId)
 {
-    HRESULT hr = S_OK;
-    // check to see if we're already firing this particular event
-    if (_signalFiringMapping.find(eventId) != _signalFiringMapping.end() &&
-        _signalFiringMapping[eventId] == true)
-    {
-        return hr;
-    }
-
     try
     {
-        _signalFiringMapping[eventId] = true;
+        std::lock_guard<std::mutex> lock{ _signalFiringLock };
+
+        // check to see if we're already firing this particular event
+        auto& firing = _signalFiringMapping[eventId];
+        if (firing)
+        {
+            return S_OK;
+        }
+        firing = true;
     }
     CATCH_RETURN();
 
     IRawElementProviderSimple* pProvider = this;
-    hr = UiaRaiseAutomationEvent(pProvider, eventId);
-    _signalFiringMapping[eventId] = false;
+    const auto hr = UiaRaiseAutomationEvent(pProvider, eventId);
+
+    try
+    {
+        std::lock_guard<std::mutex> lock{ _signalFiringLock };
+        _signalFiringMapping[eventId] = false;
+    }
+    CATCH_LOG();
 
     return hr;
 }
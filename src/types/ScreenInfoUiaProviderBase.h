@@ -121,7 +121,12 @@ namespace Microsoft::Console::Types
         // eventually overflowing the stack.
         // We aren't using this as a cheap locking
         // mechanism for multi-threaded code.
+        // Signal is called from conhost's UIA event thread as well as from
+        // the threads UIA calls us on, which share no lock. So the map has its
+        // own, held only while it's looked at: UiaRaiseAutomationEvent may
+        // call back into Signal on the same thread.
         std::unordered_map<EVENTID, bool> _signalFiringMapping{};
+        std::mutex _signalFiringLock;
 
         const COORD _getScreenBufferCoords() const noexcept;
         const TextBuffer& _getTextBuffer() const noexcept;
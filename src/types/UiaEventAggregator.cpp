@@ -0,0 +1,172 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "UiaEventAggregator.hpp"
+
+using namespace Microsoft::Console::Types;
+
+// Routine Description:
+// - Tells whether there's anything in this delta that clients need to hear about.
+bool UiaEventDelta::HasChanges() const noexcept
+{
+    return textChanged || selectionChanged;
+}
+
+// Routine Description:
+// - Folds a later delta into this one.
+// Arguments:
+// - other - the later delta
+void UiaEventDelta::Merge(const UiaEventDelta& other) noexcept
+{
+    textChanged |= other.textChanged;
+    selectionChanged |= other.selectionChanged;
+}
+
+// Routine Description:
+// - Starts the thread that dispatches the deltas.
+// Arguments:
+// - sink - receives the merged deltas, on the aggregator's thread.
+// - isListening - tells whether any automation client is listening.
+//                 Called on the aggregator's thread. If null, we assume that there always is one.
+// - interval - how long changes are collected before they're dispatched
+UiaEventAggregator::UiaEventAggregator(Sink sink,
+                                       ListenerCheck isListening,
+                                       const std::chrono::milliseconds interval) :
+    _sink{ std::move(sink) },
+    _isListening{ std::move(isListening) },
+    _interval{ interval },
+    _mutex{},
+    _cv{},
+    _pending{},
+    _stop{ false },
+    _listening{ true },
+    _thread{ [this]() { _Run(); } }
+{
+}
+
+// Routine Description:
+// - Stops the dispatching thread. Changes that weren't dispatched yet are dropped.
+UiaEventAggregator::~UiaEventAggregator()
+{
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        _stop = true;
+    }
+    _cv.notify_one();
+
+    if (_thread.joinable())
+    {
+        _thread.join();
+    }
+}
+
+// Routine Description:
+// - Merges the given changes into the ones waiting to be dispatched.
+// - This is cheap and never waits for the sink, so it's safe to call from the output and render paths.
+// Arguments:
+// - delta - the changes
+void UiaEventAggregator::Post(const UiaEventDelta& delta) noexcept
+try
+{
+    // Nobody would hear about it anyways. Dropping the changes right away keeps
+    // the cost of output independent of accessibility when no client is attached.
+    if (!delta.HasChanges() || !_listening.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    bool wasIdle;
+    {
+        std::lock_guard<std::mutex> lock{ _mutex };
+        wasIdle = !_pending.HasChanges();
+        _pending.Merge(delta);
+    }
+
+    // The thread only needs waking for the first change of a frame.
+    if (wasIdle)
+    {
+        _cv.notify_one();
+    }
+}
+CATCH_LOG()
+
+void UiaEventAggregator::NotifyTextChanged() noexcept
+{
+    UiaEventDelta delta;
+    delta.textChanged = true;
+    Post(delta);
+}
+
+void UiaEventAggregator::NotifySelectionChanged() noexcept
+{
+    UiaEventDelta delta;
+    delta.selectionChanged = true;
+    Post(delta);
+}
+
+// Routine Description:
+// - The body of the dispatching thread. Waits for the first change, gives the
+//   producers an interval's time to pile up more, then hands the merged delta to the sink.
+// - Only while nobody listens does it wake up without a change, to see whether that changed.
+void UiaEventAggregator::_Run() noexcept
+try
+{
+    const auto hasWork = [this]() { return _stop || _pending.HasChanges(); };
+
+    std::unique_lock<std::mutex> lock{ _mutex };
+    while (!_stop)
+    {
+        // _listening is only ever cleared on this thread, so it can't change under us here.
+        if (_listening.load(std::memory_order_relaxed))
+        {
+            _cv.wait(lock, hasWork);
+        }
+        else if (!_cv.wait_for(lock, ListenerPollInterval, hasWork))
+        {
+            // Post() drops everything while nobody is listening,
+            // so nothing will wake us up once somebody is.
+            lock.unlock();
+            _RefreshListening();
+            lock.lock();
+            continue;
+        }
+
+        if (_cv.wait_for(lock, _interval, [this]() { return _stop; }))
+        {
+            break;
+        }
+
+        const auto delta = std::exchange(_pending, UiaEventDelta{});
+        lock.unlock();
+
+        _RefreshListening();
+        if (_listening.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                _sink(delta);
+            }
+            CATCH_LOG();
+        }
+
+        lock.lock();
+    }
+}
+CATCH_LOG()
+
+// Routine Description:
+// - Asks whether any automation client is listening and remembers the answer for Post().
+void UiaEventAggregator::_RefreshListening() noexcept
+{
+    auto listening = true;
+    if (_isListening)
+    {
+        try
+        {
+            listening = _isListening();
+        }
+        CATCH_LOG();
+    }
+    _listening.store(listening, std::memory_order_relaxed);
+}
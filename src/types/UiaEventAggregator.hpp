@@ -0,0 +1,74 @@
+/*++
+Copyright (c) Microsoft Corporation
+Licensed under the MIT license.
+
+Module Name:
+- UiaEventAggregator.hpp
+
+Abstract:
+- Collects the changes that automation clients need to hear about and merges
+  them into one delta per frame: whether the text or the selection changed.
+  The events these map to carry no details, so neither do the deltas.
+- The deltas are handed to a sink on a dedicated thread, so conhost's output
+  path never waits for an automation client. While no client is listening,
+  changes are dropped as soon as they're posted.
+- The Terminal doesn't need this: its UiaEngine signals once per frame
+  already, and the automation peer defers the events to the UI thread.
+--*/
+
+#pragma once
+
+#include <condition_variable>
+
+namespace Microsoft::Console::Types
+{
+    struct UiaEventDelta
+    {
+        bool textChanged{ false };
+        bool selectionChanged{ false };
+
+        bool HasChanges() const noexcept;
+        void Merge(const UiaEventDelta& other) noexcept;
+    };
+
+    class UiaEventAggregator final
+    {
+    public:
+        using Sink = std::function<void(const UiaEventDelta&)>;
+        using ListenerCheck = std::function<bool()>;
+
+        // Changes are collected for this long before they're dispatched.
+        static constexpr std::chrono::milliseconds DefaultInterval{ 16 };
+        // While nobody listens, we check this often whether that changed.
+        static constexpr std::chrono::milliseconds ListenerPollInterval{ 500 };
+
+        UiaEventAggregator(Sink sink,
+                           ListenerCheck isListening = nullptr,
+                           const std::chrono::milliseconds interval = DefaultInterval);
+        ~UiaEventAggregator();
+
+        UiaEventAggregator(const UiaEventAggregator&) = delete;
+        UiaEventAggregator& operator=(const UiaEventAggregator&) = delete;
+
+        void Post(const UiaEventDelta& delta) noexcept;
+        void NotifyTextChanged() noexcept;
+        void NotifySelectionChanged() noexcept;
+
+    private:
+        void _Run() noexcept;
+        void _RefreshListening() noexcept;
+
+        const Sink _sink;
+        const ListenerCheck _isListening;
+        const std::chrono::milliseconds _interval;
+
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        UiaEventDelta _pending;
+        bool _stop;
+        std::atomic<bool> _listening;
+
+        // Declared last, so that the thread starts after everything it uses is initialized.
+        std::thread _thread;
+    };
+}
@@ -4,11 +4,13 @@
 #include "precomp.h"
 #include "UiaTextRangeBase.hpp"
 #include "ScreenInfoUiaProviderBase.h"
-#include "../buffer/out/search.h"
 #include "UiaTracing.h"
 
 using namespace Microsoft::Console::Types;
 
+// GetText() produces the text of a range this many rows at a time.
+static constexpr int TextChunkRows = 64;
+
 // degenerate range constructor.
 #pragma warning(suppress : 26434) // WRL RuntimeClassInitialize base is a no-op and we need this for MakeAndInitialize
 HRESULT UiaTextRangeBase::RuntimeClassInitialize(_In_ IUiaData* pData, _In_ IRawElementProviderSimple* const pProvider, _In_ std::wstring_view wordDelimiters) noexcept
@@ -330,43 +332,51 @@ try
     *ppRetVal = nullptr;
 
     const std::wstring queryText{ text, SysStringLen(text) };
-    const auto bufferSize = _getBufferSize();
-    const auto sensitivity = ignoreCase ? Search::Sensitivity::CaseInsensitive : Search::Sensitivity::CaseSensitive;
+    if (queryText.empty())
+    {
+        return S_OK;
+    }
 
-    auto searchDirection = Search::Direction::Forward;
-    auto searchAnchor = _start;
-    if (searchBackward)
+    // The search runs against a snapshot of the rows' text, which is the only
+    // part that needs the console lock. We hold on to the snapshot, so that
+    // repeated searches only capture the rows that changed since the previous one.
+    std::shared_ptr<const TextBufferSnapshot> snapshot;
+    Viewport bufferSize;
+    COORD start;
+    COORD end;
     {
-        searchDirection = Search::Direction::Backward;
+        _pData->LockConsole();
+        auto Unlock = wil::scope_exit([&]() noexcept {
+            _pData->UnlockConsole();
+        });
 
-        // we need to convert the end to inclusive
-        // because Search operates with an inclusive COORD
-        searchAnchor = _end;
-        bufferSize.DecrementInBounds(searchAnchor, true);
-    }
+        if (IsDegenerate())
+        {
+            return S_OK;
+        }
 
-    Search searcher{ *_pData, queryText, searchDirection, sensitivity, searchAnchor };
+        bufferSize = _getBufferSize();
+        start = _start;
+        end = _end;
 
-    if (searcher.FindNext())
-    {
-        const auto foundLocation = searcher.GetFoundLocation();
-        const auto start = foundLocation.first;
+        auto inclusiveEnd = end;
+        bufferSize.DecrementInBounds(inclusiveEnd, true);
+        snapshot = _pData->GetTextBuffer().TakeSnapshot(start.Y, inclusiveEnd.Y, _searchIndex.get());
+        _searchIndex = snapshot;
+    }
 
+    if (const auto found = snapshot->FindText(queryText, ignoreCase, searchBackward, start, end))
+    {
         // we need to increment the position of end because it's exclusive
-        auto end = foundLocation.second;
-        bufferSize.IncrementInBounds(end, true);
+        COORD foundEnd = found->second;
+        bufferSize.IncrementInBounds(foundEnd, true);
 
-        // make sure what was found is within the bounds of the current range
-        if ((searchDirection == Search::Direction::Forward && bufferSize.CompareInBounds(end, _end, true) < 0) ||
-            (searchDirection == Search::Direction::Backward && bufferSize.CompareInBounds(start, _start) > 0))
-        {
-            RETURN_IF_FAILED(Clone(ppRetVal));
-            UiaTextRangeBase& range = static_cast<UiaTextRangeBase&>(**ppRetVal);
-            range._start = start;
-            range._end = end;
+        RETURN_IF_FAILED(Clone(ppRetVal));
+        UiaTextRangeBase& range = static_cast<UiaTextRangeBase&>(**ppRetVal);
+        range._start = found->first;
+        range._end = foundEnd;
 
-            UiaTracing::TextRange::FindText(*this, queryText, searchBackward, ignoreCase, range);
-        }
+        UiaTracing::TextRange::FindText(*this, queryText, searchBackward, ignoreCase, range);
     }
     return S_OK;
 }
@@ -418,24 +428,9 @@ IFACEMETHODIMP UiaTextRangeBase::GetBoundingRectangles(_Outptr_result_maybenull_
         const til::point viewportOrigin = viewport.Origin();
         const auto viewportEnd = viewport.EndExclusive();
 
-        // startAnchor: the earliest COORD we will get a bounding rect for
-        auto startAnchor = GetEndpoint(TextPatternRangeEndpoint_Start);
-        if (bufferSize.CompareInBounds(startAnchor, viewportOrigin, true) < 0)
-        {
-            // earliest we can be is the origin
-            startAnchor = viewportOrigin;
-        }
-
-        // endAnchor: the latest COORD we will get a bounding rect for
-        auto endAnchor = GetEndpoint(TextPatternRangeEndpoint_End);
-        if (bufferSize.CompareInBounds(endAnchor, viewportEnd, true) > 0)
-        {
-            // latest we can be is the viewport end
-            endAnchor = viewportEnd;
-        }
-
         // _end is exclusive, let's be inclusive so we don't have to think about it anymore for bounding rects
-        bufferSize.DecrementInBounds(endAnchor, true);
+        auto inclusiveEnd = _end;
+        bufferSize.DecrementInBounds(inclusiveEnd, true);
 
         if (IsDegenerate() || bufferSize.CompareInBounds(_start, viewportEnd, true) > 0 || bufferSize.CompareInBounds(_end, viewportOrigin, true) < 0)
         {
@@ -449,7 +444,9 @@ IFACEMETHODIMP UiaTextRangeBase::GetBoundingRectangles(_Outptr_result_maybenull_
         }
         else
         {
-            const auto textRects = buffer.GetTextRects(startAnchor, endAnchor, _blockRange, true);
+            // Only the rows within the viewport get a bounding rect,
+            // no matter how much of the buffer the range spans.
+            const auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true, viewport.Top(), viewport.BottomInclusive());
 
             for (const auto& rect : textRects)
             {
@@ -555,20 +552,41 @@ std::wstring UiaTextRangeBase::_getTextValue(std::optional<unsigned int> maxLeng
         auto inclusiveEnd = _end;
         bufferSize.DecrementInBounds(inclusiveEnd, true);
 
-        const auto textRects = buffer.GetTextRects(_start, inclusiveEnd, _blockRange, true);
-        const auto bufferData = buffer.GetText(true,
-                                               false,
-                                               textRects);
-
-        const size_t textDataSize = base::ClampMul(bufferData.text.size(), bufferSize.Width());
-        textData.reserve(textDataSize);
-        for (const auto& text : bufferData.text)
+        // Produce the text a few rows at a time, so that asking for the
+        // first few characters of a huge range doesn't copy all of it.
+        for (int firstRow = _start.Y; firstRow <= inclusiveEnd.Y; firstRow += TextChunkRows)
         {
-            textData += text;
+            if (maxLength.has_value() && textData.size() >= *maxLength)
+            {
+                break;
+            }
+
+            const auto lastRow = std::min(firstRow + TextChunkRows - 1, static_cast<int>(inclusiveEnd.Y));
+            const auto textRects = buffer.GetTextRects(_start,
+                                                       inclusiveEnd,
+                                                       _blockRange,
+                                                       true,
+                                                       gsl::narrow_cast<SHORT>(firstRow),
+                                                       gsl::narrow_cast<SHORT>(lastRow));
+            const auto bufferData = buffer.GetText(true,
+                                                   false,
+                                                   textRects);
+
+            // GetText() only puts line breaks between the rows it was given.
+            // Add the one between the previous chunk and this one ourselves.
+            if (firstRow != _start.Y && !buffer.GetRowByOffset(gsl::narrow_cast<size_t>(firstRow) - 1).WasWrapForced())
+            {
+                textData += L"\r\n";
+            }
+
+            for (const auto& text : bufferData.text)
+            {
+                textData += text;
+            }
         }
     }
 
-    if (maxLength.has_value())
+    if (maxLength.has_value() && textData.size() > *maxLength)
     {
         textData.resize(*maxLength);
     }
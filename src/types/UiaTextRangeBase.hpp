@@ -139,6 +139,11 @@ namespace Microsoft::Console::Types
         COORD _end{};
         bool _blockRange;
 
+        // The text of the rows that FindText() last searched on this range. See FindText().
+        // It's deliberately not copied into clones, so that a range never retains more
+        // than the rows it covers itself.
+        std::shared_ptr<const TextBufferSnapshot> _searchIndex;
+
         // This is used by tracing to extract the text value
         // that the UiaTextRange currently encompasses.
         // GetText() cannot be used as it's not const
@@ -0,0 +1,130 @@
+// Copyright (c) Microsoft Corporation.
+// Licensed under the MIT license.
+
+#include "precomp.h"
+#include "WexTestClass.h"
+#include "../../inc/consoletaeftemplates.hpp"
+
+#include "../UiaEventAggregator.hpp"
+
+using namespace WEX::Common;
+using namespace WEX::Logging;
+using namespace WEX::TestExecution;
+
+using namespace Microsoft::Console::Types;
+
+class UiaEventAggregatorTests
+{
+    TEST_CLASS(UiaEventAggregatorTests);
+
+    // Collects the deltas that an aggregator dispatches.
+    struct RecordingSink
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<UiaEventDelta> deltas;
+
+        void operator()(const UiaEventDelta& delta)
+        {
+            {
+                std::lock_guard<std::mutex> lock{ mutex };
+                deltas.push_back(delta);
+            }
+            cv.notify_all();
+        }
+
+        bool WaitForDeltas(const size_t count)
+        {
+            std::unique_lock<std::mutex> lock{ mutex };
+            return cv.wait_for(lock, std::chrono::seconds{ 5 }, [&]() { return deltas.size() >= count; });
+        }
+    };
+
+    TEST_METHOD(MergesChangesIntoOneDelta)
+    {
+        RecordingSink sink;
+        {
+            // A long interval makes sure that all of the changes below end up in the same delta.
+            UiaEventAggregator aggregator{ [&](const UiaEventDelta& delta) { sink(delta); }, nullptr, std::chrono::milliseconds{ 200 } };
+
+            for (auto i = 0; i < 10000; ++i)
+            {
+                aggregator.NotifyTextChanged();
+            }
+
+            VERIFY_IS_TRUE(sink.WaitForDeltas(1));
+        }
+
+        VERIFY_ARE_EQUAL(1u, sink.deltas.size());
+        const auto& delta = sink.deltas.front();
+        VERIFY_IS_TRUE(delta.textChanged);
+        VERIFY_IS_FALSE(delta.selectionChanged);
+    }
+
+    TEST_METHOD(DispatchesLaterChangesSeparately)
+    {
+        RecordingSink sink;
+        UiaEventAggregator aggregator{ [&](const UiaEventDelta& delta) { sink(delta); }, nullptr, std::chrono::milliseconds{ 1 } };
+
+        aggregator.NotifySelectionChanged();
+        VERIFY_IS_TRUE(sink.WaitForDeltas(1));
+
+        aggregator.NotifyTextChanged();
+        VERIFY_IS_TRUE(sink.WaitForDeltas(2));
+
+        std::lock_guard<std::mutex> lock{ sink.mutex };
+        VERIFY_IS_TRUE(sink.deltas.at(0).selectionChanged);
+        VERIFY_IS_FALSE(sink.deltas.at(0).textChanged);
+        VERIFY_IS_FALSE(sink.deltas.at(1).selectionChanged);
+        VERIFY_IS_TRUE(sink.deltas.at(1).textChanged);
+    }
+
+    TEST_METHOD(DropsChangesWhileNobodyListens)
+    {
+        std::atomic<bool> listening{ false };
+        std::atomic<size_t> dispatched{ 0 };
+        {
+            UiaEventAggregator aggregator{ [&](const UiaEventDelta&) { ++dispatched; },
+                                           [&]() { return listening.load(); },
+                                           std::chrono::milliseconds{ 1 } };
+
+            // The aggregator assumes that there's a listener until it asked.
+            // After the first batch it knows better and drops everything right away.
+            aggregator.NotifyTextChanged();
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+
+            for (auto i = 0; i < 100; ++i)
+            {
+                aggregator.NotifyTextChanged();
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+        }
+
+        VERIFY_ARE_EQUAL(0u, dispatched.load());
+    }
+
+    TEST_METHOD(NoticesWhenSomebodyStartsListening)
+    {
+        std::atomic<bool> listening{ false };
+        RecordingSink sink;
+        UiaEventAggregator aggregator{ [&](const UiaEventDelta& delta) { sink(delta); },
+                                       [&]() { return listening.load(); },
+                                       std::chrono::milliseconds{ 1 } };
+
+        // Let the aggregator find out that nobody listens.
+        aggregator.NotifyTextChanged();
+        std::this_thread::sleep_for(std::chrono::milliseconds{ 100 });
+
+        // Post() keeps dropping changes until the thread polled the listener check again.
+        listening = true;
+        std::this_thread::sleep_for(UiaEventAggregator::ListenerPollInterval * 2);
+
+        aggregator.NotifySelectionChanged();
+        VERIFY_IS_TRUE(sink.WaitForDeltas(1));
+
+        std::lock_guard<std::mutex> lock{ sink.mutex };
+        VERIFY_ARE_EQUAL(1u, sink.deltas.size());
+        VERIFY_IS_TRUE(sink.deltas.at(0).selectionChanged);
+        VERIFY_IS_FALSE(sink.deltas.at(0).textChanged);
+    }
+};